@@ -0,0 +1,91 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+
+#include <memory_resource>
+#include <mutex>
+
+namespace the_learning_games {
+
+    /*! @brief A thread safe monotonic arena holding everything a single job allocates, released in one shot.
+        @details Allocation bumps a pointer through chunks of geometrically growing size taken from upstream,
+        deallocation is a no-op & release() hands every chunk back at once. Tables built once per job, such as
+        the lists of a board builder, the board_t tables or the merge tree of a simulation, come straight from the arena;
+        workers put an unsynchronized std::pmr::monotonic_buffer_resource on top of it for their per game state,
+        so the mutex is taken once per scratch chunk, not once per game.
+    */
+    class job_arena_t : public std::pmr::memory_resource {
+        mutable std::mutex mutex;
+        std::pmr::monotonic_buffer_resource arena;
+        std::size_t allocated_ = 0;//! @internal Bytes handed out since the last release()
+
+    public:
+        /*! @param initial_bytes The size of the first chunk taken from upstream.
+            @param upstream Supplies the chunks, the global heap by default.
+        */
+        explicit job_arena_t(std::size_t initial_bytes = 1 << 16, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) :
+            arena(initial_bytes, upstream)
+        {}
+
+        job_arena_t(job_arena_t const&) = delete;
+        job_arena_t& operator=(job_arena_t const&) = delete;
+
+        /*! @brief Frees every allocation of the job at once.
+            @details Nothing allocated from the arena may be used afterwards, including its destructor.
+        */
+        void release() {
+            std::lock_guard<std::mutex> lock(mutex);
+            arena.release();
+            allocated_ = 0;
+        }
+
+        /*! @brief Returns the bytes handed out since the last release().
+        */
+        std::size_t allocated() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return allocated_;
+        }
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto p = arena.allocate(bytes, alignment);
+            allocated_ += bytes;
+            return p;
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+        bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+            return this == &other;
+        }
+    };
+}
@@ -0,0 +1,375 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <iomanip>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace the_learning_games {
+
+    /*! @brief The repeated measurements of a single benchmark.
+    */
+    struct benchmark_result_t {
+        std::string name;//! Unique name of the benchmark, e.g. "gps".
+        std::string unit;//! Unit of the samples, e.g. "games/s".
+        bool higher_is_better = true;//! Direction in which a change is an improvement.
+        std::vector<double> samples;//! One value per repetition.
+    };
+
+    /*! @brief Writes results as `{"benchmarks":[{"name":..,"unit":..,"higher_is_better":..,"samples":[..]}]}`
+        @details Samples that aren't finite, which JSON has no number for, are written as null.
+    */
+    inline std::ostream& write_json(std::ostream& os, std::vector<benchmark_result_t> const& results) {
+        auto const precision = os.precision();
+        os << "{\"benchmarks\":[";
+        for (std::size_t i = 0; i != results.size(); ++i) {
+            auto const& r = results[i];
+            os << (i ? ",\n" : "\n") << "{\"name\":\"" << r.name << "\",\"unit\":\"" << r.unit
+                << "\",\"higher_is_better\":" << (r.higher_is_better ? "true" : "false") << ",\"samples\":[";
+            os << std::setprecision(17);
+            for (std::size_t j = 0; j != r.samples.size(); ++j) {
+                os << (j ? "," : "");
+                if (std::isfinite(r.samples[j])) os << r.samples[j];
+                else os << "null";
+            }
+            os << "]}";
+        }
+        os << "\n]}\n";
+        os.precision(precision);
+        return os;
+    }
+
+    namespace detail {
+        /*! @internal @brief A minimal recursive descent reader for the subset of JSON written by write_json().
+            Unknown keys are skipped so that results carrying additional fields still load.
+        */
+        class json_reader_t {
+            std::string text;
+            std::size_t at = 0;
+
+        public:
+            explicit json_reader_t(std::istream& is) :
+                text(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>())
+            {}
+
+            std::vector<benchmark_result_t> read() {
+                std::vector<benchmark_result_t> rc;
+                object([&](std::string const& key) {
+                    if (key != "benchmarks") return skip();
+                    array([&]() {
+                        benchmark_result_t r;
+                        object([&](std::string const& field) {
+                            if (field == "name") r.name = string();
+                            else if (field == "unit") r.unit = string();
+                            else if (field == "higher_is_better") r.higher_is_better = boolean();
+                            else if (field == "samples") array([&]() { r.samples.push_back(null() ? std::nan("") : number()); });
+                            else skip();
+                        });
+                        rc.push_back(std::move(r));
+                    });
+                });
+                return rc;
+            }
+
+        private:
+            char peek() {
+                while (at < text.size() && std::isspace(static_cast<unsigned char>(text[at]))) ++at;
+                if (at == text.size()) throw std::runtime_error("json: unexpected end of input");
+                return text[at];
+            }
+
+            void expect(char c) {
+                if (peek() != c) throw std::runtime_error(std::string("json: expected '") + c + "' at offset " + std::to_string(at));
+                ++at;
+            }
+
+            template<typename F> void object(F&& member) {
+                expect('{');
+                if (peek() == '}') { ++at; return; }
+                do {
+                    auto const key = string();
+                    expect(':');
+                    member(key);
+                } while (peek() == ',' && ++at);
+                expect('}');
+            }
+
+            template<typename F> void array(F&& element) {
+                expect('[');
+                if (peek() == ']') { ++at; return; }
+                do element(); while (peek() == ',' && ++at);
+                expect(']');
+            }
+
+            std::string string() {
+                expect('"');
+                std::string rc;
+                while (at < text.size() && text[at] != '"') {
+                    if (text[at] == '\\') ++at;//! @internal escapes are taken literally, names never contain them
+                    rc.push_back(text[at++]);
+                }
+                expect('"');
+                return rc;
+            }
+
+            double number() {
+                peek();
+                std::size_t used = 0;
+                double rc;
+                try {
+                    rc = std::stod(text.substr(at, 32), &used);
+                }
+                catch (std::logic_error const&) {//! @internal std::invalid_argument & std::out_of_range
+                    throw std::runtime_error("json: expected number at offset " + std::to_string(at));
+                }
+                at += used;
+                return rc;
+            }
+
+            bool null() {//! @internal consumes a null if there is one
+                peek();
+                if (text.compare(at, 4, "null") != 0) return false;
+                at += 4;
+                return true;
+            }
+
+            bool boolean() {
+                peek();
+                if (text.compare(at, 4, "true") == 0) { at += 4; return true; }
+                if (text.compare(at, 5, "false") == 0) { at += 5; return false; }
+                throw std::runtime_error("json: expected boolean at offset " + std::to_string(at));
+            }
+
+            void skip() {
+                auto const c = peek();
+                if (c == '{') object([&](std::string const&) { skip(); });
+                else if (c == '[') array([&]() { skip(); });
+                else if (c == '"') string();
+                else if (c == 't' || c == 'f') boolean();
+                else if (!null()) number();
+            }
+        };
+
+        inline double median(std::vector<double> v) {
+            if (v.empty()) return std::nan("");
+            auto const middle = v.begin() + v.size() / 2;
+            std::nth_element(v.begin(), middle, v.end());
+            if (v.size() % 2) return *middle;
+            return (*middle + *std::max_element(v.begin(), middle)) / 2;
+        }
+    }
+
+    /*! @brief Reads results written by write_json().
+        @throws std::runtime_error On malformed input.
+    */
+    inline std::vector<benchmark_result_t> read_json(std::istream& is) {
+        return detail::json_reader_t(is).read();
+    }
+
+    /*! @brief Thresholds of compare_benchmarks().
+    */
+    struct comparison_options_t {
+        double alpha = 0.01;//! Significance level of the Mann-Whitney test.
+        double min_effect = 0.02;//! Relative median change below which a difference is never reported, however significant.
+        unsigned bootstrap_resamples = 2000;//! Resamples of the median ratio confidence interval.
+        double confidence = 0.95;//! Level of the bootstrap confidence interval.
+        std::uint64_t seed = 2016;//! Seed of the bootstrap, so that reruns of a comparison agree.
+    };
+
+    /*! @brief Verdict on one benchmark.
+    */
+    enum class verdict_t {
+        unchanged,//! No significant change of at least min_effect. Differences are noise.
+        improved,//! A significant change of at least min_effect in the good direction.
+        regressed,//! A significant change of at least min_effect in the bad direction.
+        missing//! The benchmark is absent from one side or has fewer than 2 finite samples.
+    };
+
+    /*! @brief The statistics of one benchmark in a comparison.
+    */
+    struct benchmark_comparison_t {
+        std::string name;
+        std::string unit;
+        double baseline_median = 0, candidate_median = 0;
+        double change = 0;//! candidate_median / baseline_median - 1.
+        double change_low = 0, change_high = 0;//! Bootstrap confidence interval of change.
+        double confidence = 0.95;//! Level of the confidence interval, comparison_options_t::confidence.
+        double p_value = 1;//! Two sided Mann-Whitney U test, normal approximation with tie correction.
+        double cliffs_delta = 0;//! P(candidate > baseline) - P(candidate < baseline), in [-1, 1].
+        verdict_t verdict = verdict_t::missing;
+    };
+
+    /*! @brief Mann-Whitney U statistic of x against y & its two sided p-value.
+        @return Returns (U_x, p) where U_x counts the pairs with x > y, ties counting one half.
+    */
+    inline std::pair<double, double> mann_whitney_u(std::vector<double> const& x, std::vector<double> const& y) {
+        struct ranked_t { double value; bool from_x; };
+        std::vector<ranked_t> all;
+        for (auto v : x) all.push_back({ v, true });
+        for (auto v : y) all.push_back({ v, false });
+        std::sort(all.begin(), all.end(), [](ranked_t const& a, ranked_t const& b) { return a.value < b.value; });
+
+        double rank_sum_x = 0, tie_term = 0;
+        for (std::size_t i = 0; i != all.size();) {
+            auto j = i;
+            while (j != all.size() && all[j].value == all[i].value) ++j;
+            auto const midrank = (i + 1 + j) / 2.;
+            auto const ties = static_cast<double>(j - i);
+            tie_term += ties * ties * ties - ties;
+            for (auto k = i; k != j; ++k)
+                if (all[k].from_x) rank_sum_x += midrank;
+            i = j;
+        }
+
+        auto const n1 = static_cast<double>(x.size()), n2 = static_cast<double>(y.size()), n = n1 + n2;
+        auto const u = rank_sum_x - n1 * (n1 + 1) / 2;
+        auto const variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+        if (variance <= 0) return{ u, 1. };
+        auto const z = (std::fabs(u - n1 * n2 / 2) - 0.5) / std::sqrt(variance);//! @internal continuity correction
+        return{ u, std::min(1., std::erfc(std::max(z, 0.) / std::sqrt(2.))) };
+    }
+
+    /*! @brief Compares one benchmark, ignoring samples that aren't finite. @see compare_benchmarks()
+    */
+    inline benchmark_comparison_t compare_benchmark(benchmark_result_t const& baseline_result, benchmark_result_t const& candidate_result, comparison_options_t const& options = {}) {
+        benchmark_comparison_t rc;
+        rc.name = baseline_result.name;
+        rc.unit = baseline_result.unit;
+        rc.confidence = options.confidence;
+        auto finite = [](benchmark_result_t r) {
+            r.samples.erase(std::remove_if(r.samples.begin(), r.samples.end(), [](double v) { return !std::isfinite(v); }), r.samples.end());
+            return r;
+        };
+        auto const baseline = finite(baseline_result), candidate = finite(candidate_result);
+        if (baseline.samples.size() < 2 || candidate.samples.size() < 2) return rc;
+
+        rc.baseline_median = detail::median(baseline.samples);
+        rc.candidate_median = detail::median(candidate.samples);
+        rc.change = rc.candidate_median / rc.baseline_median - 1;
+
+        auto const test = mann_whitney_u(candidate.samples, baseline.samples);
+        rc.p_value = test.second;
+        rc.cliffs_delta = 2 * test.first / (static_cast<double>(candidate.samples.size()) * baseline.samples.size()) - 1;
+
+        std::mt19937_64 engine(options.seed);
+        std::vector<double> changes, b(baseline.samples.size()), c(candidate.samples.size());
+        auto resample = [&engine](std::vector<double> const& from, std::vector<double>& to) {
+            std::uniform_int_distribution<std::size_t> pick(0, from.size() - 1);
+            for (auto& v : to) v = from[pick(engine)];
+        };
+        for (auto i = 0u; i != options.bootstrap_resamples; ++i) {
+            resample(baseline.samples, b);
+            resample(candidate.samples, c);
+            changes.push_back(detail::median(c) / detail::median(b) - 1);
+        }
+        std::sort(changes.begin(), changes.end());
+        auto const tail = (1 - options.confidence) / 2;
+        auto percentile = [&changes](double q) {
+            return changes[std::min(changes.size() - 1, static_cast<std::size_t>(q * changes.size()))];
+        };
+        rc.change_low = percentile(tail);
+        rc.change_high = percentile(1 - tail);
+
+        auto const significant = rc.p_value < options.alpha && (rc.change_low > 0 || rc.change_high < 0);
+        auto const large = std::fabs(rc.change) >= options.min_effect;
+        auto const better = (rc.change > 0) == baseline.higher_is_better;
+        rc.verdict = !(significant && large) ? verdict_t::unchanged : better ? verdict_t::improved : verdict_t::regressed;
+        return rc;
+    }
+
+    /*! @brief Compares every benchmark of baseline with the benchmark of the same name in candidate.
+        @details A benchmark is only reported as changed if all of the following hold:
+            1. The Mann-Whitney U test rejects equal distributions at options.alpha.
+            2. The bootstrap confidence interval of the relative median change excludes 0.
+            3. The relative median change is at least options.min_effect.
+        Everything else is treated as noise.
+    */
+    inline std::vector<benchmark_comparison_t> compare_benchmarks(std::vector<benchmark_result_t> const& baseline, std::vector<benchmark_result_t> const& candidate, comparison_options_t const& options = {}) {
+        std::vector<benchmark_comparison_t> rc;
+        for (auto const& b : baseline) {
+            auto const c = std::find_if(candidate.begin(), candidate.end(), [&b](benchmark_result_t const& r) { return r.name == b.name; });
+            if (c == candidate.end()) {
+                rc.push_back({ b.name, b.unit });
+                rc.back().confidence = options.confidence;
+                continue;
+            }
+            rc.push_back(compare_benchmark(b, *c, options));
+        }
+        return rc;
+    }
+
+    /*! @brief Returns true if no benchmark regressed, nor went missing unless allow_missing.
+        @details A benchmark missing from the candidate, e.g. one that crashed or was renamed, fails by default, as it
+        may hide a regression.
+    */
+    inline bool passed(std::vector<benchmark_comparison_t> const& comparisons, bool allow_missing = false) {
+        return std::none_of(comparisons.begin(), comparisons.end(), [allow_missing](benchmark_comparison_t const& c) {
+            return c.verdict == verdict_t::regressed || (c.verdict == verdict_t::missing && !allow_missing);
+        });
+    }
+
+    /*! @brief Prints the comparison report, one row per benchmark, followed by the overall PASS / FAIL.
+        @details The confidence intervals are labelled with the level of the first comparison, as compare_benchmarks()
+        computes them all at one level.
+    */
+    inline std::ostream& operator<< (std::ostream& os, std::vector<benchmark_comparison_t> const& comparisons) {
+        static char const* const verdicts[] = { "noise", "improved", "REGRESSED", "missing" };
+        auto const flags = os.flags();
+        auto const precision = os.precision();
+        std::ostringstream level;
+        level << std::setprecision(4) << 100 * (comparisons.empty() ? benchmark_comparison_t{}.confidence : comparisons.front().confidence) << "% CI";
+        os << std::left << std::setw(16) << "benchmark" << std::right << std::setw(14) << "baseline" << std::setw(14) << "candidate"
+            << std::setw(9) << "change" << std::setw(20) << level.str() << std::setw(10) << "p" << std::setw(8) << "delta" << "  verdict\n";
+        for (auto const& c : comparisons) {
+            std::ostringstream ci;
+            ci << std::fixed << std::setprecision(1) << "[" << 100 * c.change_low << "%, " << 100 * c.change_high << "%]";
+            os << std::left << std::setw(16) << c.name << std::right << std::setprecision(4) << std::setw(14) << c.baseline_median
+                << std::setw(14) << c.candidate_median << std::fixed << std::setprecision(1) << std::setw(8) << 100 * c.change << "%"
+                << std::setw(20) << ci.str() << std::defaultfloat << std::setprecision(2) << std::setw(10) << c.p_value
+                << std::setw(8) << c.cliffs_delta << "  " << verdicts[static_cast<int>(c.verdict)] << "\n";
+        }
+        os << (passed(comparisons) ? "PASS" : "FAIL") << "\n";
+        os.flags(flags);
+        os.precision(precision);
+        return os;
+    }
+}
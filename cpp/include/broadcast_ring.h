@@ -0,0 +1,163 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+namespace the_learning_games {
+
+    /*! @brief Outcome of broadcast_ring_t::poll().
+    */
+    enum class poll_result_t {
+        ok,//! The next event was copied out & the cursor advanced.
+        empty,//! The cursor is level with the producer.
+        lagged//! The producer has overwritten the next event. The reader must resync from a snapshot.
+    };
+
+    /*! @brief A single producer, multi consumer broadcast ring of sequence numbered events.
+        @details Each event is written once into a slot of a power of two ring; every consumer keeps its own cursor &
+        reads the slots in place, so publishing costs the same for 1 or 10000 consumers and never waits on any of them.
+        Each slot is a seqlock: its stamp is odd while the producer writes it & even, encoding the sequence number, once
+        it is complete. A consumer whose next sequence number has been overwritten, either before or while copying,
+        gets poll_result_t::lagged instead of a torn or out of order event.
+        The payload is stored in relaxed atomic words so that the racing reads of a seqlock are well defined.
+        Event must be trivially copyable.
+    */
+    template<typename Event>
+    class broadcast_ring_t {
+        static_assert(std::is_trivially_copyable<Event>::value, "Event must be trivially copyable");
+        static constexpr std::size_t const words = (sizeof(Event) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        struct alignas(64) slot_t {
+            std::atomic<std::uint64_t> stamp{ 0 };//! @internal 2 * sequence + 1 while writing, 2 * sequence + 2 when complete
+            std::atomic<std::uint64_t> payload[words];
+        };
+
+        std::unique_ptr<slot_t[]> slots;
+        std::uint64_t const mask;
+        alignas(64) std::atomic<std::uint64_t> head{ 0 };//! @internal sequence number of the next publish()
+
+    public:
+        //! Position of a consumer in the ring. Owned by a single consumer thread.
+        struct cursor_t {
+            std::uint64_t next = 0;//! Sequence number of the next event to read.
+        };
+
+        /*! @param capacity The number of events retained, rounded up to a power of two. Bounds how far a consumer may fall behind.
+        */
+        explicit broadcast_ring_t(std::size_t capacity) :
+            slots(new slot_t[round_up(capacity)]),
+            mask(round_up(capacity) - 1)
+        {
+            for (std::size_t i = 0; i <= mask; ++i)
+                for (auto& word : slots[i].payload) word.store(0, std::memory_order_relaxed);
+        }
+
+        /*! @brief Publishes an event. Must only be called by the single producer.
+            @return Returns the sequence number of the event.
+        */
+        std::uint64_t publish(Event const& event) {
+            auto const sequence = head.load(std::memory_order_relaxed);
+            auto& slot = slots[sequence & mask];
+
+            std::uint64_t buffer[words] = {};
+            std::memcpy(buffer, &event, sizeof(Event));
+
+            slot.stamp.store(2 * sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i != words; ++i)
+                slot.payload[i].store(buffer[i], std::memory_order_relaxed);
+            slot.stamp.store(2 * sequence + 2, std::memory_order_release);
+
+            head.store(sequence + 1, std::memory_order_release);
+            return sequence;
+        }
+
+        /*! @brief Returns a cursor positioned after the last published event.
+        */
+        cursor_t subscribe() const {
+            return{ head.load(std::memory_order_acquire) };
+        }
+
+        /*! @brief Returns a cursor positioned at sequence, e.g. one past the sequence number of a snapshot.
+        */
+        cursor_t subscribe_at(std::uint64_t sequence) const {
+            return{ sequence };
+        }
+
+        /*! @brief Copies the event at cursor into event & advances cursor.
+            Safe to call concurrently from any number of consumers, each with its own cursor.
+        */
+        poll_result_t poll(cursor_t& cursor, Event& event) const {
+            auto const& slot = slots[cursor.next & mask];
+            auto const expected = 2 * cursor.next + 2;
+
+            auto const before = slot.stamp.load(std::memory_order_acquire);
+            if (before < expected)
+                return poll_result_t::empty;//! @internal not yet published, or being written right now
+            if (before > expected)
+                return poll_result_t::lagged;
+
+            std::uint64_t buffer[words];
+            for (std::size_t i = 0; i != words; ++i)
+                buffer[i] = slot.payload[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.stamp.load(std::memory_order_relaxed) != before)
+                return poll_result_t::lagged;
+
+            std::memcpy(&event, buffer, sizeof(Event));
+            ++cursor.next;
+            return poll_result_t::ok;
+        }
+
+        /*! @brief Returns the number of events a cursor is behind the producer.
+        */
+        std::uint64_t backlog(cursor_t const& cursor) const {
+            auto const h = head.load(std::memory_order_acquire);
+            return h > cursor.next ? h - cursor.next : 0;
+        }
+
+        std::uint64_t published() const { return head.load(std::memory_order_acquire); }//! @brief Returns the number of events published.
+        std::size_t capacity() const { return static_cast<std::size_t>(mask + 1); }//! @brief Returns the number of events retained.
+
+    private:
+        static std::size_t round_up(std::size_t capacity) {
+            if (capacity == 0) throw std::logic_error("pre: capacity is zero");
+            std::size_t rc = 1;
+            while (rc < capacity) rc <<= 1;
+            return rc;
+        }
+    };
+}
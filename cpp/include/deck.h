@@ -0,0 +1,157 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace the_learning_games {
+
+    /*! @brief A deck of cards drawn without replacement, with the roll() interface of a dice.
+        @details Drawing walks a shuffled copy of the cards & reshuffles the whole deck the moment it is exhausted, so
+        every full pass is a uniformly random permutation. The Fisher-Yates shuffle is batched (Brackett-Rozinsky &
+        Lemire): consecutive bounds n, n - 1, ... whose product fits 32 bits share a single 32 bit random number, which
+        is multiplied out into one index per bound, with one rejection test per batch. The batches depend only on the
+        deck size & are planned once, so a 52 card shuffle costs 11 random numbers instead of 51.
+        Equal seeds produce equal sequences of cards.
+        @tparam Engine A 32 bit uniform random bit generator.
+    */
+    template<typename Integer, typename Engine = std::mt19937>
+    class deck_t {
+        static_assert(Engine::min() == 0 && Engine::max() == 0xffffffffu, "Engine must produce 32 bits");
+
+    public:
+        /*! Value type representing a card, the offset a player moves.
+        */
+        using roll_t = Integer;
+
+    private:
+        //! @internal One batch of the shuffle: positions first, first - 1, ... first - count + 1 swap with an index below their bound.
+        struct batch_t {
+            std::uint32_t first;
+            std::uint32_t count;
+            std::uint32_t threshold;//! @internal 2^32 mod the product of the bounds, leftovers below it are rejected
+        };
+
+        Engine engine;
+        std::vector<roll_t> cards;
+        std::vector<batch_t> batches;
+        std::size_t next_card;
+        roll_t highest;
+
+    public:
+        /*! @brief Constructs a reproducible deck.
+            @param cards The cards of the deck, in any order.
+            @param seed Equal seeds produce equal sequences of cards.
+        */
+        deck_t(std::vector<roll_t> cards, typename Engine::result_type seed) :
+            engine(seed),
+            cards(std::move(cards))
+        {
+            if (this->cards.empty()) throw std::logic_error("pre: empty deck");
+            if (this->cards.size() > std::numeric_limits<std::uint32_t>::max()) throw std::logic_error("pre: deck too large");
+            highest = *std::max_element(this->cards.begin(), this->cards.end());
+            plan();
+            reshuffle();
+        }
+
+        /*! @brief Constructs a deck seeded from std::random_device.
+        */
+        explicit deck_t(std::vector<roll_t> cards) :
+            deck_t(std::move(cards), std::random_device()())
+        {}
+
+        /*! @brief Draws the next card, reshuffling the deck first if it is exhausted.
+        */
+        roll_t roll() {
+            if (next_card == cards.size()) reshuffle();
+            return cards[next_card++];
+        }
+
+        /*! @brief Draws a card for every element of [first, last).
+        */
+        template<typename OutputIt>
+        void fill(OutputIt first, OutputIt last) {
+            while (first != last) {
+                if (next_card == cards.size()) reshuffle();
+                auto const n = std::min(static_cast<std::size_t>(std::distance(first, last)), cards.size() - next_card);
+                first = std::copy_n(cards.begin() + next_card, n, first);
+                next_card += n;
+            }
+        }
+
+        /*! @brief Shuffles all cards back into the deck.
+        */
+        void reshuffle() {
+            for (auto const& batch : batches) {
+                std::uint32_t indices[32];
+                for (;;) {
+                    auto random = static_cast<std::uint32_t>(engine());
+                    for (std::uint32_t j = 0; j != batch.count; ++j) {
+                        auto const product = std::uint64_t{ random } * (batch.first - j + 1);
+                        indices[j] = static_cast<std::uint32_t>(product >> 32);
+                        random = static_cast<std::uint32_t>(product);
+                    }
+                    if (random >= batch.threshold) break;
+                }
+                for (std::uint32_t j = 0; j != batch.count; ++j)
+                    std::swap(cards[batch.first - j], cards[indices[j]]);
+            }
+            next_card = 0;
+        }
+
+        std::size_t size() const { return cards.size(); }//! @brief Returns the number of cards in the deck.
+        std::size_t remaining() const { return cards.size() - next_card; }//! @brief Returns the number of cards left before the next reshuffle.
+
+        /*! @brief Returns the highest card, the counterpart of dice_t::sides().
+        */
+        roll_t sides() const { return highest; }
+
+    private:
+        //! @internal Groups the bounds n, n - 1, ..., 2 of the shuffle into batches whose product fits 32 bits.
+        void plan() {
+            for (auto first = static_cast<std::uint32_t>(cards.size() - 1); first >= 1; ) {
+                std::uint64_t product = 1;
+                std::uint32_t count = 0;
+                while (first - count >= 1 && count < 32 && product * (first - count + 1) <= (std::uint64_t{ 1 } << 32)) {
+                    product *= first - count + 1;
+                    ++count;
+                }
+                batches.push_back({ first, count, static_cast<std::uint32_t>((std::uint64_t{ 1 } << 32) % product) });
+                first -= count;
+            }
+        }
+    };
+}
@@ -32,28 +32,64 @@ SOFTWARE.
 
 #include <random>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <future>
 #include <cassert>
 
+#include "memory_accounting.h"
+
 namespace the_learning_games {
     namespace detail {
         template<typename T>
         constexpr bool const type_larget_than_int_v = sizeof(T) >= sizeof(int);
+
+        //! @internal True if Dice has a bulk `fill(first, last)`.
+        template<typename Dice, typename = void>
+        struct has_fill : std::false_type {};
+        template<typename Dice>
+        struct has_fill<Dice, std::void_t<decltype(std::declval<Dice&>().fill(std::declval<typename Dice::roll_t*>(), std::declval<typename Dice::roll_t*>()))>> : std::true_type {};
+
+        /*! @internal @brief Returns Engine seeded with all 64 bits of seed.
+            @details Seeds up to Engine::max() seed it directly, as always; larger ones, which e.g. std::mt19937 would
+            reduce modulo 2^32, go through a std::seed_seq of both halves.
+        */
+        template<typename Engine>
+        Engine seeded_engine(std::uint64_t seed) {
+            using result_t = typename Engine::result_type;
+            if (seed <= static_cast<std::uint64_t>(Engine::max())) return Engine(static_cast<result_t>(seed));
+            std::seed_seq seeds{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) };
+            return Engine(seeds);
+        }
+
+        template<typename Dice>
+        void fill_rolls(Dice& dice, typename Dice::roll_t* first, std::size_t count, std::true_type) {
+            dice.fill(first, first + count);
+        }
+
+        template<typename Dice>
+        void fill_rolls(Dice& dice, typename Dice::roll_t* first, std::size_t count, std::false_type) {
+            std::generate_n(first, count, [&dice]() { return dice.roll(); });
+        }
     }
 
     /*! @brief This class represents a normal N sided dice. @see https://en.wikipedia.org/wiki/Dice
+        @tparam Engine The uniform random bit generator, e.g. std::minstd_rand for a smaller & faster state.
         @todo replace typename Integral with concept
     */
-    template<typename Integer, typename = std::void_t<std::enable_if_t< std::is_integral<Integer>::value, void>>>
+    template<typename Integer, typename Engine = std::mt19937, typename = std::void_t<std::enable_if_t< std::is_integral<Integer>::value, void>>>
     class dice_t {
     public:
         /*! Value type representing the roll of a dice.
         */
         using roll_t = Integer;
 
+        /*! The random bit generator.
+        */
+        using engine_t = Engine;
+
     private:
-        std::mt19937 engine;
+        Engine engine;
         std::uniform_int_distribution<std::conditional_t<detail::type_larget_than_int_v<Integer>, Integer, int>> distribution;
 
     public:
@@ -65,6 +101,15 @@ namespace the_learning_games {
             distribution(1, sides)
         {}
 
+        /*! @brief Constructs a reproducible dice.
+        @param sides The number of sides.
+        @param seed The seed of the underlying engine. Equal seeds produce equal sequences of rolls.
+        */
+        dice_t(roll_t sides, std::uint64_t seed) :
+            engine(detail::seeded_engine<Engine>(seed)),
+            distribution(1, sides)
+        {}
+
         /*! @brief This function rolls the dice
         */
         roll_t roll() {
@@ -76,6 +121,93 @@ namespace the_learning_games {
         roll_t sides() const { return static_cast<Integer>(distribution.max()); }
     };
 
+    /*! @brief An N sided dice on a splittable SplitMix64 stream, for nested parallel work.
+        @details The state is a 64 bit seed & an odd gamma; every roll adds gamma to the seed & mixes the result.
+        split() draws the seed & gamma of a child from the parent's own stream, so a task can hand each subtask an
+        independent, reproducible dice in O(1) without any shared state: results depend only on the tree of split()
+        calls, never on which thread runs which subtask. Gammas with too few bit transitions are rejected as they mix
+        poorly. Rolls are unbiased, by multiply & shift with rejection (Lemire).
+        @see Steele, Lea & Flood, "Fast splittable pseudorandom number generators", OOPSLA 2014.
+    */
+    template<typename Integer>
+    class splittable_dice_t {
+    public:
+        /*! Value type representing the roll of a dice.
+        */
+        using roll_t = Integer;
+
+        //! The gamma of a dice constructed from a seed, 2^64 / golden ratio.
+        static constexpr std::uint64_t const golden_gamma = 0x9e3779b97f4a7c15ull;
+
+    private:
+        std::uint64_t seed;
+        std::uint64_t gamma;
+        std::uint32_t sides_;
+        std::uint32_t threshold;//! @internal 2^32 mod sides, low products below it are rejected
+
+    public:
+        /*! @brief Constructs a reproducible dice.
+            @param sides The number of sides.
+            @param seed Equal seeds produce equal sequences of rolls & equal trees of split() dice.
+        */
+        splittable_dice_t(roll_t sides, std::uint64_t seed) :
+            splittable_dice_t(sides, seed, golden_gamma)
+        {}
+
+        /*! @brief This function rolls the dice
+        */
+        roll_t roll() {
+            auto product = (next() >> 32) * sides_;
+            while (static_cast<std::uint32_t>(product) < threshold)
+                product = (next() >> 32) * sides_;
+            return static_cast<roll_t>((product >> 32) + 1);
+        }
+
+        /*! @brief Returns a child dice with the same sides, statistically independent of *this & of every other child.
+            Advances *this by two rolls' worth of state.
+        */
+        splittable_dice_t split() {
+            auto const child_seed = next();
+            return splittable_dice_t(static_cast<roll_t>(sides_), child_seed, mix_gamma(seed += gamma));
+        }
+
+        /*! @brief Returns the Number of sides of the dice
+        */
+        roll_t sides() const { return static_cast<roll_t>(sides_); }
+
+    private:
+        splittable_dice_t(roll_t sides, std::uint64_t seed, std::uint64_t gamma) :
+            seed(seed),
+            gamma(gamma),
+            sides_(static_cast<std::uint32_t>(sides)),
+            threshold(static_cast<std::uint32_t>((std::uint64_t{ 1 } << 32) % static_cast<std::uint32_t>(sides)))
+        {
+            assert(sides > 0);
+        }
+
+        //! @internal The next 64 bits of the stream.
+        std::uint64_t next() {
+            return mix64(seed += gamma);
+        }
+
+        //! @internal Stafford's variant 13 finalizer.
+        static std::uint64_t mix64(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        //! @internal MurmurHash3's finalizer, forced odd & with enough bit transitions.
+        static std::uint64_t mix_gamma(std::uint64_t z) {
+            z = (z ^ (z >> 33)) * 0xff51afd7ed558ccdull;
+            z = (z ^ (z >> 33)) * 0xc4ceb9fe1a85ec53ull;
+            z = (z ^ (z >> 33)) | 1;
+            auto transitions = 0;
+            for (auto t = z ^ (z >> 1); t; t &= t - 1) ++transitions;
+            return transitions < 24 ? z ^ 0xaaaaaaaaaaaaaaaaull : z;
+        }
+    };
+
     /*! @brief A dice which can be rolled upto 3 times.
         @details This class represents a normal N sided dice with the following
         rolling rules:
@@ -106,6 +238,28 @@ namespace the_learning_games {
             dice(sides)
         {}
 
+        /*! @brief Constructs the underlying Dice from args, e.g. a pool_dice_t from a dice_distribution_t & a seed.
+        */
+        template<typename... Args>
+        explicit upto3_dice_t(std::in_place_t, Args&&... args) :
+            dice(std::forward<Args>(args)...)
+        {}
+
+        /*! @brief Constructs the underlying Dice with additional arguments.
+            @param sides The number of sides.
+            @param args Forwarded to the underlying Dice, e.g. a seed or a buffer length.
+        */
+        template<typename Arg, typename... Args>
+        upto3_dice_t(single_roll_t sides, Arg&& arg, Args&&... args) :
+            dice(sides, std::forward<Arg>(arg), std::forward<Args>(args)...)
+        {}
+
+        /*! @brief Returns an upto3_dice_t on Dice::split(), for a Dice such as splittable_dice_t.
+        */
+        upto3_dice_t split() {
+            return upto3_dice_t(std::in_place, dice.split());
+        }
+
         /*! @brief This function rolls the dice upto 3 times
         */
         roll_t roll() {
@@ -126,7 +280,7 @@ namespace the_learning_games {
 
         /*! @brief Returns the Number of sides of the dice
         */
-        auto sides() { return d.sides(); }
+        auto sides() const { return dice.sides(); }
     };
 
     /*!
@@ -140,26 +294,49 @@ namespace the_learning_games {
         */
         using roll_t = typename Dice::roll_t;
 
-    private:
-        static constexpr auto buffer_length = 128 * 1024 * 1024;
+        //! The default number of rolls held by both buffers together.
+        static constexpr std::size_t const default_buffer_length = 128 * 1024 * 1024;
 
+    private:
+        std::ptrdiff_t const half_length;//! @internal rolls per buffer
+        memory_charge_t const charge;//! @internal both buffers, charged to memory_component_t::dice
         std::unique_ptr<roll_t[]> read, write;
-        std::atomic_ptrdiff_t read_index = buffer_length / 2;
+        std::atomic_ptrdiff_t read_index;
         Dice d;
         std::future<void> writer;
         std::mutex swap_mutex;
 
     public:
         /*! Allocates a read & a write buffer and then asynchronously requests a fill_buffer().
+            @param sides The number of sides.
+            @param buffer_length The number of rolls held by both buffers together, @see the_learning_games::plan_resources()
         */
-        fixed_buffer_dice_t(roll_t sides) :
-            read(new roll_t[64 * 1024 * 1024]),
-            write(new roll_t[64 * 1024 * 1024]),
+        fixed_buffer_dice_t(roll_t sides, std::size_t buffer_length = default_buffer_length) :
+            half_length(static_cast<std::ptrdiff_t>(std::max<std::size_t>(buffer_length / 2, 1))),
+            charge(memory_component_t::dice, 2 * half_length * sizeof(roll_t)),
+            read(new roll_t[half_length]),
+            write(new roll_t[half_length]),
+            read_index(half_length),
             d(sides)
         {
             fill_buffer();
         }
 
+        /*! @brief Constructs the underlying Dice from args, e.g. a pool_dice_t from a dice_distribution_t & a seed.
+            @param buffer_length The number of rolls held by both buffers together.
+        */
+        template<typename... Args>
+        fixed_buffer_dice_t(std::in_place_t, std::size_t buffer_length, Args&&... args) :
+            half_length(static_cast<std::ptrdiff_t>(std::max<std::size_t>(buffer_length / 2, 1))),
+            charge(memory_component_t::dice, 2 * half_length * sizeof(roll_t)),
+            read(new roll_t[half_length]),
+            write(new roll_t[half_length]),
+            read_index(half_length),
+            d(std::forward<Args>(args)...)
+        {
+            fill_buffer();
+        }
+
         /*! @brief Performs a read operation on the the read buffer.
             Performs a swap operation when the read buffer is fully utilized.
             In most cases the previous async write operation will have completed and the writer.get() is unlikely to block.
@@ -167,7 +344,7 @@ namespace the_learning_games {
             This operation must be synchronized externally if performed upon a single object from multiple threads.
         */
         roll_t roll() {
-            if (read_index == buffer_length / 2)
+            if (read_index == half_length)
                 swap_buffers();
             return read[read_index++];
         }
@@ -175,17 +352,21 @@ namespace the_learning_games {
 
         /*! @brief Returns the Number of sides of the dice
         */
-        auto sides() { return d.sides(); }
+        auto sides() const { return d.sides(); }
+
+        /*! @brief Returns the number of rolls held by both buffers together.
+        */
+        std::size_t buffer_length() const { return 2 * static_cast<std::size_t>(half_length); }
 
     private:
         /*! @internal
-            @details We launch a asynchronous task to fill the write buffer.
+            @details We launch a asynchronous task to fill the write buffer, through the bulk Dice::fill() where available.
         */
         void fill_buffer() {
             using std::begin; using std::end;
 
             writer = std::async(std::launch::async, [this]() {
-                std::generate_n(write.get(), buffer_length / 2, [this]() { return d.roll(); });
+                detail::fill_rolls(d, write.get(), static_cast<std::size_t>(half_length), detail::has_fill<Dice>{});//! @internal Dice::fill() if it has one
             });
         }
 
@@ -193,7 +374,7 @@ namespace the_learning_games {
         */
         void swap_buffers() {
             std::lock_guard<std::mutex> guard(swap_mutex);
-            if (read_index != buffer_length / 2) return;
+            if (read_index != half_length) return;
 
             writer.get();// wait on future value if required
             swap(read, write);// swap in place
@@ -0,0 +1,312 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace the_learning_games {
+
+    /*! @brief The exact distribution of a composite dice roll, as integer weights over a range of values.
+        @details Weights stay exact through every combinator, so a 10d10 sum is as exact as a 2d6; they throw
+        std::overflow_error rather than wrap once the total exceeds 64 bits.
+    */
+    class dice_distribution_t {
+        int min_ = 1;
+        std::vector<std::uint64_t> weights;//! @internal weights[v - min_]
+
+    public:
+        /*! @param min The value of weights[0].
+            @param weights The relative frequencies of min, min + 1, ...
+        */
+        dice_distribution_t(int min, std::vector<std::uint64_t> weights) :
+            min_(min),
+            weights(std::move(weights))
+        {
+            trim();
+            if (this->weights.empty()) throw std::logic_error("pre: distribution without any weight");
+            total();
+        }
+
+        /*! @brief Returns the distribution of a single fair dice with sides sides.
+        */
+        static dice_distribution_t uniform(int sides) {
+            if (sides < 1) throw std::logic_error("pre: sides less than one");
+            return dice_distribution_t(1, std::vector<std::uint64_t>(static_cast<std::size_t>(sides), 1));
+        }
+
+        int min() const { return min_; }//! @brief Returns the smallest value with a weight.
+        int max() const { return min_ + static_cast<int>(weights.size()) - 1; }//! @brief Returns the largest value with a weight.
+
+        /*! @brief Returns the weight of value v, 0 outside [min(), max()].
+        */
+        std::uint64_t weight(int v) const {
+            return v < min_ || v > max() ? 0 : weights[static_cast<std::size_t>(v - min_)];
+        }
+
+        /*! @brief Returns the sum of all weights.
+        */
+        std::uint64_t total() const {
+            std::uint64_t rc = 0;
+            for (auto w : weights) rc = checked_add(rc, w);
+            return rc;
+        }
+
+        /*! @brief Returns the probability of value v.
+        */
+        double probability(int v) const {
+            return static_cast<double>(weight(v)) / static_cast<double>(total());
+        }
+
+        /*! @brief Returns the distribution of the sum of independent rolls of *this & other, by convolution.
+        */
+        dice_distribution_t operator+(dice_distribution_t const& other) const {
+            checked_multiply(total(), other.total());
+            std::vector<std::uint64_t> rc(weights.size() + other.weights.size() - 1);
+            for (std::size_t i = 0; i != weights.size(); ++i)
+                for (std::size_t j = 0; j != other.weights.size(); ++j)
+                    rc[i + j] += weights[i] * other.weights[j];//! @internal bounded by the product of the totals
+            return dice_distribution_t(min_ + other.min_, std::move(rc));
+        }
+
+        /*! @brief Returns the distribution with modifier added to every value.
+        */
+        dice_distribution_t operator+(int modifier) const {
+            return dice_distribution_t(min_ + modifier, weights);
+        }
+
+        /*! @brief Returns the distribution with values below lo raised to lo & values above hi lowered to hi.
+        */
+        dice_distribution_t clamp(int lo, int hi) const {
+            if (lo > hi) throw std::logic_error("pre: empty clamp range");
+            std::vector<std::uint64_t> rc(static_cast<std::size_t>(hi - lo + 1));
+            for (auto v = min_; v <= max(); ++v) {
+                auto& slot = rc[static_cast<std::size_t>(std::min(std::max(v, lo), hi) - lo)];
+                slot = checked_add(slot, weight(v));
+            }
+            return dice_distribution_t(lo, std::move(rc));
+        }
+
+    private:
+        void trim() {
+            auto first = std::find_if(weights.begin(), weights.end(), [](std::uint64_t w) { return w != 0; });
+            min_ += static_cast<int>(first - weights.begin());
+            weights.erase(weights.begin(), first);
+            while (!weights.empty() && weights.back() == 0) weights.pop_back();
+        }
+
+        static std::uint64_t checked_add(std::uint64_t a, std::uint64_t b) {
+            if (a > std::numeric_limits<std::uint64_t>::max() - b) throw std::overflow_error("dice distribution weights overflow");
+            return a + b;
+        }
+
+        static std::uint64_t checked_multiply(std::uint64_t a, std::uint64_t b) {
+            if (b && a > std::numeric_limits<std::uint64_t>::max() / b) throw std::overflow_error("dice distribution weights overflow");
+            return a * b;
+        }
+    };
+
+    /*! @brief Returns the distribution of the sum of count dice with sides sides, e.g. 2d6.
+        @details Built by binary powering of the convolution, O(log count) convolutions.
+    */
+    inline dice_distribution_t sum_of_dice(int count, int sides) {
+        if (count < 1) throw std::logic_error("pre: dice count less than one");
+        auto power = dice_distribution_t::uniform(sides);
+        auto rc = power;
+        for (auto n = count - 1; n; n >>= 1) {
+            if (n & 1) rc = rc + power;
+            if (n > 1) power = power + power;
+        }
+        return rc;
+    }
+
+    /*! @brief Returns the distribution of the sum of the keep highest of count dice with sides sides, e.g. 4d6 drop lowest.
+        @details Rolls the dice one at a time keeping the distribution of the sorted keep highest so far, so the work
+        grows with the number of such multisets rather than with sides^count.
+    */
+    inline dice_distribution_t keep_highest(int count, int sides, int keep) {
+        if (count < 1 || sides < 1) throw std::logic_error("pre: dice count or sides less than one");
+        if (keep < 1 || keep > count) throw std::logic_error("pre: keep outside [1, count]");
+
+        std::map<std::vector<int>, std::uint64_t> kept{ { {}, 1 } };//! @internal ascending kept values -> ways
+        for (auto i = 0; i != count; ++i) {
+            std::map<std::vector<int>, std::uint64_t> next;
+            for (auto const& state : kept) {
+                for (auto v = 1; v <= sides; ++v) {
+                    auto values = state.first;
+                    values.insert(std::upper_bound(values.begin(), values.end(), v), v);
+                    if (static_cast<int>(values.size()) > keep) values.erase(values.begin());
+                    auto& ways = next[values];
+                    if (ways > std::numeric_limits<std::uint64_t>::max() - state.second) throw std::overflow_error("dice distribution weights overflow");
+                    ways += state.second;
+                }
+            }
+            kept.swap(next);
+        }
+
+        std::vector<std::uint64_t> rc(static_cast<std::size_t>(keep * sides + 1));
+        for (auto const& state : kept) {
+            auto sum = 0;
+            for (auto v : state.first) sum += v;
+            rc[static_cast<std::size_t>(sum)] += state.second;
+        }
+        return dice_distribution_t(0, std::move(rc));
+    }
+
+    /*! @brief Returns the distribution of the sum of the keep lowest of count dice with sides sides, e.g. disadvantage.
+    */
+    inline dice_distribution_t keep_lowest(int count, int sides, int keep) {
+        auto const highest = keep_highest(count, sides, keep);
+        std::vector<std::uint64_t> rc;//! @internal a dice showing v is a dice showing sides + 1 - v upside down
+        for (auto v = highest.max(); v >= highest.min(); --v) rc.push_back(highest.weight(v));
+        return dice_distribution_t(keep * (sides + 1) - highest.max(), std::move(rc));
+    }
+
+    /*! @brief A dice rolling any dice_distribution_t in O(1) through Vose's alias method.
+        @details Each roll takes one 64 bit output of Engine: the high half picks a column by multiply & shift with
+        rejection, the low half decides between the column's value & its alias against a 32 bit threshold, so the
+        probabilities are those of the distribution rounded to multiples of 2^-32 / columns.
+        sides() is max(), which makes an upto3_dice_t<pool_dice_t> reroll on the highest value.
+        @tparam Engine A 64 bit uniform random bit generator.
+    */
+    template<typename Integer, typename Engine = std::mt19937_64>
+    class pool_dice_t {
+        static_assert(Engine::min() == 0 && Engine::max() == 0xffffffffffffffffull, "Engine must produce 64 bits");
+
+    public:
+        /*! Value type representing the roll of a dice.
+        */
+        using roll_t = Integer;
+
+    private:
+        Engine engine;
+        dice_distribution_t distribution_;
+        std::vector<std::uint32_t> thresholds;//! @internal column i keeps its own value if the low half is below thresholds[i]
+        std::vector<roll_t> values, aliases;
+        std::uint32_t columns;
+        std::uint32_t rejection;//! @internal 2^32 mod columns
+        bool always;//! @internal every threshold is 2^32, the aliases are never taken
+
+    public:
+        /*! @brief Constructs a reproducible dice.
+            @param distribution The distribution of a roll.
+            @param seed Equal seeds produce equal sequences of rolls.
+            @throws std::logic_error If a value of distribution doesn't fit roll_t.
+        */
+        pool_dice_t(dice_distribution_t distribution, typename Engine::result_type seed) :
+            engine(seed),
+            distribution_(std::move(distribution))
+        {
+            build();
+        }
+
+        /*! @brief Constructs a dice seeded from std::random_device.
+        */
+        explicit pool_dice_t(dice_distribution_t distribution) :
+            pool_dice_t(std::move(distribution), (static_cast<typename Engine::result_type>(std::random_device()()) << 32) ^ std::random_device()())
+        {}
+
+        /*! @brief This function rolls the dice
+        */
+        roll_t roll() {
+            auto const bits = engine();
+            auto product = (bits >> 32) * columns;
+            while (static_cast<std::uint32_t>(product) < rejection)
+                product = (engine() >> 32) * columns;
+            auto const column = static_cast<std::size_t>(product >> 32);
+            return always || static_cast<std::uint32_t>(bits) < thresholds[column] ? values[column] : aliases[column];
+        }
+
+        /*! @brief Rolls the dice once per element of [first, last), the bulk path of fixed_buffer_dice_t.
+        */
+        template<typename OutputIt>
+        void fill(OutputIt first, OutputIt last) {
+            for (; first != last; ++first) *first = roll();
+        }
+
+        /*! @brief Returns the largest value of the dice.
+        */
+        roll_t sides() const { return static_cast<roll_t>(distribution_.max()); }
+
+        /*! @brief Returns the distribution the dice rolls.
+        */
+        dice_distribution_t const& distribution() const { return distribution_; }
+
+    private:
+        void build() {
+            if (static_cast<std::intmax_t>(distribution_.min()) < static_cast<std::intmax_t>(std::numeric_limits<roll_t>::min())
+                || (distribution_.max() > 0 && static_cast<std::uintmax_t>(distribution_.max()) > static_cast<std::uintmax_t>(std::numeric_limits<roll_t>::max())))
+                throw std::logic_error("pre: a value of the distribution doesn't fit roll_t");
+            auto const n = static_cast<std::size_t>(distribution_.max() - distribution_.min() + 1);
+            if (n > std::numeric_limits<std::uint32_t>::max()) throw std::logic_error("pre: too many values for an alias table");
+            columns = static_cast<std::uint32_t>(n);
+            rejection = static_cast<std::uint32_t>((std::uint64_t{ 1 } << 32) % columns);
+
+            //! @internal scaled[i] is the probability of value i times n, in units of 2^-32
+            auto const total = static_cast<long double>(distribution_.total());
+            std::vector<long double> scaled(n);
+            std::vector<std::size_t> small, large;
+            for (std::size_t i = 0; i != n; ++i) {
+                scaled[i] = static_cast<long double>(distribution_.weight(distribution_.min() + static_cast<int>(i))) * n / total * 4294967296.L;
+                (scaled[i] < 4294967296.L ? small : large).push_back(i);
+            }
+
+            thresholds.assign(n, 0);
+            values.resize(n);
+            aliases.resize(n);
+            for (std::size_t i = 0; i != n; ++i) values[i] = aliases[i] = static_cast<roll_t>(distribution_.min() + static_cast<int>(i));
+
+            std::vector<bool> full(n);
+            while (!small.empty() && !large.empty()) {
+                auto const s = small.back(), l = large.back();
+                small.pop_back();
+                thresholds[s] = static_cast<std::uint32_t>(scaled[s] + .5L > 4294967295.L ? 4294967295.L : scaled[s] + .5L);
+                aliases[s] = values[l];
+                scaled[l] -= 4294967296.L - scaled[s];
+                if (scaled[l] < 4294967296.L) {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+            for (auto i : large) full[i] = true;
+            for (auto i : small) full[i] = true;//! @internal rounding leftovers, within 2^-32 of a full column
+            always = true;
+            for (std::size_t i = 0; i != n; ++i) {
+                if (full[i]) thresholds[i] = std::numeric_limits<std::uint32_t>::max(), aliases[i] = values[i];
+                else always = false;
+            }
+        }
+    };
+}
@@ -0,0 +1,93 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+
+#if defined(__AVX2__)
+#define TLG_SIMD_AVX2 1
+#else
+#define TLG_SIMD_AVX2 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TLG_SIMD_SSE2 1
+#else
+#define TLG_SIMD_SSE2 0
+#endif
+
+#if TLG_SIMD_AVX2
+#include <immintrin.h>
+#elif TLG_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace the_learning_games {
+
+    /*! @brief Returns the squared Euclidean distance of the n floats at a & b.
+        @details Vectorized with AVX2 when the build targets it (e.g. /arch:AVX2 or -mavx2), else with SSE2 on x86,
+        else scalar. The lanes accumulate separately, so results may differ from the scalar sum in the last bits.
+    */
+    inline float squared_distance(float const* a, float const* b, std::size_t n) {
+        std::size_t i = 0;
+        float rc = 0;
+#if TLG_SIMD_AVX2
+        auto sum = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            auto const d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(d, d));
+        }
+        auto half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        rc = _mm_cvtss_f32(half);
+#elif TLG_SIMD_SSE2
+        auto sum = _mm_setzero_ps();
+        for (; i + 4 <= n; i += 4) {
+            auto const d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+            sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+        }
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        rc = _mm_cvtss_f32(sum);
+#endif
+        for (auto const* end = a + n; a + i != end; ++i) {//! @internal on pointers, as an index loop draws a false g++ -Waggressive-loop-optimizations
+            auto const d = a[i] - b[i];
+            rc += d * d;
+        }
+        return rc;
+    }
+
+    /*! @brief Writes the squared distances of query to each of count rows of n floats, stored contiguously, to out.
+    */
+    inline void squared_distances(float const* query, float const* rows, std::size_t count, std::size_t n, float* out) {
+        for (std::size_t r = 0; r != count; ++r)
+            out[r] = squared_distance(query, rows + r * n, n);
+    }
+}
@@ -0,0 +1,412 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace the_learning_games {
+
+    /*! @brief Arithmetic modulo a prime below 2^31.
+    */
+    struct modulus_t {
+        std::uint32_t p;
+
+        std::uint32_t add(std::uint32_t a, std::uint32_t b) const { auto const s = a + b; return s >= p ? s - p : s; }
+        std::uint32_t sub(std::uint32_t a, std::uint32_t b) const { return a >= b ? a - b : a + p - b; }
+        std::uint32_t mul(std::uint32_t a, std::uint32_t b) const { return static_cast<std::uint32_t>(std::uint64_t{ a } *b % p); }
+        std::uint32_t reduce(std::uint64_t a) const { return static_cast<std::uint32_t>(a % p); }
+
+        std::uint32_t pow(std::uint32_t a, std::uint64_t e) const {
+            std::uint32_t rc = 1;
+            for (; e; e >>= 1, a = mul(a, a))
+                if (e & 1) rc = mul(rc, a);
+            return rc;
+        }
+
+        /*! @brief Returns the inverse of a, which must not be 0 modulo p.
+        */
+        std::uint32_t inverse(std::uint32_t a) const { return pow(a, p - 2); }
+    };
+
+    /*! @brief y[i] = (y[i] + a * x[i]) mod p for i < n, with every residue below p < 2^31.
+        @details Uses Shoup's precomputed quotient of a, so the loop is made of 32x32 bit multiplies, shifts &
+        compares only & compiles to SIMD, unlike a loop around `%`.
+    */
+    inline void axpy_mod(std::uint32_t* y, std::uint32_t const* x, std::size_t n, std::uint32_t a, std::uint32_t p) {
+        auto const a_shoup = static_cast<std::uint32_t>((std::uint64_t{ a } << 32) / p);
+        for (std::size_t i = 0; i != n; ++i) {
+            auto const q = static_cast<std::uint32_t>((std::uint64_t{ a_shoup } *x[i]) >> 32);
+            auto r = a * x[i] - q * p;//! @internal exact modulo 2^32, in [0, 2p)
+            r = r >= p ? r - p : r;
+            r += y[i];
+            y[i] = r >= p ? r - p : r;
+        }
+    }
+
+    /*! @brief Deterministic primality test for 32 bit integers.
+    */
+    inline bool is_prime(std::uint32_t n) {
+        if (n < 2) return false;
+        for (std::uint32_t d : { 2u, 3u, 5u, 7u, 11u, 13u }) if (n % d == 0) return n == d;
+
+        modulus_t const m{ n };
+        auto d = n - 1;
+        auto s = 0;
+        while (!(d & 1)) { d >>= 1; ++s; }
+        for (std::uint32_t a : { 2u, 7u, 61u }) {//! @internal sufficient for n < 4759123141
+            auto x = m.pow(a % n, d);
+            if (x == 0 || x == 1 || x == n - 1) continue;
+            auto composite = true;
+            for (auto i = 1; i < s && composite; ++i) {
+                x = m.mul(x, x);
+                composite = x != n - 1;
+            }
+            if (composite) return false;
+        }
+        return true;
+    }
+
+    /*! @brief Returns the count largest primes below 2^31, after skipping the first skip of them.
+    */
+    inline std::vector<std::uint32_t> modular_primes(std::size_t count, std::size_t skip = 0) {
+        std::vector<std::uint32_t> rc;
+        for (auto n = (std::uint32_t{ 1 } << 31) - 1; rc.size() < count; n -= 2) {
+            if (!is_prime(n)) continue;
+            if (skip) --skip;
+            else rc.push_back(n);
+        }
+        return rc;
+    }
+
+    /*! @brief An arbitrary precision unsigned integer, just enough for Chinese remaindering & rational reconstruction.
+    */
+    class big_uint_t {
+        std::vector<std::uint32_t> limbs;//! @internal little endian, no leading zero limbs
+
+        void trim() { while (!limbs.empty() && limbs.back() == 0) limbs.pop_back(); }
+
+    public:
+        big_uint_t() = default;
+        big_uint_t(std::uint64_t v) {
+            for (; v; v >>= 32) limbs.push_back(static_cast<std::uint32_t>(v));
+        }
+
+        bool is_zero() const { return limbs.empty(); }
+        std::size_t bits() const {
+            if (limbs.empty()) return 0;
+            auto top = limbs.back();
+            std::size_t rc = 32 * (limbs.size() - 1);
+            for (; top; top >>= 1) ++rc;
+            return rc;
+        }
+
+        friend int compare(big_uint_t const& a, big_uint_t const& b) {
+            if (a.limbs.size() != b.limbs.size()) return a.limbs.size() < b.limbs.size() ? -1 : 1;
+            for (auto i = a.limbs.size(); i--;)
+                if (a.limbs[i] != b.limbs[i]) return a.limbs[i] < b.limbs[i] ? -1 : 1;
+            return 0;
+        }
+        friend bool operator==(big_uint_t const& a, big_uint_t const& b) { return a.limbs == b.limbs; }
+        friend bool operator!=(big_uint_t const& a, big_uint_t const& b) { return a.limbs != b.limbs; }
+        friend bool operator<(big_uint_t const& a, big_uint_t const& b) { return compare(a, b) < 0; }
+        friend bool operator<=(big_uint_t const& a, big_uint_t const& b) { return compare(a, b) <= 0; }
+
+        friend big_uint_t operator+(big_uint_t const& a, big_uint_t const& b) {
+            auto const& longer = a.limbs.size() >= b.limbs.size() ? a : b;
+            auto const& shorter = a.limbs.size() >= b.limbs.size() ? b : a;
+            big_uint_t rc;
+            rc.limbs.resize(longer.limbs.size() + 1);
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i != longer.limbs.size(); ++i) {
+                carry += std::uint64_t{ longer.limbs[i] } +(i < shorter.limbs.size() ? shorter.limbs[i] : 0);
+                rc.limbs[i] = static_cast<std::uint32_t>(carry);
+                carry >>= 32;
+            }
+            rc.limbs.back() = static_cast<std::uint32_t>(carry);
+            rc.trim();
+            return rc;
+        }
+
+        /*! @brief Returns a - b. @throws std::logic_error If a < b.
+        */
+        friend big_uint_t operator-(big_uint_t const& a, big_uint_t const& b) {
+            if (a < b) throw std::logic_error("pre: negative difference");
+            big_uint_t rc;
+            rc.limbs.resize(a.limbs.size());
+            std::int64_t borrow = 0;
+            for (std::size_t i = 0; i != a.limbs.size(); ++i) {
+                auto d = std::int64_t{ a.limbs[i] } -(i < b.limbs.size() ? b.limbs[i] : 0) - borrow;
+                borrow = d < 0;
+                rc.limbs[i] = static_cast<std::uint32_t>(d + (borrow << 32));
+            }
+            rc.trim();
+            return rc;
+        }
+
+        friend big_uint_t operator*(big_uint_t const& a, big_uint_t const& b) {
+            if (a.is_zero() || b.is_zero()) return{};
+            big_uint_t rc;
+            rc.limbs.assign(a.limbs.size() + b.limbs.size(), 0);
+            for (std::size_t i = 0; i != a.limbs.size(); ++i) {
+                std::uint64_t carry = 0;
+                for (std::size_t j = 0; j != b.limbs.size(); ++j) {
+                    carry += std::uint64_t{ a.limbs[i] } *b.limbs[j] + rc.limbs[i + j];
+                    rc.limbs[i + j] = static_cast<std::uint32_t>(carry);
+                    carry >>= 32;
+                }
+                rc.limbs[i + b.limbs.size()] = static_cast<std::uint32_t>(carry);
+            }
+            rc.trim();
+            return rc;
+        }
+
+        /*! @brief Returns *this modulo m.
+        */
+        std::uint32_t mod(std::uint32_t m) const {
+            std::uint64_t r = 0;
+            for (auto i = limbs.size(); i--;) r = ((r << 32) | limbs[i]) % m;
+            return static_cast<std::uint32_t>(r);
+        }
+
+        /*! @brief Quotient & remainder of a / b, Knuth's algorithm D. @throws std::logic_error If b is zero.
+        */
+        friend void divide(big_uint_t const& a, big_uint_t const& b, big_uint_t& quotient, big_uint_t& remainder) {
+            if (b.is_zero()) throw std::logic_error("pre: division by zero");
+            if (a < b) {
+                remainder = a;
+                quotient = big_uint_t{};
+                return;
+            }
+            auto const n = b.limbs.size(), m = a.limbs.size() - n;
+            big_uint_t q;
+            q.limbs.assign(m + 1, 0);
+
+            if (n == 1) {
+                std::uint64_t r = 0;
+                for (auto i = a.limbs.size(); i--;) {
+                    r = (r << 32) | a.limbs[i];
+                    q.limbs[i] = static_cast<std::uint32_t>(r / b.limbs[0]);
+                    r %= b.limbs[0];
+                }
+                q.trim();
+                quotient = std::move(q);
+                remainder = big_uint_t{ r };
+                return;
+            }
+
+            auto shift = 0;//! @internal normalize so that the top limb of the divisor has its high bit set
+            for (auto top = b.limbs.back(); !(top & 0x80000000u); top <<= 1) ++shift;
+            auto shifted = [shift](std::vector<std::uint32_t> const& v, std::size_t size) {
+                std::vector<std::uint32_t> rc(size, 0);
+                for (std::size_t i = 0; i != v.size(); ++i) {
+                    rc[i] |= v[i] << shift;
+                    if (shift && i + 1 < size) rc[i + 1] = static_cast<std::uint32_t>(std::uint64_t{ v[i] } >> (32 - shift));
+                }
+                return rc;
+            };
+            auto const v = shifted(b.limbs, n);
+            auto u = shifted(a.limbs, a.limbs.size() + 1);
+
+            for (auto j = m + 1; j--;) {
+                auto const numerator = (std::uint64_t{ u[j + n] } << 32) | u[j + n - 1];
+                auto qhat = numerator / v[n - 1];
+                auto rhat = numerator % v[n - 1];
+                while (qhat >> 32 || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+                    --qhat;
+                    rhat += v[n - 1];
+                    if (rhat >> 32) break;
+                }
+
+                std::int64_t borrow = 0;
+                std::uint64_t carry = 0;
+                for (std::size_t i = 0; i != n; ++i) {
+                    auto const product = qhat * v[i] + carry;
+                    carry = product >> 32;
+                    auto const d = std::int64_t{ u[i + j] } -static_cast<std::int64_t>(product & 0xffffffffu) - borrow;
+                    u[i + j] = static_cast<std::uint32_t>(d);
+                    borrow = d < 0;
+                }
+                auto const top = std::int64_t{ u[j + n] } -static_cast<std::int64_t>(carry) - borrow;
+                u[j + n] = static_cast<std::uint32_t>(top);
+
+                if (top < 0) {//! @internal qhat was one too large, add the divisor back
+                    --qhat;
+                    std::uint64_t sum = 0;
+                    for (std::size_t i = 0; i != n; ++i) {
+                        sum += std::uint64_t{ u[i + j] } +v[i];
+                        u[i + j] = static_cast<std::uint32_t>(sum);
+                        sum >>= 32;
+                    }
+                    u[j + n] += static_cast<std::uint32_t>(sum);
+                }
+                q.limbs[j] = static_cast<std::uint32_t>(qhat);
+            }
+
+            big_uint_t r;
+            r.limbs.resize(n);
+            for (std::size_t i = 0; i != n; ++i)
+                r.limbs[i] = static_cast<std::uint32_t>((u[i] >> shift) | (shift ? std::uint64_t{ u[i + 1] } << (32 - shift) : 0));
+            r.trim();
+            q.trim();
+            quotient = std::move(q);
+            remainder = std::move(r);
+        }
+
+        /*! @brief Returns *this divided by 2^n, rounded down.
+        */
+        big_uint_t operator>>(std::size_t n) const {
+            big_uint_t rc;
+            auto const words = n / 32, shift = n % 32;
+            for (auto i = words; i < limbs.size(); ++i) {
+                auto v = std::uint64_t{ limbs[i] } >> shift;
+                if (shift && i + 1 < limbs.size()) v |= std::uint64_t{ limbs[i + 1] } << (32 - shift);
+                rc.limbs.push_back(static_cast<std::uint32_t>(v));
+            }
+            rc.trim();
+            return rc;
+        }
+
+        /*! @brief Returns the value rounded to the nearest double.
+        */
+        double to_double() const {
+            auto rc = 0.;
+            for (auto i = limbs.size(); i--;) rc = rc * 4294967296. + limbs[i];
+            return rc;
+        }
+
+        /*! @brief Returns the decimal representation.
+        */
+        std::string to_string() const {
+            if (is_zero()) return "0";
+            std::string rc;
+            auto v = limbs;
+            while (!v.empty()) {
+                std::uint64_t r = 0;
+                for (auto i = v.size(); i--;) {
+                    r = (r << 32) | v[i];
+                    v[i] = static_cast<std::uint32_t>(r / 1000000000u);
+                    r %= 1000000000u;
+                }
+                while (!v.empty() && v.back() == 0) v.pop_back();
+                for (auto digit = 0; digit != 9 && (r || !v.empty()); ++digit, r /= 10)
+                    rc.push_back(static_cast<char>('0' + r % 10));
+            }
+            return std::string(rc.rbegin(), rc.rend());
+        }
+    };
+
+    /*! @brief An exact rational number numerator / denominator in lowest terms.
+    */
+    struct big_rational_t {
+        bool negative = false;
+        big_uint_t numerator;
+        big_uint_t denominator = 1;
+
+        double to_double() const {
+            auto const nb = numerator.bits(), db = denominator.bits();
+            auto const drop = std::max<std::size_t>(std::max(nb, db), 960) - 960;//! @internal keep both inside the double range
+            auto const rc = (numerator >> drop).to_double() / (denominator >> drop).to_double();
+            return negative ? -rc : rc;
+        }
+
+        friend bool operator==(big_rational_t const& a, big_rational_t const& b) {
+            return a.negative == b.negative && a.numerator == b.numerator && a.denominator == b.denominator;
+        }
+        friend bool operator!=(big_rational_t const& a, big_rational_t const& b) { return !(a == b); }
+    };
+
+    /*! @brief Writes numerator/denominator.
+    */
+    inline std::ostream& operator<<(std::ostream& os, big_rational_t const& r) {
+        return os << (r.negative ? "-" : "") << r.numerator.to_string() << "/" << r.denominator.to_string();
+    }
+
+    /*! @brief Incremental Chinese remaindering of residues modulo distinct primes.
+    */
+    class crt_accumulator_t {
+        big_uint_t value_;
+        big_uint_t modulus_ = 1;
+
+    public:
+        /*! @brief Combines the value so far with value = residue modulo prime.
+        */
+        void add(std::uint32_t residue, std::uint32_t prime) {
+            modulus_t const m{ prime };
+            auto const correction = m.mul(m.sub(residue, value_.mod(prime)), m.inverse(modulus_.mod(prime)));
+            value_ = value_ + modulus_ * big_uint_t{ correction };
+            modulus_ = modulus_ * big_uint_t{ prime };
+        }
+
+        big_uint_t const& value() const { return value_; }//! @brief Returns the value in [0, modulus()).
+        big_uint_t const& modulus() const { return modulus_; }//! @brief Returns the product of the primes so far.
+    };
+
+    /*! @brief Finds the rational n / d with |n|, d below sqrt(modulus / 2) that is congruent to value modulo modulus.
+        @details The extended Euclidean algorithm on (modulus, value), stopped at the first remainder below the bound.
+        Such a rational is unique if it exists, so once enough primes make up the modulus the true value is returned.
+        @return Returns false if there is no such rational, i.e. more primes are needed.
+    */
+    inline bool rational_reconstruction(big_uint_t const& value, big_uint_t const& modulus, big_rational_t& rc) {
+        big_uint_t bound = 1;//! @internal the largest power of 2 not above sqrt(modulus / 2)
+        for (std::size_t i = 0; i < (modulus.bits() - 1) / 2; ++i) bound = bound + bound;
+
+        //! @internal remainders r0 > r1 & cofactors t0, t1 with alternating signs, t_i * value = r_i mod modulus
+        big_uint_t r0 = modulus, r1 = value, t0 = 0, t1 = 1, q, r;
+        auto t1_negative = false;
+        while (!(r1 < bound)) {
+            divide(r0, r1, q, r);
+            auto t = t0 + q * t1;
+            r0 = std::move(r1);
+            r1 = std::move(r);
+            t0 = std::move(t1);
+            t1 = std::move(t);
+            t1_negative = !t1_negative;
+        }
+        if (t1.is_zero() || !(t1 < bound)) return false;
+
+        big_uint_t g = r1, h = t1;//! @internal reject unless gcd(r1, t1) == 1
+        while (!h.is_zero()) {
+            divide(g, h, q, r);
+            g = std::move(h);
+            h = std::move(r);
+        }
+        if (g != big_uint_t{ 1 } && !r1.is_zero()) return false;
+
+        rc.negative = t1_negative && !r1.is_zero();
+        rc.numerator = r1;
+        rc.denominator = t1;
+        return true;
+    }
+}
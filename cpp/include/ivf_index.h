@@ -0,0 +1,190 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "distance.h"
+#include "memory_accounting.h"
+
+namespace the_learning_games {
+
+    /*! @brief An approximate nearest neighbour index of fixed length float vectors: an inverted file over k-means cells.
+        @details train() clusters a sample into lists() centroids; add() files each vector under its nearest centroid,
+        contiguously with the others of that list. A search ranks the centroids, scans the vectors of the probes
+        nearest lists with squared_distance() & keeps the k nearest, so it costs about probes / lists() of an exact
+        scan. Neighbours filed under a list that isn't probed are missed, which more probes trade against time.
+        With lists about the square root of the library & 8 to 16 probes, recall@10 is typically above 90% on
+        clustered data.
+        The vectors are held within a byte budget, typically a share of resource_plan_t::cache_budget_bytes.
+        Searches may run concurrently with each other, not with add() or train().
+        @tparam Dims The length of the vectors.
+    */
+    template<std::size_t Dims>
+    class ivf_index_t {
+    public:
+        using vector_t = std::array<float, Dims>;
+        using neighbour_t = std::pair<float, std::uint64_t>;//! Squared distance & id.
+
+    private:
+        struct list_t {
+            accounted_vector_t<float, memory_component_t::caches> vectors;//! @internal Dims floats per entry
+            accounted_vector_t<std::uint64_t, memory_component_t::caches> ids;
+        };
+
+        std::vector<float> centroids;//! @internal Dims floats per list
+        std::vector<list_t> lists_;
+        std::size_t size_ = 0;
+        std::uint64_t budget_bytes_;
+
+        static constexpr std::uint64_t entry_bytes = Dims * sizeof(float) + sizeof(std::uint64_t);//! @internal a vector & its id
+
+    public:
+        /*! @param budget_bytes The bytes() the index may grow to.
+        */
+        explicit ivf_index_t(std::uint64_t budget_bytes = std::numeric_limits<std::uint64_t>::max()) :
+            budget_bytes_(budget_bytes)
+        {}
+
+        /*! @brief Clusters sample into lists centroids with Lloyd's k-means, seeded from lists distinct samples.
+            Drops every vector added before.
+            @throws std::logic_error If lists is 0 or sample holds fewer vectors than lists.
+        */
+        void train(std::vector<vector_t> const& sample, std::size_t lists, std::uint64_t seed = 0, int iterations = 8) {
+            if (lists == 0 || sample.size() < lists) throw std::logic_error("pre: fewer samples than lists");
+            std::vector<std::size_t> order(sample.size());
+            std::iota(order.begin(), order.end(), std::size_t{});
+            std::mt19937_64 random(seed);
+            for (std::size_t i = 0; i != lists; ++i)
+                std::swap(order[i], order[i + random() % (order.size() - i)]);
+
+            centroids.resize(lists * Dims);
+            for (std::size_t l = 0; l != lists; ++l)
+                std::copy(sample[order[l]].begin(), sample[order[l]].end(), centroids.begin() + l * Dims);
+
+            std::vector<double> sums(lists * Dims);
+            std::vector<std::size_t> counts(lists);
+            for (auto i = 0; i < iterations; ++i) {
+                std::fill(sums.begin(), sums.end(), 0.);
+                std::fill(counts.begin(), counts.end(), 0);
+                for (auto const& v : sample) {
+                    auto const l = nearest_list(v.data());
+                    ++counts[l];
+                    for (std::size_t d = 0; d != Dims; ++d) sums[l * Dims + d] += v[d];
+                }
+                for (std::size_t l = 0; l != lists; ++l) {
+                    if (!counts[l]) continue;//! @internal an empty cell keeps its centroid
+                    for (std::size_t d = 0; d != Dims; ++d)
+                        centroids[l * Dims + d] = static_cast<float>(sums[l * Dims + d] / static_cast<double>(counts[l]));
+                }
+            }
+            lists_.assign(lists, list_t{});
+            size_ = 0;
+        }
+
+        /*! @brief Files vector under id. An id added twice is found twice.
+            @throws std::logic_error If the index is not trained.
+            @throws std::runtime_error If the vector would take the index over its budget. The index is unchanged.
+        */
+        void add(std::uint64_t id, vector_t const& vector) {
+            if (lists_.empty()) throw std::logic_error("pre: index not trained");
+            if (bytes() + entry_bytes > budget_bytes_) throw std::runtime_error("ivf index: over its cache budget");
+            auto& list = lists_[nearest_list(vector.data())];
+            list.vectors.insert(list.vectors.end(), vector.begin(), vector.end());
+            list.ids.push_back(id);
+            ++size_;
+        }
+
+        /*! @brief Returns the k nearest vectors among the probes nearest lists, nearest first.
+        */
+        std::vector<neighbour_t> search(vector_t const& query, std::size_t k, std::size_t probes = 8) const {
+            if (k == 0) return{};
+            probes = std::min(probes, lists_.size());
+            std::vector<neighbour_t> ranked(lists_.size());
+            std::vector<float> distances(lists_.size());
+            squared_distances(query.data(), centroids.data(), lists_.size(), Dims, distances.data());
+            for (std::size_t l = 0; l != lists_.size(); ++l) ranked[l] = { distances[l], l };
+            std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(probes), ranked.end());
+
+            std::vector<neighbour_t> rc;//! @internal a max heap of the k nearest so far
+            rc.reserve(k + 1);
+            for (std::size_t p = 0; p != probes; ++p) {
+                auto const& list = lists_[static_cast<std::size_t>(ranked[p].second)];
+                distances.resize(list.ids.size());
+                squared_distances(query.data(), list.vectors.data(), list.ids.size(), Dims, distances.data());
+                for (std::size_t i = 0; i != list.ids.size(); ++i) {
+                    if (rc.size() == k && !(distances[i] < rc.front().first)) continue;
+                    rc.emplace_back(distances[i], list.ids[i]);
+                    std::push_heap(rc.begin(), rc.end());
+                    if (rc.size() > k) {
+                        std::pop_heap(rc.begin(), rc.end());
+                        rc.pop_back();
+                    }
+                }
+            }
+            std::sort_heap(rc.begin(), rc.end());
+            return rc;
+        }
+
+        /*! @brief Returns the k nearest vectors by an exact scan of every list, e.g. to measure the recall of search().
+        */
+        std::vector<neighbour_t> search_exact(vector_t const& query, std::size_t k) const {
+            return search(query, k, lists_.size());
+        }
+
+        std::size_t size() const { return size_; }//! @brief Returns the number of vectors added.
+        std::uint64_t bytes() const { return size_ * entry_bytes; }//! @brief Returns the bytes held by the vectors & their ids.
+        std::uint64_t budget_bytes() const { return budget_bytes_; }
+        std::size_t lists() const { return lists_.size(); }//! @brief Returns the number of k-means cells, 0 until trained.
+
+    private:
+        std::size_t nearest_list(float const* v) const {
+            auto best = std::numeric_limits<float>::infinity();
+            std::size_t rc = 0;
+            for (std::size_t l = 0; l * Dims != centroids.size(); ++l) {
+                auto const d = squared_distance(v, centroids.data() + l * Dims, Dims);
+                if (d < best) {
+                    best = d;
+                    rc = l;
+                }
+            }
+            return rc;
+        }
+    };
+}
@@ -0,0 +1,207 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TLG_JIT_X86_64 1
+#else
+#define TLG_JIT_X86_64 0
+#endif
+
+#if TLG_JIT_X86_64 && defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif TLG_JIT_X86_64 && (defined(__linux__) || defined(__APPLE__))
+#include <sys/mman.h>
+#endif
+
+namespace the_learning_games {
+
+    /*! @brief Machine code being assembled, with forward referencing labels.
+        @details Holds raw bytes; the instructions themselves are encoded by the caller. Labels are patched as rel32
+        displacements once the code is complete.
+    */
+    class code_buffer_t {
+        std::vector<std::uint8_t> bytes_;
+        std::vector<std::ptrdiff_t> labels;//! @internal offset of each bound label, -1 while unbound
+        std::vector<std::pair<std::size_t, std::size_t>> fixups;//! @internal (offset of a rel32, label)
+
+    public:
+        //! Identifies a label of this buffer.
+        using label_t = std::size_t;
+
+        /*! @brief Appends bytes.
+        */
+        code_buffer_t& emit(std::initializer_list<std::uint8_t> bytes) {
+            bytes_.insert(bytes_.end(), bytes);
+            return *this;
+        }
+
+        code_buffer_t& emit32(std::uint32_t value) {//! @brief Appends a little endian 32 bit immediate.
+            for (auto i = 0; i != 4; ++i, value >>= 8) bytes_.push_back(static_cast<std::uint8_t>(value));
+            return *this;
+        }
+
+        code_buffer_t& emit64(std::uint64_t value) {//! @brief Appends a little endian 64 bit immediate.
+            for (auto i = 0; i != 8; ++i, value >>= 8) bytes_.push_back(static_cast<std::uint8_t>(value));
+            return *this;
+        }
+
+        label_t label() {//! @brief Returns a new unbound label.
+            labels.push_back(-1);
+            return labels.size() - 1;
+        }
+
+        void bind(label_t l) {//! @brief Binds l to the current offset.
+            labels.at(l) = static_cast<std::ptrdiff_t>(bytes_.size());
+        }
+
+        /*! @brief Appends the rel32 displacement to l, which completes a jmp, jcc or call opcode.
+        */
+        code_buffer_t& rel32(label_t l) {
+            fixups.emplace_back(bytes_.size(), l);
+            return emit32(0);
+        }
+
+        /*! @brief Patches every rel32 & returns the code.
+            @throws std::logic_error If a referenced label was never bound.
+        */
+        std::vector<std::uint8_t> finish() {
+            for (auto const& f : fixups) {
+                if (labels.at(f.second) < 0) throw std::logic_error("pre: label not bound");
+                auto const displacement = static_cast<std::int32_t>(labels[f.second] - static_cast<std::ptrdiff_t>(f.first + 4));
+                for (auto i = 0; i != 4; ++i)
+                    bytes_[f.first + i] = static_cast<std::uint8_t>(static_cast<std::uint32_t>(displacement) >> (8 * i));
+            }
+            fixups.clear();
+            return bytes_;
+        }
+
+        std::size_t size() const { return bytes_.size(); }//! @brief Returns the number of bytes emitted.
+    };
+
+    /*! @brief Read only executable pages holding a copy of some machine code.
+        @details The pages are mapped writable, filled & then remapped read & execute, so they are never writable &
+        executable at once.
+    */
+    class executable_code_t {
+        void* code = nullptr;
+        std::size_t length = 0;
+
+    public:
+        /*! @brief Returns true if machine code can be generated & run on this platform at all.
+            Mapping may still fail at runtime, e.g. under a policy that forbids executable anonymous memory.
+        */
+        static constexpr bool supported() {
+#if TLG_JIT_X86_64 && (defined(_WIN32) || defined(__linux__) || defined(__APPLE__))
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        executable_code_t() = default;
+
+        /*! @throws std::runtime_error If executable memory is unavailable.
+        */
+        explicit executable_code_t(std::vector<std::uint8_t> const& bytes) :
+            length(std::max<std::size_t>(bytes.size(), 1))
+        {
+#if TLG_JIT_X86_64 && defined(_WIN32)
+            code = VirtualAlloc(nullptr, length, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+            if (!code) throw std::runtime_error("jit: cannot allocate code pages");
+            std::memcpy(code, bytes.data(), bytes.size());
+            DWORD previous;
+            if (!VirtualProtect(code, length, PAGE_EXECUTE_READ, &previous)) {
+                VirtualFree(code, 0, MEM_RELEASE);
+                throw std::runtime_error("jit: cannot make code pages executable");
+            }
+            FlushInstructionCache(GetCurrentProcess(), code, length);
+#elif TLG_JIT_X86_64 && (defined(__linux__) || defined(__APPLE__))
+            code = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (code == MAP_FAILED) {
+                code = nullptr;
+                throw std::runtime_error("jit: cannot allocate code pages");
+            }
+            std::memcpy(code, bytes.data(), bytes.size());
+            if (mprotect(code, length, PROT_READ | PROT_EXEC) != 0) {
+                munmap(code, length);
+                code = nullptr;
+                throw std::runtime_error("jit: cannot make code pages executable");
+            }
+#else
+            (void)bytes;
+            throw std::runtime_error("jit: unsupported platform");
+#endif
+        }
+
+        executable_code_t(executable_code_t&& other) noexcept :
+            code(std::exchange(other.code, nullptr)),
+            length(std::exchange(other.length, 0))
+        {}
+
+        executable_code_t& operator=(executable_code_t&& other) noexcept {
+            std::swap(code, other.code);
+            std::swap(length, other.length);
+            return *this;
+        }
+
+        ~executable_code_t() {
+#if TLG_JIT_X86_64 && defined(_WIN32)
+            if (code) VirtualFree(code, 0, MEM_RELEASE);
+#elif TLG_JIT_X86_64 && (defined(__linux__) || defined(__APPLE__))
+            if (code) munmap(code, length);
+#endif
+        }
+
+        explicit operator bool() const { return code != nullptr; }//! @brief Returns true if holding code.
+
+        /*! @brief Returns the start of the code as a pointer to a function of type F.
+        */
+        template<typename F>
+        F* entry() const {
+            return reinterpret_cast<F*>(code);
+        }
+    };
+}
@@ -0,0 +1,243 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory_resource>
+#include <new>
+#include <ostream>
+#include <vector>
+
+namespace the_learning_games {
+
+    /*! @brief The components whose memory is accounted separately.
+    */
+    enum class memory_component_t : std::uint8_t {
+        dice,//! Roll buffers, e.g. the two halves of a fixed_buffer_dice_t.
+        boards,//! The tables of a board_t.
+        tables,//! Solver tables, e.g. transition & win probability tables.
+        caches,//! Memoized results kept across runs.
+        sessions,//! Session stores & the games they hold.
+        simulation//! Merge trees & game state of simulation runs.
+    };
+
+    //! The number of memory_component_t values.
+    constexpr std::size_t const memory_component_count = 6;
+
+    /*! @brief Returns the name of component, e.g. "dice".
+    */
+    inline char const* to_string(memory_component_t component) {
+        static char const* const names[memory_component_count] = { "dice", "boards", "tables", "caches", "sessions", "simulation" };
+        return names[static_cast<std::size_t>(component)];
+    }
+
+    /*! @brief A snapshot of the counters of one component.
+    */
+    struct memory_usage_t {
+        memory_component_t component;
+        std::int64_t current = 0;//! Bytes currently allocated.
+        std::int64_t peak = 0;//! Highest value of current since the start or the last reset_memory_peaks().
+        std::uint64_t allocations = 0;//! Number of allocations since the start.
+    };
+
+    namespace detail {
+        /*! @internal @brief The counters of one component, each on its own cache line so that components never contend.
+        */
+        struct alignas(64) memory_account_t {
+            std::atomic<std::int64_t> current{ 0 };
+            std::atomic<std::int64_t> peak{ 0 };
+            std::atomic<std::uint64_t> allocations{ 0 };
+        };
+
+        inline memory_account_t& memory_account(memory_component_t component) {
+            static memory_account_t accounts[memory_component_count];
+            return accounts[static_cast<std::size_t>(component)];
+        }
+    }
+
+    /*! @brief Records the allocation of bytes by component.
+    */
+    inline void account_allocation(memory_component_t component, std::size_t bytes) {
+        auto& account = detail::memory_account(component);
+        auto const current = account.current.fetch_add(static_cast<std::int64_t>(bytes), std::memory_order_relaxed) + static_cast<std::int64_t>(bytes);
+        auto peak = account.peak.load(std::memory_order_relaxed);
+        while (peak < current && !account.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+        account.allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*! @brief Records the release of bytes by component.
+    */
+    inline void account_deallocation(memory_component_t component, std::size_t bytes) {
+        detail::memory_account(component).current.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    /*! @brief Returns the counters of component. Safe to call at any time from any thread.
+    */
+    inline memory_usage_t memory_usage(memory_component_t component) {
+        auto const& account = detail::memory_account(component);
+        return{ component, account.current.load(std::memory_order_relaxed), account.peak.load(std::memory_order_relaxed), account.allocations.load(std::memory_order_relaxed) };
+    }
+
+    /*! @brief Returns the counters of every component, in memory_component_t order.
+    */
+    inline std::vector<memory_usage_t> memory_usage() {
+        std::vector<memory_usage_t> rc;
+        for (std::size_t i = 0; i != memory_component_count; ++i)
+            rc.push_back(memory_usage(static_cast<memory_component_t>(i)));
+        return rc;
+    }
+
+    /*! @brief Lowers the peak of every component to its current value, e.g. before each repetition of a benchmark.
+    */
+    inline void reset_memory_peaks() {
+        for (std::size_t i = 0; i != memory_component_count; ++i) {
+            auto& account = detail::memory_account(static_cast<memory_component_t>(i));
+            account.peak.store(account.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+    /*! @brief A stateless std allocator charging every allocation to Component.
+        @details The tag is part of the type, so containers keep their size & an accounted container costs two relaxed
+        atomic additions per allocation over std::allocator.
+    */
+    template<typename T, memory_component_t Component>
+    class accounted_allocator_t {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind { using other = accounted_allocator_t<U, Component>; };
+
+        accounted_allocator_t() = default;
+
+        template<typename U>
+        accounted_allocator_t(accounted_allocator_t<U, Component> const&) {}
+
+        T* allocate(std::size_t n) {
+            auto p = std::allocator<T>().allocate(n);
+            account_allocation(Component, n * sizeof(T));
+            return p;
+        }
+
+        void deallocate(T* p, std::size_t n) {
+            account_deallocation(Component, n * sizeof(T));
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template<typename U>
+        bool operator== (accounted_allocator_t<U, Component> const&) const { return true; }
+
+        template<typename U>
+        bool operator!= (accounted_allocator_t<U, Component> const&) const { return false; }
+    };
+
+    //! A std::vector whose storage is charged to Component.
+    template<typename T, memory_component_t Component>
+    using accounted_vector_t = std::vector<T, accounted_allocator_t<T, Component>>;
+
+    /*! @brief A memory resource charging every allocation of its upstream to a component.
+        @details For the std::pmr containers of board_t, game_t & friends. @see accounted_memory()
+    */
+    class accounted_resource_t : public std::pmr::memory_resource {
+        memory_component_t const component;
+        std::pmr::memory_resource* const upstream;
+
+    public:
+        explicit accounted_resource_t(memory_component_t component, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) :
+            component(component),
+            upstream(upstream)
+        {}
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            auto p = upstream->allocate(bytes, alignment);
+            account_allocation(component, bytes);
+            return p;
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            account_deallocation(component, bytes);
+            upstream->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    /*! @brief Returns the process wide resource charging the global heap to component.
+    */
+    inline std::pmr::memory_resource* accounted_memory(memory_component_t component) {
+        static accounted_resource_t resources[memory_component_count] = {
+            accounted_resource_t(memory_component_t::dice), accounted_resource_t(memory_component_t::boards),
+            accounted_resource_t(memory_component_t::tables), accounted_resource_t(memory_component_t::caches),
+            accounted_resource_t(memory_component_t::sessions), accounted_resource_t(memory_component_t::simulation),
+        };
+        return &resources[static_cast<std::size_t>(component)];
+    }
+
+    /*! @brief Charges bytes to a component for its own lifetime.
+        @details For storage that is not allocated through an allocator, such as `new T[]` arrays. Declare it before the
+        storage it charges, so that the charge is dropped even if allocating the storage throws.
+    */
+    class memory_charge_t {
+        memory_component_t const component;
+        std::size_t const bytes;
+
+    public:
+        memory_charge_t(memory_component_t component, std::size_t bytes) :
+            component(component),
+            bytes(bytes)
+        {
+            account_allocation(component, bytes);
+        }
+
+        memory_charge_t(memory_charge_t const&) = delete;
+        memory_charge_t& operator=(memory_charge_t const&) = delete;
+
+        ~memory_charge_t() {
+            account_deallocation(component, bytes);
+        }
+    };
+
+    /*! @brief Prints one row per component: current & peak bytes & allocation count.
+    */
+    inline std::ostream& operator<< (std::ostream& os, std::vector<memory_usage_t> const& usage) {
+        os << std::left << std::setw(12) << "memory" << std::right << std::setw(16) << "current" << std::setw(16) << "peak" << std::setw(14) << "allocations" << "\n";
+        for (auto const& u : usage)
+            os << std::left << std::setw(12) << to_string(u.component) << std::right << std::setw(16) << u.current
+                << std::setw(16) << u.peak << std::setw(14) << u.allocations << "\n";
+        return os;
+    }
+}
@@ -0,0 +1,290 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace the_learning_games {
+
+    /*! @brief The cpu & memory actually available to this process.
+        @details Under a container runtime `std::thread::hardware_concurrency()` reports the cpus of the host, not the
+        cgroup quota, and physical memory is not the memory limit. These are the effective values.
+    */
+    struct resource_limits_t {
+        static constexpr auto const unlimited = std::numeric_limits<std::uint64_t>::max();
+
+        unsigned hardware_threads = 1;//! Threads reported by the hardware.
+        unsigned cpus = 1;//! Whole cpus usable without throttling, min(affinity, cgroup quota).
+        std::uint64_t memory_bytes = unlimited;//! The cgroup memory limit, or physical memory if there is none.
+        std::string cpu_source = "hardware";//! Where cpus was read from.
+        std::string memory_source = "none";//! Where memory_bytes was read from.
+    };
+
+    namespace detail {
+        /*! @internal @brief Reads the first whitespace separated tokens of a file. Empty if the file does not exist.
+        */
+        inline std::vector<std::string> read_tokens(std::string const& path) {
+            std::ifstream file(path);
+            std::vector<std::string> rc;
+            for (std::string token; file >> token && rc.size() < 4;)
+                rc.push_back(token);
+            return rc;
+        }
+
+        /*! @internal @brief Returns the cgroup path of controller from /proc/self/cgroup. "" denotes the v2 unified hierarchy.
+        */
+        inline bool cgroup_path(std::string const& controller, std::string& path) {
+            std::ifstream file("/proc/self/cgroup");
+            for (std::string line; std::getline(file, line);) {//! @internal hierarchy-id:controller-list:path
+                auto const first = line.find(':');
+                auto const second = line.find(':', first + 1);
+                if (first == std::string::npos || second == std::string::npos) continue;
+
+                std::istringstream controllers(line.substr(first + 1, second - first - 1));
+                for (std::string c; std::getline(controllers, c, ',');) {
+                    if (c == controller) {
+                        path = line.substr(second + 1);
+                        return true;
+                    }
+                }
+                if (controller.empty() && second == first + 1) {
+                    path = line.substr(second + 1);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /*! @internal @brief Candidate directories for a cgroup, from the own cgroup up to the mount root.
+            The effective limit is the smallest one along that chain. Inside a container the own path is usually not
+            visible below the mount & the root of the mount is the container's cgroup.
+        */
+        inline std::vector<std::string> cgroup_directories(std::string const& mount, std::string path) {
+            std::vector<std::string> rc;
+            while (!path.empty() && path != "/") {
+                rc.push_back(mount + path);
+                path = path.substr(0, path.find_last_of('/'));
+            }
+            rc.push_back(mount);
+            return rc;
+        }
+
+        inline std::uint64_t to_bytes(std::string const& token) {
+            if (token.empty() || token == "max") return resource_limits_t::unlimited;
+            auto const value = std::stoull(token);
+            return value >= (std::uint64_t{ 1 } << 62) ? resource_limits_t::unlimited : value;//! @internal v1 reports "unlimited" as PAGE_COUNTER_MAX pages
+        }
+
+        inline unsigned affinity_cpus() {
+#ifdef __linux__
+            cpu_set_t set;
+            if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                return static_cast<unsigned>(std::max(CPU_COUNT(&set), 1));
+#endif
+            return std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        inline std::uint64_t physical_memory() {
+#ifdef __linux__
+            auto const pages = sysconf(_SC_PHYS_PAGES);
+            auto const page_size = sysconf(_SC_PAGE_SIZE);
+            if (pages > 0 && page_size > 0)
+                return static_cast<std::uint64_t>(pages) * static_cast<std::uint64_t>(page_size);
+#endif
+            return resource_limits_t::unlimited;
+        }
+    }
+
+    /*! @brief Discovers the effective cpu & memory limits from cgroup v2, then cgroup v1, then the hardware.
+        @details
+            1. v2: `cpu.max` ("quota period" or "max period") & `memory.max` of the unified hierarchy.
+            2. v1: `cpu.cfs_quota_us` / `cpu.cfs_period_us` & `memory.limit_in_bytes`.
+            3. The cpu count never exceeds the scheduler affinity mask. A fractional quota is rounded down, min 1,
+               since running ceil(quota) busy threads guarantees throttling.
+        On platforms without cgroups only the hardware values are reported.
+    */
+    inline resource_limits_t discover_resources(std::string const& cgroup_root = "/sys/fs/cgroup") {
+        resource_limits_t rc;
+        rc.hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        rc.cpus = detail::affinity_cpus();
+        rc.cpu_source = "affinity";
+
+        auto quota_cpus = std::numeric_limits<double>::infinity();
+        auto apply_quota = [&](double quota, double period, std::string const& source) {
+            if (quota > 0 && period > 0 && quota / period < quota_cpus) {
+                quota_cpus = quota / period;
+                rc.cpu_source = source;
+            }
+        };
+        auto apply_memory = [&](std::uint64_t bytes, std::string const& source) {
+            if (bytes < rc.memory_bytes) {
+                rc.memory_bytes = bytes;
+                rc.memory_source = source;
+            }
+        };
+
+        std::string path;
+        if (detail::cgroup_path("", path)) {//! @internal cgroup v2
+            for (auto const& dir : detail::cgroup_directories(cgroup_root, path)) {
+                auto const cpu = detail::read_tokens(dir + "/cpu.max");
+                if (cpu.size() == 2 && cpu[0] != "max")
+                    apply_quota(std::stod(cpu[0]), std::stod(cpu[1]), dir + "/cpu.max");
+                auto const memory = detail::read_tokens(dir + "/memory.max");
+                if (!memory.empty())
+                    apply_memory(detail::to_bytes(memory[0]), dir + "/memory.max");
+            }
+        }
+        if (detail::cgroup_path("cpu", path)) {//! @internal cgroup v1, mounted as cpu or cpu,cpuacct
+            for (auto const mount : { "/cpu", "/cpu,cpuacct" }) {
+                for (auto const& dir : detail::cgroup_directories(cgroup_root + mount, path)) {
+                    auto const quota = detail::read_tokens(dir + "/cpu.cfs_quota_us");
+                    auto const period = detail::read_tokens(dir + "/cpu.cfs_period_us");
+                    if (!quota.empty() && !period.empty())
+                        apply_quota(std::stod(quota[0]), std::stod(period[0]), dir + "/cpu.cfs_quota_us");
+                }
+            }
+        }
+        if (detail::cgroup_path("memory", path)) {
+            for (auto const& dir : detail::cgroup_directories(cgroup_root + "/memory", path)) {
+                auto const memory = detail::read_tokens(dir + "/memory.limit_in_bytes");
+                if (!memory.empty())
+                    apply_memory(detail::to_bytes(memory[0]), dir + "/memory.limit_in_bytes");
+            }
+        }
+
+        if (quota_cpus < rc.cpus)
+            rc.cpus = std::max(static_cast<unsigned>(quota_cpus), 1u);
+        if (rc.memory_bytes == resource_limits_t::unlimited) {
+            rc.memory_bytes = detail::physical_memory();
+            rc.memory_source = "physical";
+        }
+        return rc;
+    }
+
+    /*! @brief Returns the model name of the cpu, e.g. to key measurements which only hold on the same hardware.
+        @details Read from /proc/cpuinfo on Linux & from the cpuid brand string with MSVC, "unknown" elsewhere.
+    */
+    inline std::string cpu_model() {
+        std::string rc;
+#if defined(__linux__)
+        std::ifstream file("/proc/cpuinfo");
+        for (std::string line; std::getline(file, line);) {
+            if (line.compare(0, 10, "model name") != 0) continue;
+            auto const colon = line.find(':');
+            if (colon != std::string::npos) rc = line.substr(colon + 1);
+            break;
+        }
+#elif defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 0x80000000);
+        if (static_cast<unsigned>(registers[0]) >= 0x80000004u) {
+            char brand[49] = {};
+            for (auto i = 0; i != 3; ++i) {
+                __cpuid(registers, 0x80000002 + i);
+                std::memcpy(brand + 16 * i, registers, sizeof(registers));
+            }
+            rc = brand;
+        }
+#endif
+        auto const first = rc.find_first_not_of(" \t");
+        if (first == std::string::npos) return "unknown";
+        return rc.substr(first, rc.find_last_not_of(" \t") - first + 1);
+    }
+
+    /*! @brief Sizes of the per process resources derived from resource_limits_t.
+    */
+    struct resource_plan_t {
+        resource_limits_t limits;
+        unsigned worker_threads = 1;//! Size of the worker pool.
+        std::size_t dice_buffer_length = std::size_t{ 128 } * 1024 * 1024;//! Rolls per fixed_buffer_dice_t, both halves together.
+        std::uint64_t cache_budget_bytes = 0;//! Bytes which caches may hold in total, split between e.g. the budgets of ivf_index_t.
+    };
+
+    /*! @brief Splits the discovered limits between the worker pool, the dice buffers & the caches.
+        @param limits The discovered limits, @see discover_resources()
+        @param roll_size sizeof the roll_t stored in the dice buffers.
+        @param dice_fraction Fraction of the memory limit that all dice buffers may use together.
+        @param cache_fraction Fraction of the memory limit that all caches may use together.
+        @details One buffered dice is assumed per worker. Its length is the largest power of two that fits the
+        per worker share, clamped to [64K, 128M] rolls. The remainder of the limit is left for boards, games & the heap.
+    */
+    inline resource_plan_t plan_resources(resource_limits_t const& limits, std::size_t roll_size = 1, double dice_fraction = 0.5, double cache_fraction = 0.125) {
+        resource_plan_t rc;
+        rc.limits = limits;
+        rc.worker_threads = std::max(limits.cpus, 1u);
+
+        auto const memory = static_cast<double>(std::min<std::uint64_t>(limits.memory_bytes, std::uint64_t{ 1 } << 52));
+        auto const per_worker = memory * dice_fraction / rc.worker_threads / static_cast<double>(std::max<std::size_t>(roll_size, 1));
+
+        std::size_t const min_length = std::size_t{ 64 } * 1024, max_length = std::size_t{ 128 } * 1024 * 1024;
+        auto length = max_length;
+        while (length > min_length && static_cast<double>(length) > per_worker)
+            length /= 2;
+        rc.dice_buffer_length = length;
+        rc.cache_budget_bytes = static_cast<std::uint64_t>(memory * cache_fraction);
+        return rc;
+    }
+
+    /*! @brief Convenience wrapper of plan_resources(discover_resources())
+    */
+    inline resource_plan_t plan_resources(std::size_t roll_size = 1) {
+        return plan_resources(discover_resources(), roll_size);
+    }
+
+    /*! @brief Logs the discovered limits & the chosen sizes, one per line.
+    */
+    inline std::ostream& operator<< (std::ostream& os, resource_plan_t const& plan) {
+        auto mib = [](std::uint64_t bytes) { return bytes / (1024 * 1024); };
+        os << "Hardware threads = " << plan.limits.hardware_threads << "\n";
+        os << "Usable cpus      = " << plan.limits.cpus << " (" << plan.limits.cpu_source << ")\n";
+        os << "Memory limit     = " << mib(plan.limits.memory_bytes) << " MiB (" << plan.limits.memory_source << ")\n";
+        os << "Worker threads   = " << plan.worker_threads << "\n";
+        os << "Dice buffer      = " << plan.dice_buffer_length << " rolls\n";
+        os << "Cache budget     = " << mib(plan.cache_budget_bytes) << " MiB\n";
+        return os;
+    }
+}
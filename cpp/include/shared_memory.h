@@ -0,0 +1,114 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace the_learning_games {
+
+    /*! @brief A block of memory shared by the processes which map the same name.
+        @details On POSIX the name is a file path, e.g. under /dev/shm, so that the block survives the process which
+        created it until it is removed. On Windows it names a pagefile backed file mapping, which lives as long as any
+        process maps it. A fresh block is zero filled.
+    */
+    class shared_memory_t {
+        void* data_ = nullptr;
+        std::size_t size_ = 0;
+#if defined(_WIN32)
+        HANDLE mapping = nullptr;
+#endif
+
+    public:
+        /*! @param name The file path, or the mapping name on Windows.
+            @param size The bytes of the block. Every process must pass the same size.
+            @throws std::runtime_error If the block can't be created or mapped.
+        */
+        shared_memory_t(std::string const& name, std::size_t size) : size_(size) {
+#if defined(_WIN32)
+            mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32), static_cast<DWORD>(size), name.c_str());
+            if (!mapping) throw std::runtime_error("shared memory: cannot create " + name);
+            data_ = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+            if (!data_) {
+                CloseHandle(mapping);
+                throw std::runtime_error("shared memory: cannot map " + name);
+            }
+#else
+            auto const fd = ::open(name.c_str(), O_RDWR | O_CREAT, 0600);
+            if (fd < 0) throw std::runtime_error("shared memory: cannot open " + name);
+            struct fd_guard_t { int fd; ~fd_guard_t() { ::close(fd); } } const guard{ fd };
+            if (::ftruncate(fd, static_cast<off_t>(size)) != 0) throw std::runtime_error("shared memory: cannot size " + name);
+            auto const p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) throw std::runtime_error("shared memory: cannot map " + name);
+            data_ = p;
+#endif
+        }
+
+        shared_memory_t(shared_memory_t const&) = delete;
+        shared_memory_t& operator=(shared_memory_t const&) = delete;
+
+        ~shared_memory_t() {
+#if defined(_WIN32)
+            UnmapViewOfFile(data_);
+            CloseHandle(mapping);
+#else
+            ::munmap(data_, size_);
+#endif
+        }
+
+        /*! @brief Removes the name, so that the next shared_memory_t of it starts zero filled. A no-op on Windows.
+        */
+        static void remove(std::string const& name) {
+#if !defined(_WIN32)
+            ::unlink(name.c_str());
+#endif
+        }
+
+        void* data() const { return data_; }//! @brief Returns the start of the block, page aligned.
+        std::size_t size() const { return size_; }//! @brief Returns the bytes of the block.
+    };
+}
@@ -0,0 +1,164 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+namespace the_learning_games {
+
+    /*! @brief A bounded multi producer, single consumer queue laid out in a caller's block of memory, e.g. a
+        shared_memory_t, so that the producers & the consumer may live in different processes.
+        @details Each slot carries a sequence number, so producers only contend on the atomic reservation of the next
+        slot & the consumer never writes where a producer reads (Vyukov's bounded queue). The block holds only
+        lock free, address free atomics & plain words; no pointer is stored in it. A full queue fails push() rather
+        than waiting on the consumer.
+        Record must be trivially copyable.
+    */
+    template<typename Record>
+    class shared_ring_t {
+        static_assert(std::is_trivially_copyable<Record>::value, "Record must be trivially copyable");
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared_ring_t requires lock free 64 bit atomics");
+        static constexpr std::size_t const words = (sizeof(Record) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+        static constexpr std::uint64_t const magic = 0x474e495244524853ull;//! @internal "SHRDRING"
+
+        struct slot_t {
+            std::atomic<std::uint64_t> sequence;//! @internal index while free, index + 1 once written
+            std::atomic<std::uint64_t> payload[words];
+        };
+
+        struct alignas(64) header_t {
+            std::atomic<std::uint64_t> magic;
+            std::uint64_t capacity;
+            std::atomic<std::uint64_t> flags;//! @internal user flags, @see set_flags()
+            alignas(64) std::atomic<std::uint64_t> head;//! @internal next slot producers reserve
+            alignas(64) std::atomic<std::uint64_t> tail;//! @internal next slot the consumer reads
+        };
+
+        header_t* header;
+        slot_t* slots;
+        std::uint64_t mask;
+
+    public:
+        /*! @brief Returns the bytes of a ring of capacity records, capacity a power of two.
+        */
+        static constexpr std::size_t bytes(std::size_t capacity) {
+            return sizeof(header_t) + capacity * sizeof(slot_t);
+        }
+
+        /*! @brief Attaches to the ring in memory, initializing it if memory is zero filled.
+            @param memory At least bytes(capacity) bytes, aligned to 64 bytes. Must outlive *this.
+            @param capacity The records the ring holds, a power of two. Every process must pass the same capacity.
+            @throws std::logic_error If capacity is not a power of two.
+            @throws std::runtime_error If memory holds a ring of another capacity.
+        */
+        shared_ring_t(void* memory, std::size_t capacity) :
+            header(static_cast<header_t*>(memory)),
+            slots(reinterpret_cast<slot_t*>(static_cast<char*>(memory) + sizeof(header_t))),
+            mask(capacity - 1)
+        {
+            if (capacity == 0 || (capacity & (capacity - 1))) throw std::logic_error("pre: capacity not a power of two");
+            if (header->magic.load(std::memory_order_acquire) == magic) {
+                if (header->capacity != capacity) throw std::runtime_error("shared ring: capacity mismatch");
+                return;
+            }
+            //! @internal zero filled memory: the first process to attach formats it. Attaching processes must not race here.
+            for (std::size_t i = 0; i != capacity; ++i) {
+                new(&slots[i].sequence) std::atomic<std::uint64_t>(i);
+                for (auto& word : slots[i].payload) new(&word) std::atomic<std::uint64_t>(0);
+            }
+            header->capacity = capacity;
+            new(&header->flags) std::atomic<std::uint64_t>(0);
+            new(&header->head) std::atomic<std::uint64_t>(0);
+            new(&header->tail) std::atomic<std::uint64_t>(0);
+            new(&header->magic) std::atomic<std::uint64_t>(magic);
+        }
+
+        /*! @brief Appends record. Safe to call from any number of producers.
+            @return Returns false, & appends nothing, if the ring is full.
+        */
+        bool push(Record const& record) {
+            auto position = header->head.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& slot = slots[position & mask];
+                auto const sequence = slot.sequence.load(std::memory_order_acquire);
+                auto const difference = static_cast<std::int64_t>(sequence - position);
+                if (difference == 0) {
+                    if (header->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        std::uint64_t buffer[words] = {};
+                        std::memcpy(buffer, &record, sizeof(Record));
+                        for (std::size_t i = 0; i != words; ++i)
+                            slot.payload[i].store(buffer[i], std::memory_order_relaxed);
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false;
+                else
+                    position = header->head.load(std::memory_order_relaxed);
+            }
+        }
+
+        /*! @brief Moves the oldest record into record. Must only be called by the single consumer.
+            @return Returns false if no record is complete yet.
+        */
+        bool pop(Record& record) {
+            auto const position = header->tail.load(std::memory_order_relaxed);
+            auto& slot = slots[position & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1) return false;
+
+            std::uint64_t buffer[words];
+            for (std::size_t i = 0; i != words; ++i)
+                buffer[i] = slot.payload[i].load(std::memory_order_relaxed);
+            std::memcpy(&record, buffer, sizeof(Record));
+            slot.sequence.store(position + mask + 1, std::memory_order_release);
+            header->tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /*! @brief Returns the records reserved by producers & not yet popped.
+        */
+        std::uint64_t backlog() const {
+            auto const tail = header->tail.load(std::memory_order_acquire);
+            return header->head.load(std::memory_order_acquire) - tail;
+        }
+
+        std::size_t capacity() const { return static_cast<std::size_t>(mask + 1); }//! @brief Returns the records the ring holds.
+
+        void set_flags(std::uint64_t flags) { header->flags.fetch_or(flags, std::memory_order_acq_rel); }//! @brief Sets flags shared by every process, e.g. to signal a state change.
+        std::uint64_t flags() const { return header->flags.load(std::memory_order_acquire); }//! @brief Returns the flags set so far.
+    };
+}
@@ -0,0 +1,428 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+    @version 0.0.1
+    @date 2016
+    @copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace the_learning_games {
+
+    /*! @brief Order independent accumulator of the first two moments of an integer sample.
+        @details All state is integral so merge() is exactly associative & commutative. The floating point
+        mean() & variance() are computed once from the integral state and are therefore bit identical
+        regardless of how the sample was partitioned across threads.
+    */
+    class integer_moments_t {
+    public:
+        //! Value type of a single observation.
+        using value_t = std::int64_t;
+
+    private:
+        std::uint64_t count_ = 0;
+        std::int64_t sum_ = 0;
+        std::uint64_t sum_of_squares_ = 0;//! @internal wraps modulo 2^64 only beyond ~4 billion observations of 2^16
+        value_t min_ = std::numeric_limits<value_t>::max();
+        value_t max_ = std::numeric_limits<value_t>::min();
+
+    public:
+        /*! @brief Adds an observation.
+        */
+        void add(value_t x) {
+            ++count_;
+            sum_ += x;
+            sum_of_squares_ += static_cast<std::uint64_t>(x * x);
+            min_ = std::min(min_, x);
+            max_ = std::max(max_, x);
+        }
+
+        /*! @brief Merges the observations of other into *this.
+            @return Returns a reference to *this.
+        */
+        integer_moments_t& merge(integer_moments_t const& other) {
+            count_ += other.count_;
+            sum_ += other.sum_;
+            sum_of_squares_ += other.sum_of_squares_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+            return *this;
+        }
+
+        std::uint64_t count() const { return count_; }//! @brief Returns the number of observations.
+        std::int64_t sum() const { return sum_; }//! @brief Returns the exact sum of the observations.
+        std::uint64_t sum_of_squares() const { return sum_of_squares_; }//! @brief Returns the exact sum of the squared observations.
+        value_t min() const { return min_; }//! @brief Returns the smallest observation.
+        value_t max() const { return max_; }//! @brief Returns the largest observation.
+
+        /*! @brief Returns the sample mean.
+        */
+        double mean() const {
+            return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.;
+        }
+
+        /*! @brief Returns the unbiased sample variance.
+            @details Computed as (n * sum(x^2) - sum(x)^2) / (n * (n - 1)). The numerator is evaluated in long double
+            from the exact integral state, so no catastrophic cancellation occurs for game length sized values.
+        */
+        double variance() const {
+            if (count_ < 2) return 0.;
+            auto const n = static_cast<long double>(count_);
+            auto const s = static_cast<long double>(sum_);
+            auto const numerator = n * static_cast<long double>(sum_of_squares_) - s * s;
+            return static_cast<double>(numerator / (n * (n - 1)));
+        }
+
+        friend bool operator== (integer_moments_t const& lhs, integer_moments_t const& rhs) {
+            return lhs.count_ == rhs.count_ && lhs.sum_ == rhs.sum_ && lhs.sum_of_squares_ == rhs.sum_of_squares_ &&
+                lhs.min_ == rhs.min_ && lhs.max_ == rhs.max_;
+        }
+    };
+
+    /*! @brief A fixed shape merge tree keyed by chunk id.
+        @details The work is cut into a fixed number of chunks independent of the number of threads. Each chunk is
+        reduced into its own Accumulator & submitted with its chunk id. Sibling nodes are merged as soon as both
+        are present by whichever thread submits last, so merging proceeds in parallel up the tree and is never
+        serialized behind a single thread. Because the tree shape & the left / right operand order depend only on
+        the chunk count, the result is bit identical for any number of threads & any completion order, even for
+        Accumulators whose merge() is not exactly associative.
+        Accumulator must be default constructible (the identity) & provide `merge(Accumulator const&)`.
+    */
+    template<typename Accumulator>
+    class reduction_tree_t {
+        struct node_t {
+            std::size_t parent;
+            std::atomic<int> arrivals{ 0 };
+            Accumulator value{};
+        };
+
+        static constexpr auto const npos = ~std::size_t{};
+
+        std::pmr::vector<node_t> nodes;
+        std::pmr::vector<std::size_t> leaves;//! @internal leaves[chunk_id] is the node index of that chunk
+        std::pmr::vector<std::size_t> right_child;//! @internal right_child[parent] is the node index of its right child
+        std::atomic<std::size_t> remaining;
+
+    public:
+        /*! @param chunks The number of chunks which will be submitted.
+            @param memory Allocates the tree itself, e.g. a job_arena_t. The Accumulators allocate their own state.
+        */
+        explicit reduction_tree_t(std::size_t chunks, std::pmr::memory_resource* memory = std::pmr::get_default_resource()) :
+            nodes(chunks ? 2 * chunks - 1 : 1, memory),
+            leaves(chunks, memory),
+            right_child(chunks ? 2 * chunks - 1 : 1, npos, memory),
+            remaining(chunks)
+        {
+            if (!chunks) throw std::logic_error("pre: chunk count is zero");
+            auto next_node = std::size_t{};
+            build(0, chunks, npos, next_node);
+        }
+
+        /*! @brief Stores the result of chunk_id & merges every ancestor whose children are complete.
+            Safe to call concurrently from any number of threads, each chunk_id exactly once.
+            @return Returns true if this submission completed the whole tree.
+        */
+        bool submit(std::size_t chunk_id, Accumulator value) {
+            auto index = leaves.at(chunk_id);
+            nodes[index].value = std::move(value);
+
+            for (;;) {
+                auto const parent = nodes[index].parent;
+                if (parent == npos) {
+                    remaining.fetch_sub(1, std::memory_order_acq_rel);
+                    return true;
+                }
+                if (nodes[parent].arrivals.fetch_add(1, std::memory_order_acq_rel) == 0) {//! @internal the sibling is not ready, it will carry on
+                    remaining.fetch_sub(1, std::memory_order_acq_rel);
+                    return false;
+                }
+                auto const left = parent + 1;//! @internal pre-order layout, the left child follows its parent
+                auto const right = right_child[parent];
+                nodes[parent].value = nodes[left].value;
+                nodes[parent].value.merge(nodes[right].value);
+                index = parent;
+            }
+        }
+
+        /*! @brief Returns true once every chunk has been submitted.
+        */
+        bool complete() const {
+            return remaining.load(std::memory_order_acquire) == 0;
+        }
+
+        /*! @brief Returns the reduction of all chunks. Only valid once complete().
+        */
+        Accumulator const& result() const {
+            if (!complete()) throw std::logic_error("pre: not all chunks submitted");
+            return nodes[0].value;
+        }
+
+    private:
+        /*! @internal @brief Lays out the subtree over chunks [first, last) in pre-order.
+        */
+        void build(std::size_t first, std::size_t last, std::size_t parent, std::size_t& next_node) {
+            auto const self = next_node++;
+            nodes[self].parent = parent;
+
+            if (last - first == 1) {
+                leaves[first] = self;
+                return;
+            }
+            auto const middle = first + (last - first) / 2;
+            build(first, middle, self, next_node);
+            right_child[self] = next_node;
+            build(middle, last, self, next_node);
+        }
+    };
+
+    /*! @brief A log linear histogram of non negative integer samples such as latencies in nanoseconds.
+        @details Values below 2^sub_bucket_bits are counted exactly, larger values in 2^sub_bucket_bits linear
+        sub buckets per power of two, i.e. with a relative error below 2^-sub_bucket_bits (~3%). Memory is fixed
+        & merge() is an exact elementwise addition, @see https://hdrhistogram.github.io/HdrHistogram/
+    */
+    class log_histogram_t {
+        static constexpr int const sub_bucket_bits = 5;
+        static constexpr std::uint64_t const sub_buckets = std::uint64_t{ 1 } << sub_bucket_bits;
+        static constexpr std::size_t const bucket_count = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+        std::vector<std::uint64_t> counts_ = std::vector<std::uint64_t>(bucket_count);
+        std::uint64_t count_ = 0;
+        std::uint64_t max_ = 0;
+
+    public:
+        /*! @brief Adds a sample.
+        */
+        void add(std::uint64_t value) {
+            ++counts_[index_of(value)];
+            ++count_;
+            max_ = std::max(max_, value);
+        }
+
+        /*! @brief Merges the samples of other into *this.
+            @return Returns a reference to *this.
+        */
+        log_histogram_t& merge(log_histogram_t const& other) {
+            for (std::size_t i = 0; i != bucket_count; ++i)
+                counts_[i] += other.counts_[i];
+            count_ += other.count_;
+            max_ = std::max(max_, other.max_);
+            return *this;
+        }
+
+        std::uint64_t count() const { return count_; }//! @brief Returns the number of samples.
+        std::uint64_t max() const { return max_; }//! @brief Returns the largest sample.
+
+        /*! @brief Returns an upper bound of the q-quantile, exact to within one sub bucket.
+            @param q The quantile in [0, 1].
+        */
+        std::uint64_t quantile(double q) const {
+            if (!count_) return 0;
+            auto const rank = static_cast<std::uint64_t>(std::ceil(std::min(std::max(q, 0.), 1.) * static_cast<double>(count_)));
+            auto seen = std::uint64_t{};
+            for (std::size_t i = 0; i != bucket_count; ++i) {
+                seen += counts_[i];
+                if (seen >= std::max<std::uint64_t>(rank, 1))
+                    return std::min(upper_bound_of(i), max_);
+            }
+            return max_;
+        }
+
+    private:
+        static std::size_t index_of(std::uint64_t value) {
+            if (value < sub_buckets) return static_cast<std::size_t>(value);
+            auto msb = 0;
+            for (auto v = value; v >>= 1;) ++msb;
+            auto const shift = msb - sub_bucket_bits;
+            return static_cast<std::size_t>((shift + 1) * sub_buckets + ((value >> shift) - sub_buckets));
+        }
+
+        static std::uint64_t upper_bound_of(std::size_t index) {
+            auto const major = index / sub_buckets, minor = index % sub_buckets;
+            if (major == 0) return minor;
+            auto const shift = major - 1;
+            return ((sub_buckets + minor) << shift) + ((std::uint64_t{ 1 } << shift) - 1);
+        }
+    };
+
+    /*! @brief Returns z such that a standard normal lies within [-z, z] with probability confidence.
+    */
+    inline double normal_two_sided_quantile(double confidence) {
+        if (!(confidence > 0 && confidence < 1)) throw std::logic_error("pre: confidence outside (0, 1)");
+        auto lo = 0., hi = 40.;
+        for (auto i = 0; i != 100; ++i) {
+            auto const z = (lo + hi) / 2;
+            (std::erfc(z / std::sqrt(2.)) > 1 - confidence ? lo : hi) = z;
+        }
+        return (lo + hi) / 2;
+    }
+
+    /*! @brief A mean estimated with & without control variates.
+    */
+    struct control_variate_estimate_t {
+        double plain_mean = 0;//! The sample mean.
+        double plain_half_width = 0;//! Half width of the confidence interval of plain_mean.
+        double mean = 0;//! The sample mean adjusted by the controls.
+        double half_width = 0;//! Half width of the confidence interval of mean.
+        std::vector<double> coefficients;//! The fitted coefficient of every control.
+        double variance_ratio = 1;//! Variance of mean over that of plain_mean, 1 - R^2 of the fit.
+    };
+
+    /*! @brief Order independent accumulator of integer responses & controls for control variate estimates.
+        @details Every game contributes responses y_r, such as a win indicator, & controls x_j whose expectations
+        mu_j are known exactly. estimate() fits y_r ~ beta . x by least squares & reports
+        `mean(y_r) - beta . (mean(x) - mu)`, whose variance is the residual variance of the fit: the plain variance
+        times 1 - R^2. As in integer_moments_t all sums are integral, so merge() is exact & estimates are bit
+        identical for any partition of the sample. A default constructed accumulator is the identity of merge().
+    */
+    class control_variate_moments_t {
+        std::size_t responses_ = 0, controls_ = 0;
+        std::uint64_t count_ = 0;
+        std::vector<std::int64_t> sums;//! @internal responses, then controls
+        std::vector<std::int64_t> squares;//! @internal sum of y_r^2
+        std::vector<std::int64_t> products;//! @internal products[(i * controls_) + j] = sum of v_i x_j, v responses then controls
+
+    public:
+        control_variate_moments_t() = default;
+
+        control_variate_moments_t(std::size_t responses, std::size_t controls) :
+            responses_(responses),
+            controls_(controls),
+            sums(responses + controls),
+            squares(responses),
+            products((responses + controls) * controls)
+        {}
+
+        /*! @brief Adds a game's responses y[0 .. responses) & controls x[0 .. controls).
+        */
+        void add(std::int64_t const* y, std::int64_t const* x) {
+            ++count_;
+            for (std::size_t r = 0; r != responses_; ++r) {
+                sums[r] += y[r];
+                squares[r] += y[r] * y[r];
+                for (std::size_t j = 0; j != controls_; ++j) products[r * controls_ + j] += y[r] * x[j];
+            }
+            for (std::size_t i = 0; i != controls_; ++i) {
+                sums[responses_ + i] += x[i];
+                for (std::size_t j = 0; j != controls_; ++j) products[(responses_ + i) * controls_ + j] += x[i] * x[j];
+            }
+        }
+
+        /*! @brief Merges the games of other into *this.
+            @return Returns a reference to *this.
+        */
+        control_variate_moments_t& merge(control_variate_moments_t const& other) {
+            if (!other.count_) return *this;
+            if (!count_) return *this = other;
+            if (responses_ != other.responses_ || controls_ != other.controls_) throw std::logic_error("pre: different responses or controls");
+            count_ += other.count_;
+            for (std::size_t i = 0; i != sums.size(); ++i) sums[i] += other.sums[i];
+            for (std::size_t i = 0; i != squares.size(); ++i) squares[i] += other.squares[i];
+            for (std::size_t i = 0; i != products.size(); ++i) products[i] += other.products[i];
+            return *this;
+        }
+
+        std::uint64_t count() const { return count_; }//! @brief Returns the number of games.
+
+        /*! @brief Returns the plain & the control variate estimate of the mean of response.
+            @param control_means The exact expectation of every control.
+            @param confidence The level of both confidence intervals, normal approximation.
+            @details Controls that are constant or collinear with earlier ones get a coefficient of 0.
+        */
+        control_variate_estimate_t estimate(std::size_t response, std::vector<double> const& control_means, double confidence = 0.95) const {
+            if (response >= responses_) throw std::logic_error("pre: no such response");
+            if (control_means.size() != controls_) throw std::logic_error("pre: a mean per control");
+
+            control_variate_estimate_t rc;
+            rc.coefficients.assign(controls_, 0.);
+            if (count_ < controls_ + 2) return rc;
+
+            auto const n = static_cast<long double>(count_);
+            auto const z = normal_two_sided_quantile(confidence);
+            auto covariance = [&](long double sum_ab, std::int64_t sum_a, std::int64_t sum_b) {
+                return (sum_ab - static_cast<long double>(sum_a) * static_cast<long double>(sum_b) / n) / (n - 1);
+            };
+
+            auto const k = controls_;
+            std::vector<long double> a(k * (k + 1));//! @internal [C_xx | C_xy] row major
+            for (std::size_t i = 0; i != k; ++i) {
+                for (std::size_t j = 0; j != k; ++j)
+                    a[i * (k + 1) + j] = covariance(static_cast<long double>(products[(responses_ + i) * k + j]), sums[responses_ + i], sums[responses_ + j]);
+                a[i * (k + 1) + k] = covariance(static_cast<long double>(products[response * k + i]), sums[response], sums[responses_ + i]);
+            }
+            auto const c_xy = a;
+            auto const c_yy = covariance(static_cast<long double>(squares[response]), sums[response], sums[response]);
+
+            //! @internal Gauss-Jordan with partial pivoting, skipping columns without a usable pivot
+            std::vector<bool> used(k);
+            std::vector<std::size_t> pivot_row(k, k);
+            for (std::size_t c = 0; c != k; ++c) {
+                auto best = k;
+                for (std::size_t r = 0; r != k; ++r)
+                    if (!used[r] && (best == k || std::fabs(a[r * (k + 1) + c]) > std::fabs(a[best * (k + 1) + c]))) best = r;
+                if (best == k || std::fabs(a[best * (k + 1) + c]) <= 1e-12L * std::max(std::fabs(c_xy[c * (k + 1) + c]), 1.L)) continue;
+                used[best] = true;
+                pivot_row[c] = best;
+                auto const p = a[best * (k + 1) + c];
+                for (std::size_t j = 0; j <= k; ++j) a[best * (k + 1) + j] /= p;
+                for (std::size_t r = 0; r != k; ++r) {
+                    if (r == best || a[r * (k + 1) + c] == 0) continue;
+                    auto const f = a[r * (k + 1) + c];
+                    for (std::size_t j = 0; j <= k; ++j) a[r * (k + 1) + j] -= f * a[best * (k + 1) + j];
+                }
+            }
+
+            auto adjusted = static_cast<long double>(sums[response]) / n;
+            auto explained = 0.L;
+            for (std::size_t c = 0; c != k; ++c) {
+                if (pivot_row[c] == k) continue;
+                auto const beta = a[pivot_row[c] * (k + 1) + k];
+                rc.coefficients[c] = static_cast<double>(beta);
+                adjusted -= beta * (static_cast<long double>(sums[responses_ + c]) / n - control_means[c]);
+                explained += beta * c_xy[c * (k + 1) + k];
+            }
+
+            auto const fitted = std::count_if(pivot_row.begin(), pivot_row.end(), [k](std::size_t r) { return r != k; });
+            auto const residual = std::max(c_yy - explained, 0.L) * (n - 1) / (n - 1 - fitted);
+
+            rc.plain_mean = static_cast<double>(static_cast<long double>(sums[response]) / n);
+            rc.plain_half_width = static_cast<double>(z * std::sqrt(c_yy / n));
+            rc.mean = static_cast<double>(adjusted);
+            rc.half_width = static_cast<double>(z * std::sqrt(residual / n));
+            rc.variance_ratio = c_yy > 0 ? static_cast<double>(residual / c_yy) : 1.;
+            return rc;
+        }
+    };
+}
@@ -27,18 +27,682 @@ SOFTWARE.
 @copyright MIT License
 */
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 #define SNL_TEST 1
 
+#include "include\arena.h"
+#include "include\benchmark.h"
+#include "include\deck.h"
 #include "include\dice.h"
+#include "include\memory_accounting.h"
+#include "include\resources.h"
 #include "include\types.h"
+#include "include\autotune.h"
+#include "include\batch.h"
+#include "include\board_generator.h"
+#include "include\board_parser.h"
+#include "include\chain.h"
+#include "include\control_variates.h"
+#include "include\dataset.h"
+#include "include\exact_chain.h"
+#include "include\jit_kernel.h"
+#include "include\load_generator.h"
+#include "include\metrics_index.h"
+#include "include\rules.h"
+#include "include\scaling.h"
+#include "include\scheduler.h"
+#include "include\session.h"
+#include "include\similarity.h"
+#include "include\simulation.h"
+#include "include\wire.h"
 
 namespace snl = snakes_and_ladders;
 namespace tlg = the_learning_games;
 
-int main() {
+using buffered_dice_t = tlg::upto3_dice_t<
+    tlg::fixed_buffer_dice_t<
+    tlg::dice_t<std::int8_t> > >;
+
+/*! @brief Measures dice rolls per second as the time to fill the first half of the buffer.
+*/
+double measure_drps(tlg::resource_plan_t const& plan, bool verbose) {
+    buffered_dice_t dice(6, plan.dice_buffer_length);
+    auto const buffer_length = plan.dice_buffer_length / 2;// rolls filled by the first swap
+
+    auto start_time = std::chrono::high_resolution_clock().now();
+    dice.roll();
+    auto end_time = std::chrono::high_resolution_clock().now();
+
+    auto time_taken = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+    auto drps = 1000. * static_cast<double>(buffer_length) / std::max<long long>(time_taken, 1);
+
+    if (verbose) {
+        std::cout << "Time taken = " << time_taken << " ms\n";
+        std::cout << "Dice rolls = " << buffer_length << "\n";
+        std::cout << "DRPS       = " << drps << "\n";
+    }
+    return drps;
+}
+
+/*! @brief Measures games per second of a single 3 player game_t reset & replayed game_count times.
+*/
+double measure_gps(snl::board_t const& board, buffered_dice_t& dice, int game_count, bool verbose) {
+    auto counter = game_count;
+    snl::game_t game(board, 3);
+
+    //player_strategy_t strategy;
+
+    auto start_time = std::chrono::high_resolution_clock().now();
+    while (counter--) {
+        game.reset();
+        while (game) {
+            auto roll = dice.roll();
+            game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock().now();
+
+    auto time_taken = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+    auto gps = 1000. * static_cast<double>(game_count) / std::max<long long>(time_taken, 1);
+
+    if (verbose) {
+        std::cout << "Time taken = " << time_taken << " ms\n";
+        std::cout << "Games      = " << game_count << "\n";
+        std::cout << "GPS        = " << gps << std::endl << std::endl;
+    }
+    return gps;
+}
+
+/*! @brief Measures moves per second of a 3 player game_kernel_t replaying a cache resident buffer of rolls, the game loop alone.
+*/
+double measure_kernel_mps(snl::game_kernel_t const& kernel, bool verbose) {
+    std::size_t const moves = 4096;
+    auto const repetitions = 1 << 12;
+    tlg::upto3_dice_t<tlg::dice_t<std::int8_t>> dice(6, 2016);
+    std::vector<std::int8_t> rolls(4 * moves);
+    for (std::size_t i = 0; i != moves; ++i) {
+        auto const roll = dice.roll();
+        rolls[4 * i] = std::get<0>(roll);
+        rolls[4 * i + 1] = std::get<1>(roll);
+        rolls[4 * i + 2] = std::get<2>(roll);
+    }
+
+    std::vector<snl::cell_iterator_t> positions(kernel.players());
+    std::vector<std::int64_t> turns(moves);
+    std::vector<std::uint64_t> wins(kernel.players());
+    snl::kernel_context_t context{ nullptr, 0, positions.data(), 0, 0, ~std::uint64_t{}, nullptr, wins.data() };
+
+    auto start_time = std::chrono::high_resolution_clock().now();
+    for (auto i = 0; i != repetitions; ++i) {
+        context.rolls = rolls.data();
+        context.rolls_left = moves;
+        context.finished_turns = turns.data();
+        kernel(context);
+    }
+    auto end_time = std::chrono::high_resolution_clock().now();
+
+    auto const seconds = std::max(std::chrono::duration<double>(end_time - start_time).count(), 1e-9);
+    auto const mps = static_cast<double>(moves) * repetitions / seconds;
+    if (verbose)
+        std::cout << (kernel.compiled() ? (kernel.compare_chain() ? "JIT chain " : "JIT table ") : "Table     ") << " = " << mps << " moves/s\n";
+    return mps;
+}
+
+/*! @brief Runs every benchmark repetitions times.
+    @details The peak bytes of every memory component during a repetition are reported as "peak.<component>",
+    so that memory regressions are caught like throughput regressions. Components which never allocate are left out.
+*/
+std::vector<tlg::benchmark_result_t> run_benchmarks(snl::board_t const& board, tlg::resource_plan_t const& plan, int repetitions) {
+    std::vector<tlg::benchmark_result_t> rc = {
+        { "drps", "rolls/s", true, {} },
+        { "gps", "games/s", true, {} },
+        { "kernel_mps", "moves/s", true, {} },
+    };
+    snl::game_kernel_t const kernel(board, 3);
+    std::vector<tlg::benchmark_result_t> peaks;
+    for (std::size_t c = 0; c != tlg::memory_component_count; ++c)
+        peaks.push_back({ std::string("peak.") + tlg::to_string(static_cast<tlg::memory_component_t>(c)), "bytes", false, {} });
+
+    buffered_dice_t dice(6, plan.dice_buffer_length);
+    for (auto i = 0; i < repetitions; ++i) {
+        tlg::reset_memory_peaks();
+        rc[0].samples.push_back(measure_drps(plan, false));
+        rc[1].samples.push_back(measure_gps(board, dice, 1 << 18, false));
+        rc[2].samples.push_back(measure_kernel_mps(kernel, false));
+        auto const usage = tlg::memory_usage();
+        for (std::size_t c = 0; c != usage.size(); ++c)
+            peaks[c].samples.push_back(static_cast<double>(usage[c].peak));
+    }
+
+    for (auto& p : peaks)
+        if (std::any_of(p.samples.begin(), p.samples.end(), [](double v) { return v != 0; }))
+            rc.push_back(std::move(p));
+    return rc;
+}
+
+/*! @brief Prints the outcome of a self check & returns 1 if it failed.
+*/
+int check(bool passed, char const* what) {
+    std::cout << (passed ? "pass  " : "FAIL  ") << what << "\n";
+    return passed ? 0 : 1;
+}
+
+/*! @brief Feeds cut short, oversized & garbage request frames to a wire_server_t, which must answer every one of them.
+*/
+int check_wire_frames() {
+    snl::wire_server_t server;
+    server.max_frame_games = 1 << 12;
+    snl::simulation_config_t config;
+    config.games = 256;
+    auto const board = snl::board_builder_t(10).add_jump(8, 30).add_jump(16, 6);
+    auto const frame = snl::wire_writer_t(snl::wire_kind_t::request, 7).add_query(board, config).finish();
+    auto answered_with = [&server](std::vector<std::uint8_t> const& request, snl::wire_kind_t kind) {
+        auto const response = server.serve(request);
+        return snl::wire_response_view_t(response.data(), response.size()).kind() == kind;
+    };
+    auto failures = check(answered_with(frame, snl::wire_kind_t::response), "wire: a valid frame is answered");
+
+    auto cut_short = true;
+    for (auto size = sizeof(snl::wire_frame_header_t); size != frame.size(); ++size) {
+        std::vector<std::uint8_t> cut(frame.begin(), frame.begin() + static_cast<std::ptrdiff_t>(size));
+        auto const length = static_cast<std::uint32_t>(size - 4);
+        std::memcpy(cut.data(), &length, 4);
+        cut_short = cut_short && answered_with(cut, snl::wire_kind_t::error);
+    }
+    failures += check(cut_short, "wire: a frame whose record is cut short is refused");
+
+    snl::wire_writer_t greedy(snl::wire_kind_t::request, 8);
+    for (auto i = 0; i != 17; ++i) greedy.add_query(board, config);
+    failures += check(answered_with(greedy.finish(), snl::wire_kind_t::error), "wire: a frame over the game budget is refused");
+
+    auto tiny_chunks = config;
+    tiny_chunks.games = server.max_frame_games;
+    tiny_chunks.games_per_chunk = 1;
+    auto strict = server;
+    strict.max_chunks = 64;
+    auto const chunky = strict.serve(snl::wire_writer_t(snl::wire_kind_t::request, 9).add_query(board, tiny_chunks).finish());
+    auto refused = false;
+    for (auto const result : snl::wire_response_view_t(chunky.data(), chunky.size())) refused = result.status() == snl::wire_status_t::invalid_query;
+    failures += check(refused, "wire: a query split into too many chunks is refused");
+
+    std::mt19937_64 engine(2016);
+    auto garbage = true;
+    for (auto i = 0; i != 2000; ++i) {
+        auto noise = frame;
+        noise.resize(sizeof(snl::wire_frame_header_t) + engine() % 64);
+        auto const length = static_cast<std::uint32_t>(noise.size() - 4);
+        std::memcpy(noise.data(), &length, 4);
+        for (auto j = i % 2 ? offsetof(snl::wire_frame_header_t, count) : sizeof(snl::wire_frame_header_t); j < noise.size(); ++j)
+            noise[j] = static_cast<std::uint8_t>(engine());
+        auto const response = server.serve(noise);
+        garbage = garbage && response.size() >= sizeof(snl::wire_frame_header_t);
+    }
+    return failures + check(garbage, "wire: garbage records are answered");
+}
+
+/*! @brief Counts the bytes allocated through it & not yet freed, to check where memory comes from.
+*/
+class counting_resource_t : public std::pmr::memory_resource {
+public:
+    std::size_t bytes = 0;//! Held at the moment.
+
+private:
+    void* do_allocate(std::size_t size, std::size_t alignment) override {
+        bytes += size;
+        return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void* p, std::size_t size, std::size_t alignment) override {
+        bytes -= size;
+        std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+};
+
+/*! @brief Checks that copies of games & boards into a container allocate their state from the container's resource.
+*/
+int check_allocators() {
+    snl::board_t const board(snl::board_builder_t(10).add_jump(8, 30).add_jump(16, 6).finalize());
+    counting_resource_t games_memory;
+    snl::game_t const game(board, 5);
+    std::pmr::vector<snl::game_t> games(&games_memory);
+    games.reserve(1);
+    auto const buffer = games_memory.bytes;
+    games.push_back(game);
+    auto failures = check(games_memory.bytes - buffer >= 5 * sizeof(snl::cell_iterator_t), "allocators: a copied game's players come from the container");
+
+    counting_resource_t boards_memory;
+    snl::board_t moved(snl::board_t(board), &boards_memory);
+    failures += check(boards_memory.bytes >= static_cast<std::size_t>(board.end()) && moved.end() == board.end(), "allocators: a moved board's cells come from the allocator");
+    return failures;
+}
+
+/*! @brief Checks that add_rules() parses a rule set & refuses a malformed rule, then how moves end on its special cells.
+*/
+int check_rule_landing() {
+    snl::board_builder_t builder(10);
+    snl::add_rules(builder, "97 extra_turn\n98 skip_turn # landing cells\n55 teleport 60 80; 70 bounce_back 5\n");
+    auto const& rules = builder.rules();
+    auto failures = check(rules.size() == 4 && rules[0].first == 97 && rules[0].second.action == snl::cell_action_t::extra_turn && rules[1].first == 98 && rules[1].second.action == snl::cell_action_t::skip_turn
+        && rules[2].first == 55 && rules[2].second.action == snl::cell_action_t::teleport && rules[2].second.first == 60 && rules[2].second.last == 80
+        && rules[3].first == 70 && rules[3].second.action == snl::cell_action_t::bounce_back && rules[3].second.first == 5, "rules: add_rules() parses a rule set");
+    auto refused = false;
+    try {
+        snl::board_builder_t malformed(10);
+        snl::add_rules(malformed, "12 extra_turn\n40 teleport 60\n");
+    }
+    catch (std::runtime_error const&) {
+        refused = true;
+    }
+    failures += check(refused, "rules: add_rules() refuses a malformed rule");
+
+    snl::board_t const board(builder.finalize());
+    snl::game_t game(board, 3);
+
+    game.restore_player(0, 97, false);
+    game.move(5, 0, 0);//overshoots the end from the extra turn cell
+    failures += check(game.player_position(0) == 97 && game.current_player() == 1, "rules: a move nullified on an extra turn cell passes the turn");
+
+    game.restore(1, snl::game_state_t::running, 0);
+    game.restore_player(1, 98, false);
+    game.move(4, 0, 0);//overshoots the end from the skip turn cell
+    failures += check(!game.skips_next_turn(1) && game.current_player() == 2, "rules: a move nullified on a skip turn cell doesn't skip");
+
+    game.restore(2, snl::game_state_t::running, 0);
+    game.restore_player(2, 95, false);
+    game.move(2, 0, 0);
+    failures += check(game.current_player() == 2, "rules: a move landing on an extra turn cell keeps the turn");
+    return failures;
+}
+
+int check_jump_chains() {
+    std::vector<snl::board_builder_t::jump_t> jumps;
+    for (snl::cell_iterator_t c = 1; c != 30001; ++c) jumps.emplace_back(c, static_cast<snl::cell_iterator_t>(c + 1));
+    auto const start = std::chrono::high_resolution_clock().now();
+    auto failures = check(snl::jumps_settle(jumps.data(), jumps.size()), "jumps: a chain of 30000 jumps settles");
+    failures += check(std::chrono::high_resolution_clock().now() - start < std::chrono::seconds(1), "jumps: following the chain takes less than a second");
+    jumps.back().second = 1;
+    failures += check(!snl::jumps_settle(jumps.data(), jumps.size()), "jumps: closing the chain into a cycle doesn't settle");
+    return failures;
+}
+
+int check_benchmark_json() {
+    auto const infinity = std::numeric_limits<double>::infinity();
+    std::stringstream json;
+    json.precision(3);
+    tlg::write_json(json, { { "gps", "games/s", true, { 1, std::nan(""), infinity, -infinity } } });
+    auto failures = check(json.str().find("[1,null,null,null]") != std::string::npos, "benchmark: samples that aren't finite are written as null");
+    failures += check(json.precision() == 3, "benchmark: writing json keeps the stream's precision");
+    auto const read = tlg::read_json(json);
+    failures += check(read.size() == 1 && read[0].samples.size() == 4 && read[0].samples[0] == 1 && std::isnan(read[0].samples[1]), "benchmark: null reads back as NaN");
+
+    auto refused = 0;
+    for (auto const* text : { "{\"benchmarks\":[{\"samples\":[1e999]}]}", "{\"benchmarks\":[{\"samples\":[x]}]}" }) {
+        std::istringstream is(text);
+        try {
+            tlg::read_json(is);
+        }
+        catch (std::runtime_error const&) {
+            ++refused;
+        }
+    }
+    failures += check(refused == 2, "benchmark: malformed numbers throw std::runtime_error");
+
+    std::vector<tlg::benchmark_result_t> const baseline = { { "gps", "games/s", true, { 1, 2, 3 } }, { "tps", "turns/s", true, { 1, 2, 3 } } };
+    auto const report = tlg::compare_benchmarks(baseline, { baseline[0] });
+    failures += check(!tlg::passed(report) && tlg::passed(report, true), "benchmark: a missing benchmark fails unless allowed");
+
+    tlg::comparison_options_t options;
+    options.confidence = 0.9;
+    std::ostringstream printed;
+    printed << tlg::compare_benchmarks(baseline, baseline, options);
+    failures += check(printed.str().find("90% CI") != std::string::npos && printed.str().find("95% CI") == std::string::npos, "benchmark: the report prints the confidence level it was computed at");
+    return failures;
+}
+
+int check_dice_seeds() {
+    auto rolls = [](std::uint64_t seed) {
+        tlg::dice_t<std::int8_t> dice(6, seed);
+        std::vector<std::int8_t> rc(64);
+        for (auto& r : rc) r = dice.roll();
+        return rc;
+    };
+    std::mt19937 engine(2016);
+    std::uniform_int_distribution<int> die(1, 6);
+    auto same = true;
+    for (auto r : rolls(2016)) same = same && r == die(engine);
+    auto failures = check(same, "dice: a 32 bit seed rolls as it always has");
+    failures += check(rolls(2016) != rolls(2016 + (std::uint64_t{ 1 } << 32)), "dice: seeds that differ in the upper 32 bits roll differently");
+
+    auto split_rolls = [](std::uint64_t seed) {//the rolls of a root, its two children & a grandchild, split in this order
+        tlg::splittable_dice_t<std::int8_t> root(100, seed);
+        auto first = root.split(), second = root.split();
+        auto grandchild = first.split();
+        std::vector<std::vector<std::int8_t>> rc;
+        for (auto* dice : { &root, &first, &second, &grandchild }) {
+            rc.emplace_back(64);
+            for (auto& r : rc.back()) r = dice->roll();
+        }
+        return rc;
+    };
+    auto const tree = split_rolls(2016);
+    failures += check(tree == split_rolls(2016), "dice: equal seeds & splits roll equal trees");
+    auto distinct = true;
+    for (std::size_t i = 0; i != tree.size(); ++i)
+        for (auto j = i + 1; j != tree.size(); ++j) distinct = distinct && tree[i] != tree[j];
+    failures += check(distinct, "dice: sibling, parent & child streams roll differently");
+    return failures;
+}
+
+int check_cache_budgets() {
+    snl::board_metrics_t metrics;
+    metrics.wins.resize(1);
+    snl::metrics_index_t metrics_index(1, 2 * snl::metrics_index_t(1).columns() * 16);
+    auto inserted = 0;
+    try {
+        for (; inserted != 100; ++inserted) {
+            metrics.hash = static_cast<std::uint64_t>(inserted);
+            metrics_index.insert(metrics);
+        }
+    }
+    catch (std::runtime_error const&) {}
+    auto failures = check(inserted < 100 && metrics_index.size() == static_cast<std::size_t>(inserted) && metrics_index.bytes() <= metrics_index.budget_bytes(), "caches: a metrics index stops at its budget");
+    auto replaced = true;
+    try {
+        metrics.hash = 0;
+        metrics_index.insert(metrics);
+    }
+    catch (std::runtime_error const&) {
+        replaced = false;
+    }
+    failures += check(replaced && metrics_index.size() == static_cast<std::size_t>(inserted) && metrics_index.bytes() <= metrics_index.budget_bytes(), "caches: a full metrics index still replaces a board's metrics");
+    auto const cached = tlg::memory_usage(tlg::memory_component_t::caches).current;
+    metrics_index.erase(0);
+    failures += check(tlg::memory_usage(tlg::memory_component_t::caches).current < cached, "caches: the hashes of a metrics index are charged to caches");
+
+    snl::signature_index_t signature_index(10 * sizeof(snl::signature_index_t::vector_t));
+    signature_index.train({ snl::signature_index_t::vector_t{} }, 1);
+    std::size_t added = 0;
+    try {
+        for (; added != 100; ++added) signature_index.add(added, {});
+    }
+    catch (std::runtime_error const&) {}
+    failures += check(added < 100 && signature_index.size() == added && signature_index.bytes() <= signature_index.budget_bytes(), "caches: a signature index stops at its budget");
+    failures += check(signature_index.search({}, 0).empty(), "caches: a search for no neighbours finds none");
+    return failures;
+}
+
+/*! @brief The dice of the scheduler check, which fail to construct for 5 sides, as a broken chunk would.
+*/
+class five_sides_fail_dice_t : public tlg::upto3_dice_t<tlg::dice_t<std::int8_t>> {
+public:
+    five_sides_fail_dice_t(std::int8_t sides, std::uint64_t seed) : upto3_dice_t(sides, seed) {
+        if (sides == 5) throw std::runtime_error("dice: broken");
+    }
+};
+
+/*! @brief Checks that a job whose chunk throws hands the exception to its future & leaves the scheduler working.
+*/
+int check_scheduler_failures() {
+    snl::board_t const board(snl::board_builder_t(10).add_jump(8, 30).add_jump(16, 6).finalize());
+    snl::job_cost_model_t model;
+    snl::scheduler_config_t config;
+    snl::job_scheduler_t<five_sides_fail_dice_t> scheduler(model, config);
+    snl::simulation_config_t broken, healthy;
+    broken.games = healthy.games = 1 << 12;
+    broken.games_per_chunk = healthy.games_per_chunk = 1 << 6;
+    broken.sides = 5;
+
+    auto failed = scheduler.submit(1, board, broken);
+    auto succeeded = scheduler.submit(2, board, healthy);
+    scheduler.drain();
+    auto threw = false;
+    try {
+        failed.get();
+    }
+    catch (std::runtime_error const&) {
+        threw = true;
+    }
+    auto const metrics = scheduler.metrics();
+    auto failures = check(threw && metrics.queued == 0 && metrics.running == 0, "scheduler: a throwing job fails its future & drains");
+    failures += check(succeeded.get().turns.count() == healthy.games, "scheduler: other jobs still complete");
+
+    broken.sides = 0;
+    auto refused = false;
+    try {
+        scheduler.submit(1, board, broken);
+    }
+    catch (std::logic_error const&) {
+        refused = true;
+    }
+    return failures + check(refused, "scheduler: zero sided dice are refused");
+}
+
+/*! @brief Checks that every spectator of a feed mirrors the game, that one which falls a ring behind resyncs & that a rematch is seen once.
+*/
+int check_spectators() {
+    snl::board_t const board(snl::board_builder_t(10).add_jump(8, 30).add_jump(16, 6).finalize());
+    snl::game_t game(board, 3);
+    auto const feed = std::make_shared<snl::game_feed_t>(game, 16);
+    std::vector<snl::spectator_t> fast(8, snl::spectator_t(feed));
+    snl::spectator_t slow(feed);
+
+    auto publish = [&](int moves) {
+        for (int i = 0; i != moves && game; ++i) {
+            auto const player = game.current_player();
+            auto const from = game.player_position(player);
+            auto const roll = static_cast<snl::cell_offset_t>(1 + (i * 7 + 3) % 6);
+            game.move(roll, 0, 0);
+            feed->publish(snl::game_event_t{ 0, from, game.player_position(player), player, { static_cast<std::int8_t>(roll), 0, 0 },
+                game ? snl::game_state_t::running : snl::game_state_t::finished, game.current_player() }, game);
+            for (auto& spectator : fast) spectator.poll();
+        }
+    };
+    auto mirrors = [&](snl::spectator_t const& spectator) {
+        return spectator.state().positions == feed->snapshot().positions && spectator.state().current_player == game.current_player();
+    };
+
+    publish(40);
+    slow.poll();
+    auto failures = check(std::all_of(fast.begin(), fast.end(), [&](snl::spectator_t const& s) { return mirrors(s) && s.resyncs() == 0; }), "spectators: every spectator of a fan out mirrors the game");
+    failures += check(mirrors(slow) && slow.resyncs() != 0, "spectators: a spectator a ring behind resyncs to the game");
+
+    game = snl::game_t(board, 3);
+    feed->reset(game, 1);
+    failures += check(feed->snapshot().next_sequence == feed->events().published(), "spectators: the snapshot continues after the rematch");
+    std::size_t rematches = 0;
+    fast.front().poll([&](snl::game_event_t const& event) { rematches += event.player < 0; });
+    return failures + check(rematches == 1 && mirrors(fast.front()), "spectators: a rematch is seen once");
+}
+
+/*! @brief Checks that every pass of a deck_t deals each card once & reproducibly, & that solve_deck_chain() agrees with games dealt from a fresh deck.
+*/
+int check_decks() {
+    std::vector<int> const cards{ 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6 };
+    auto sorted = cards;
+    std::sort(sorted.begin(), sorted.end());
+    tlg::deck_t<int> deck(cards, 7), same(cards, 7);
+    auto permutations = true, reproducible = true;
+    for (int pass = 0; pass != 100; ++pass) {
+        std::vector<int> dealt;
+        for (std::size_t i = 0; i != deck.size(); ++i) {
+            dealt.push_back(deck.roll());
+            reproducible = reproducible && dealt.back() == same.roll();
+        }
+        std::sort(dealt.begin(), dealt.end());
+        permutations = permutations && dealt == sorted;
+    }
+    auto failures = check(permutations, "decks: every pass deals each card once");
+    failures += check(reproducible, "decks: equal seeds deal equal cards");
+
+    snl::board_t const board(snl::board_builder_t(10).add_jump(8, 30).add_jump(16, 6).finalize());
+    auto const chain = snl::solve_deck_chain(board, cards, snl::chain_config_t{});
+    tlg::integer_moments_t turns;
+    for (unsigned seed = 0; seed != 1 << 14; ++seed) {
+        tlg::deck_t<int> fresh(cards, seed);
+        snl::game_t game(board, 1);
+        std::int64_t moves = 0;
+        for (; game; ++moves) game.move(fresh);
+        turns.add(moves);
+    }
+    auto const standard_error = std::sqrt(turns.variance() / static_cast<double>(turns.count()));
+    return failures + check(std::abs(turns.mean() - chain.expected_turns) < 4 * standard_error, "decks: solve_deck_chain() agrees with games on a fresh deck");
+}
+
+/*! @brief Returns the mean turns of games played with Dice, the standard error of the mean as second.
+*/
+template<typename Dice, typename Move>
+std::pair<double, double> simulated_turns(snl::board_t const& board, Dice& dice, Move&& move, unsigned games) {
+    tlg::integer_moments_t turns;
+    for (unsigned g = 0; g != games; ++g) {
+        snl::game_t game(board, 2);
+        std::int64_t moves = 0;
+        for (; game; ++moves) move(game, dice);
+        turns.add(moves);
+    }
+    return{ turns.mean(), std::sqrt(turns.variance() / static_cast<double>(turns.count())) };
+}
+
+/*! @brief Checks the weights of composite dice, that pool_dice_t refuses values its roll_t can't hold & that the chain of a pool agrees with games rolling it.
+*/
+int check_dice_pools() {
+    auto const two_d6 = tlg::sum_of_dice(2, 6);
+    auto weights = two_d6.min() == 2 && two_d6.max() == 12 && two_d6.total() == 36;
+    for (auto v = 2; v <= 12; ++v) weights = weights && two_d6.weight(v) == static_cast<std::uint64_t>(6 - std::abs(v - 7));
+    auto failures = check(weights, "pools: 2d6 weighs 1, 2, .. 6, .. 1 out of 36");
+
+    auto const best3 = tlg::keep_highest(4, 6, 3);
+    std::uint64_t sum = 0;
+    for (auto v = best3.min(); v <= best3.max(); ++v) sum += static_cast<std::uint64_t>(v) * best3.weight(v);
+    failures += check(best3.total() == 1296 && sum == 15869, "pools: 4d6 keep highest 3 averages 15869 / 1296");
+
+    auto refused = false;
+    try {
+        tlg::pool_dice_t<std::int8_t> too_wide(tlg::dice_distribution_t::uniform(200), 1);
+    }
+    catch (std::logic_error const&) {
+        refused = true;
+    }
+    failures += check(refused, "pools: a value beyond roll_t is refused");
+
+    auto const advantage = tlg::keep_highest(2, 6, 1);//the games must be able to roll the 1 that lands on the end
+    snl::board_t const board(snl::board_builder_t(10).add_jump(8, 30).add_jump(16, 6).finalize());
+    snl::chain_config_t config;
+    config.players = 2;
+    config.rolls = snl::upto3_roll_distribution(advantage);
+    auto const upto3_chain = snl::solve_chain(board, config).expected_turns;
+    tlg::upto3_dice_t<tlg::pool_dice_t<std::int8_t>> upto3(std::in_place, advantage, 1);
+    auto const upto3_games = simulated_turns(board, upto3, [](snl::game_t& game, auto& dice) {
+        auto const roll = dice.roll();
+        game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+    }, 1 << 14);
+    failures += check(std::abs(upto3_games.first - upto3_chain) < 4 * upto3_games.second, "pools: the upto 3 chain of a d6 with advantage agrees with games");
+
+    config.rolls = snl::single_roll_distribution(advantage);
+    auto const single_chain = snl::solve_chain(board, config).expected_turns;
+    tlg::pool_dice_t<std::int8_t> single(advantage, 2);
+    auto const single_games = simulated_turns(board, single, [](snl::game_t& game, auto& dice) { game.move(dice.roll(), 0, 0); }, 1 << 14);
+    return failures + check(std::abs(single_games.first - single_chain) < 4 * single_games.second, "pools: the single roll chain of a d6 with advantage agrees with games");
+}
+
+/*! @brief Checks that parse_boards() keeps the valid boards of a library & reports each invalid one with its line, whatever the chunking.
+*/
+int check_board_parser() {
+    std::string const text = "side,from,to\n10,3,40,50,20\n10, 30 ,40 , 40,50\n10,3,40,3,50\n10,30,40,40,30\n# a comment\n10,3\n";
+    auto failures = 0;
+    for (std::size_t chunk_bytes : { std::size_t{ 1 } << 20, std::size_t{ 16 } }) {
+        snl::board_parse_config_t config;
+        config.chunk_bytes = chunk_bytes;
+        auto const parsed = snl::parse_boards(text.data(), text.size(), config);
+        failures += check(parsed.size() == 2 && parsed.boards[1].line == 3 && parsed.view(1).jump(1) == snl::board_builder_t::jump_t(40, 50) && parsed.lines == 7,
+            chunk_bytes > 16 ? "parser: boards are read in place" : "parser: boards are read in place from small chunks");
+        failures += check(parsed.errors.size() == 3 && parsed.errors[0].line == 4 && parsed.errors[1].line == 5 && parsed.errors[2].line == 7,
+            chunk_bytes > 16 ? "parser: two jumps from a cell, a cycle & a truncated jump are reported" : "parser: errors are reported from small chunks");
+    }
+    return failures;
+}
+
+int check_exact_length() {
+    snl::board_t const board(snl::board_builder_t(10).add_jump(8, 30).add_jump(16, 6).finalize());
+    snl::exact_chain_config_t config;
+    config.players = 3;
+    config.horizon = 60;
+    snl::chain_config_t chain_config;
+    chain_config.players = config.players;
+    auto const exact = snl::solve_length_exact(board, config);
+    auto const chain = snl::solve_chain(board, chain_config);
+    auto error = 0.0;
+    for (std::size_t t = 0; t != exact.size(); ++t) error = std::max(error, std::abs(exact[t].to_double() - chain.length[t]));
+    return check(exact.size() == config.horizon && error < 1e-12, "exact: length distribution of 3 players agrees with solve_chain()");
+}
+
+/*! Usage:
+    performance_test_main                                   Dice & game throughput, reproducibility of simulate().
+    performance_test_main load [rate...]                    Open loop latency curve of the session engine.
+    performance_test_main bench <out.json> [repetitions]    Repeated benchmark samples written as JSON.
+    performance_test_main scaling [threads...]              Thread scaling & bottleneck of every engine configuration.
+    performance_test_main tune [cache.tsv]                  Tunes the engine for the board & host, reusing & updating the cache file.
+    performance_test_main dataset <path> [games] [outcome|probability]
+                                                            Labelled mid-game states of simulated games, written as sharded binary files.
+    performance_test_main wire [queries]                    Batched binary requests through a loopback wire_server_t.
+    performance_test_main replica [shared memory name]      Cost & lag of replicating live sessions to a hot standby.
+    performance_test_main index [boards]                    Evaluates random boards into a metrics_index_t & times a range query.
+    performance_test_main similar [boards]                  Boards that play most like the test board, from a signature_index_t.
+    performance_test_main parse [boards]                    Parses a generated CSV board library on every cpu.
+    performance_test_main schedule [small jobs]             A big batch job & a stream of small ones through a job_scheduler_t.
+    performance_test_main exact [players] [horizon]         Exact length distribution on the test board, mean & winner on the product chain.
+    performance_test_main locality [jumps]                  solve_chain() on a huge board in board order & renumbered for locality.
+    performance_test_main check                             Self checks, exits with 1 if one fails.
+    performance_test_main compare <baseline.json> <candidate.json>
+                                                            Regression report, exits with 1 on a regression or a missing benchmark.
+*/
+int main(int argc, char* argv[]) {
+    auto const mode = std::string(argc > 1 ? argv[1] : "");
+
+    if (mode == "compare") {
+        if (argc != 4) {
+            std::cerr << "usage: " << argv[0] << " compare <baseline.json> <candidate.json>\n";
+            return 2;
+        }
+        std::ifstream baseline(argv[2]), candidate(argv[3]);
+        if (!baseline || !candidate) {
+            std::cerr << "cannot open " << (baseline ? argv[3] : argv[2]) << "\n";
+            return 2;
+        }
+        std::vector<tlg::benchmark_comparison_t> report;
+        try {
+            report = tlg::compare_benchmarks(tlg::read_json(baseline), tlg::read_json(candidate));
+        }
+        catch (std::runtime_error const& e) {
+            std::cerr << e.what() << "\n";
+            return 2;
+        }
+        std::cout << report;
+        return tlg::passed(report) ? 0 : 1;
+    }
+
+    if (mode == "check") {
+        auto const failures = check_wire_frames() + check_allocators() + check_rule_landing() + check_jump_chains() + check_benchmark_json() + check_dice_seeds() + check_cache_budgets() + check_scheduler_failures() + check_spectators() + check_decks() + check_dice_pools() + check_board_parser() + check_exact_length();
+        std::cout << (failures ? "failed" : "passed") << std::endl;
+        return failures ? 1 : 0;
+    }
+
+    auto const plan = tlg::plan_resources(sizeof(std::int8_t));
+    std::cout << plan << std::endl;
+
     auto const builder = snl::board_builder_t(10)
         .add_jump(97, 78)
         .add_jump(94, 74)
@@ -58,44 +722,421 @@ int main() {
         .finalize();
     snl::board_t board(builder);
 
+    if (mode == "load") {
+        snl::load_config_t config;
+        config.clients = plan.worker_threads;
+        if (argc > 2) config.offered_rates.clear();
+        for (auto i = 2; i < argc; ++i)
+            config.offered_rates.push_back(std::atof(argv[i]));
+
+        std::cout << snl::run_load_sweep(board, config) << std::endl;
+        return 0;
+    }
+
+    if (mode == "scaling") {
+        snl::scaling_config_t config;
+        config.cpus = plan.limits.cpus;
+        config.dice_buffer_length = std::min<std::size_t>(plan.dice_buffer_length, config.dice_buffer_length);
+        if (argc > 2) {
+            config.threads.clear();
+            for (auto i = 2; i < argc; ++i)
+                config.threads.push_back(static_cast<unsigned>(std::atoi(argv[i])));
+        }
+        else {
+            config.threads = { 1 };
+            while (config.threads.back() < 2 * plan.limits.cpus)
+                config.threads.push_back(2 * config.threads.back());
+        }
+
+        std::cout << snl::run_scaling_sweep(config) << std::endl;
+        return 0;
+    }
+
+    if (mode == "bench") {
+        if (argc < 3) {
+            std::cerr << "usage: " << argv[0] << " bench <out.json> [repetitions]\n";
+            return 2;
+        }
+        auto const results = run_benchmarks(board, plan, argc > 3 ? std::atoi(argv[3]) : 15);
+        std::ofstream out(argv[2]);
+        tlg::write_json(out, results);
+        tlg::write_json(std::cout, results);
+        return out ? 0 : 2;
+    }
+
+    if (mode == "tune") {
+        snl::tuning_cache_t cache;
+        if (argc > 2) {
+            std::ifstream in(argv[2]);
+            if (in) cache.load(in);
+        }
+
+        auto start_time = std::chrono::high_resolution_clock().now();
+        auto const choice = cache.choose(board, 3);
+        auto end_time = std::chrono::high_resolution_clock().now();
+        std::cout << "CPU        = " << tlg::cpu_model() << "\n";
+        std::cout << "Board hash = " << std::hex << snl::board_hash(board) << std::dec << "\n";
+        std::cout << "Choice     = " << choice << "\n";
+        std::cout << "Tune time  = " << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << " ms\n";
+
+        snl::simulation_config_t config;
+        config.players = 3;
+        config.games = 1 << 20;
+        start_time = std::chrono::high_resolution_clock().now();
+        snl::simulate_tuned(board, config, choice);
+        end_time = std::chrono::high_resolution_clock().now();
+        auto const gps = config.games / std::max(std::chrono::duration<double>(end_time - start_time).count(), 1e-9);
+        std::cout << "Tuned GPS  = " << gps << (cache.report(board, 3, gps) ? " (drifted, retuned next time)" : "") << std::endl;
+
+        if (argc > 2) {
+            std::ofstream out(argv[2]);
+            cache.save(out);
+            if (!out) return 2;
+        }
+        return 0;
+    }
+
+    if (mode == "dataset") {
+        if (argc < 3) {
+            std::cerr << "usage: " << argv[0] << " dataset <path> [games] [outcome|probability]\n";
+            return 2;
+        }
+        snl::dataset_config_t config;
+        config.path = argv[2];
+        if (argc > 3) config.games = std::strtoull(argv[3], nullptr, 10);
+        if (argc > 4 && std::string(argv[4]) == "probability") config.label = snl::dataset_label_t::win_probability;
+        config.threads = plan.limits.cpus;
+
+        auto const start_time = std::chrono::high_resolution_clock().now();
+        auto const dataset = snl::export_dataset(board, config);
+        auto const seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+        std::cout << "Shards     = " << dataset.files.size() << "\n";
+        std::cout << "Samples    = " << dataset.samples << "\n";
+        std::cout << "Bytes      = " << dataset.bytes << "\n";
+        std::cout << "Samples/s  = " << dataset.samples / seconds << std::endl;
+        return 0;
+    }
+
+    if (mode == "exact") {
+        snl::exact_chain_config_t config;
+        config.players = argc > 2 ? static_cast<snl::player_id_t>(std::atoi(argv[2])) : 1;
+        config.horizon = argc > 3 ? static_cast<std::size_t>(std::atoi(argv[3])) : 256;
+        config.threads = plan.limits.cpus;
+        auto const length = snl::solve_length_exact(board, config);
+        auto ended = 0.0;
+        for (auto const& p : length) ended += p.to_double();
+        auto const first = std::find_if(length.begin(), length.end(), [](tlg::big_rational_t const& p) { return !p.numerator.is_zero(); });
+        if (first != length.end())
+            std::cout << "First end  = turn " << first - length.begin() << " with " << *first << "\n";
+        std::cout << "Ended      ~ " << ended << " within " << length.size() << " turns\n";
+
+        // The product chain has cells^players states, so several players are solved on a small board.
+        snl::board_t const small(snl::random_board_builder(6, 6, 2016).finalize());
+        auto const exact = snl::solve_chain_exact(config.players == 1 ? board : small, config);
+        std::cout << "Board      = " << (config.players == 1 ? "test" : "6 x 6") << "\n";
+        std::cout << "Primes     = " << exact.primes << "\n";
+        std::cout << "Mean turns = " << exact.expected_turns << "\n           ~ " << exact.expected_turns.to_double() << "\n";
+        for (std::size_t i = 0; i != exact.wins.size(); ++i)
+            std::cout << "Player " << i << " win ~ " << exact.wins[i].to_double() << "\n";
+        return 0;
+    }
+
+    if (mode == "wire") {
+        auto const queries = argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : 64;
+        snl::wire_server_t server;
+        server.threads = plan.limits.cpus;
+        std::vector<std::pair<snl::board_builder_t, snl::simulation_config_t>> batch;
+        snl::wire_writer_t writer(snl::wire_kind_t::request, 1);
+        for (std::size_t i = 0; i != queries; ++i) {
+            snl::simulation_config_t config;
+            config.players = static_cast<snl::player_id_t>(2 + i % 3);
+            config.games = 1 << 12;
+            config.seed = i;
+            batch.emplace_back(builder, config);
+            writer.add_query(builder, config);
+        }
+        auto const request = writer.finish();
+
+        auto start_time = std::chrono::high_resolution_clock().now();
+        auto const parses = 1000;
+        for (auto i = 0; i != parses; ++i) {
+            snl::wire_request_view_t const view(request.data(), request.size());
+            for (auto const query : view) snl::board_t(query.board.builder());
+        }
+        auto const parse_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count() / parses;
+
+        snl::wire_client_t client(snl::wire_client_t::loopback(server));
+        start_time = std::chrono::high_resolution_clock().now();
+        auto const results = client.simulate(batch);
+        auto const serve_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+
+        auto same = true;
+        for (std::size_t i = 0; i != queries; ++i) {
+            auto config = batch[i].second;
+            config.threads = server.threads;
+            auto const expected = snl::simulate(board, config);
+            same = same && results[i].status == snl::wire_status_t::ok && results[i].wins == expected.wins &&
+                results[i].games == expected.turns.count() && results[i].mean_turns == expected.turns.mean();
+        }
+        std::cout << "Request    = " << request.size() << " bytes, " << request.size() / std::max<std::size_t>(queries, 1) << " per query\n";
+        std::cout << "Parse      = " << parse_seconds * 1e6 << " us per frame, boards built\n";
+        std::cout << "Serve      = " << serve_seconds * 1e3 << " ms per frame\n";
+        std::cout << "Wire same  = " << std::boolalpha << same << std::endl;
+        return same ? 0 : 1;
+    }
+
+    if (mode == "replica") {
+        auto const name = std::string(argc > 2 ? argv[2] : "snl.replication");
+        snl::session_id_t const sessions = 256;
+        auto const turns = 1 << 11;
+        auto const capacity = std::size_t{ 1 } << 20;//! @internal holds every entry, so a standby without a cpu of its own catches up after the hand over
+        auto const play = [&](snl::session_store_t<>& store) {
+            auto const start_time = std::chrono::high_resolution_clock().now();
+            for (auto t = 0; t != turns; ++t)
+                for (snl::session_id_t id = 0; id != sessions; ++id) store.play_turn(id, true);
+            return sessions * double(turns) / std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+        };
+
+        snl::session_store_t<> plain(board, sessions);
+        for (snl::session_id_t id = 0; id != sessions; ++id) plain.open(3, id);
+        auto const plain_tps = play(plain);
+
+        tlg::shared_memory_t::remove(name);
+        snl::replication_log_t primary_log(name, capacity), standby_log(name, capacity);
+        snl::session_store_t<> primary(board, sessions), standby(board, sessions);
+        for (snl::session_id_t id = 0; id != sessions; ++id) primary.open(3, id);
+        primary.replicate(&primary_log);
+
+        std::uint64_t max_lag = 0;
+        auto const follow = [&] {
+            while (!(standby_log.handed_over() && standby_log.lag() == 0)) {
+                max_lag = std::max(max_lag, standby_log.lag());
+                if (!standby.follow(standby_log)) std::this_thread::yield();
+            }
+        };
+        auto follower = plan.limits.cpus > 1 ? std::async(std::launch::async, follow) : std::async(std::launch::deferred, follow);
+        auto const replicated_tps = play(primary);
+        primary_log.hand_over();
+        follower.get();
+        tlg::shared_memory_t::remove(name);
+
+        auto same = !primary_log.overrun();
+        for (snl::session_id_t id = 0; id != sessions && same; ++id) {
+            auto const a = primary.play_turn(id, true), b = standby.play_turn(id, true);
+            same = primary.turns(id) == standby.turns(id) && a.player == b.player && a.position == b.position && a.state == b.state;
+        }
+        std::cout << "Plain      = " << plain_tps << " turns/s\n";
+        std::cout << "Replicated = " << replicated_tps << " turns/s\n";
+        std::cout << "Overhead   = " << 100 * (plain_tps / replicated_tps - 1) << " %\n";
+        std::cout << "Max lag    = " << max_lag << " entries of " << primary_log.capacity() << "\n";
+        std::cout << "Takeover   = " << (same ? "identical" : "diverged") << std::endl;
+        return same ? 0 : 1;
+    }
+
+    if (mode == "index") {
+        auto const boards = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+        snl::chain_config_t chain_config;
+        chain_config.players = 2;
+        snl::metrics_index_t index(chain_config.players, plan.cache_budget_bytes);
+
+        auto start_time = std::chrono::high_resolution_clock().now();
+        for (std::uint64_t i = 0; i != boards; ++i)
+            index.insert(snl::evaluate_board_metrics(snl::board_t(snl::random_board_builder(10, 16, i).finalize()), chain_config));
+        index.merge();
+        auto const build_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+
+        std::vector<snl::metric_range_t> const ranges = {
+            snl::metric_range_t::of(snl::board_metric_t::mean_turns, 35, 45),
+            snl::metric_range_t::of(snl::board_metric_t::turns_variance, 0, 600),
+            snl::metric_range_t::of(snl::board_metric_t::seat_imbalance, 0, 0.05),
+        };
+        start_time = std::chrono::high_resolution_clock().now();
+        auto const hits = index.query(ranges);
+        auto const query_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+        std::cout << "Boards     = " << index.size() << "\n";
+        std::cout << "Evaluate   = " << index.size() / build_seconds << " boards/s\n";
+        std::cout << "Query      = " << hits.size() << " boards in " << query_seconds * 1e3 << " ms" << std::endl;
+        return 0;
+    }
+
+    if (mode == "similar") {
+        auto const boards = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+        snl::chain_config_t chain_config;
+        chain_config.players = 2;
+        chain_config.tolerance = 1e-9;
+
+        auto start_time = std::chrono::high_resolution_clock().now();
+        std::vector<snl::board_signature_t> signatures;
+        for (std::uint64_t i = 0; i != boards; ++i)
+            signatures.push_back(snl::board_signature(snl::board_t(snl::random_board_builder(10, 4 + i % 24, i).finalize()), chain_config));
+        snl::signature_index_t index(plan.cache_budget_bytes);
+        index.train(signatures, std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(double(boards)))));
+        for (std::uint64_t i = 0; i != boards; ++i) index.add(i, signatures[i]);
+        auto const build_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+
+        auto const query = snl::board_signature(board, chain_config);
+        start_time = std::chrono::high_resolution_clock().now();
+        auto const nearest = index.search(query, 5);
+        auto const query_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+        auto const exact = index.search_exact(query, 5);
+        auto found = 0;
+        for (auto const& n : nearest)
+            found += std::count_if(exact.begin(), exact.end(), [&](snl::signature_index_t::neighbour_t const& e) { return e.second == n.second; });
+
+        std::cout << "Boards     = " << index.size() << " in " << index.lists() << " lists, " << boards / build_seconds << " boards/s\n";
+        std::cout << "Query      = " << query_seconds * 1e3 << " ms, recall@5 " << found / 5. << "\n";
+        for (auto const& n : nearest)
+            std::cout << "Seed " << n.second << "    = distance " << std::sqrt(n.first) << "\n";
+        std::cout << std::flush;
+        return 0;
+    }
+
+    if (mode == "parse") {
+        auto const boards = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+        std::string text = "side,from,to...\n";
+        for (std::uint64_t i = 0; i != boards; ++i) {
+            auto const builder = snl::random_board_builder(10, 4 + i % 24, i);
+            text += "10";
+            for (auto const& jump : builder.jumps()) text += "," + std::to_string(jump.first) + "," + std::to_string(jump.second);
+            text += i % 1000 == 999 ? ",7,7\n" : "\n";//! @internal a jump onto itself now & then, to be reported
+        }
+
+        snl::board_parse_config_t config;
+        config.threads = plan.limits.cpus;
+        auto const start_time = std::chrono::high_resolution_clock().now();
+        auto const parsed = snl::parse_boards(text.data(), text.size(), config);
+        auto const seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+
+        std::cout << "Text       = " << text.size() / 1e6 << " MB, " << text.size() / seconds / 1e6 << " MB/s on " << config.threads << " threads\n";
+        std::cout << "Boards     = " << parsed.size() << ", " << parsed.jumps.size() / 4 << " jumps\n";
+        std::cout << "Errors     = " << parsed.errors.size();
+        if (!parsed.errors.empty()) std::cout << ", first on line " << parsed.errors.front().line << ": " << parsed.errors.front().message;
+        std::cout << std::endl;
+        return 0;
+    }
+
+    if (mode == "schedule") {
+        auto const small_jobs = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+        snl::job_cost_model_t model;
+        snl::scheduler_config_t config;
+        config.threads = plan.limits.cpus;
+        snl::job_scheduler_t<> scheduler(model, config);
+        scheduler.set_share(1, 1.);
+        scheduler.set_share(2, 2.);
+
+        snl::simulation_config_t big;//! @internal a batch tenant's job, seconds of work
+        big.games = 1 << 22;
+        big.players = 4;
+        big.games_per_chunk = 1 << 10;//! @internal a slice is at least a chunk, smaller chunks preempt sooner
+        auto const start_time = std::chrono::high_resolution_clock().now();
+        auto big_result = scheduler.submit(1, board, big);
+
+        snl::board_t const small_board(snl::random_board_builder(6, 4, 2016).finalize());
+        std::vector<std::future<snl::simulation_result_t>> small_results;
+        for (std::uint64_t i = 0; i != small_jobs; ++i) {//! @internal an interactive tenant's jobs, a millisecond or so each
+            snl::simulation_config_t small;
+            small.games = 200 + 100 * (i % 8);
+            small.seed = i;
+            small_results.push_back(scheduler.submit(2, small_board, small, static_cast<int>(i % 2)));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        scheduler.drain();
+        auto const seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+
+        auto const result = big_result.get();
+        std::cout << "Time taken = " << seconds * 1e3 << " ms on " << config.threads << " threads\n";
+        std::cout << "Big mean   = " << static_cast<double>(result.turns.sum()) / static_cast<double>(result.turns.count()) << "\n";
+        std::cout << scheduler.metrics() << std::flush;
+        return 0;
+    }
+
+    if (mode == "locality") {
+        auto const jumps = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3000;
+        snl::length_t const side = 127;
+        auto const cells = side * side;
+        snl::board_builder_t builder(side);//! @internal jumps across the whole board, unlike random_board_builder()
+        std::mt19937_64 engine(2016);
+        std::uniform_int_distribution<int> cell(1, cells - 2);
+        std::vector<bool> used(static_cast<std::size_t>(cells));
+        for (auto attempts = 64 * jumps; builder.jumps().size() < jumps && attempts; --attempts) {
+            auto const from = cell(engine), to = cell(engine);
+            if (used[from] || used[to] || std::abs(from - to) < 2 || (to < from && engine() % 4)) continue;//! @internal few snakes, or games last too long
+            builder.add_jump(static_cast<snl::cell_iterator_t>(from), static_cast<snl::cell_iterator_t>(to));
+            used[from] = used[to] = true;
+        }
+        builder.finalize();
+        snl::board_t const huge(builder);
+
+        snl::chain_config_t chain_config;
+        chain_config.tolerance = 1e-6;
+        for (auto renumber : { false, true }) {
+            chain_config.renumber = renumber;
+            auto const start_time = std::chrono::high_resolution_clock().now();
+            auto const result = snl::solve_chain(huge, chain_config);
+            auto const seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock().now() - start_time).count();
+            std::cout << (renumber ? "Renumbered  = " : "Board order = ") << seconds * 1e3 << " ms, mean " << result.expected_turns << "\n";
+        }
+        std::cout << std::flush;
+        return 0;
+    }
+
     auto const game_count = 1 << 22;
-    tlg::upto3_dice_t<
-        tlg::fixed_buffer_dice_t<
-        tlg::dice_t<std::int8_t> > > dice(6);
-    auto const buffer_length = 64 * 1024 * 1024;// 64 MB
+    measure_drps(plan, true);
 
+    buffered_dice_t dice(6, plan.dice_buffer_length);
+    measure_gps(board, dice, game_count, true);
+
+    tlg::job_arena_t arena(1 << 16, tlg::accounted_memory(tlg::memory_component_t::simulation));
+    snl::simulation_config_t config;
+    config.players = 3;
+    config.games = game_count / 4;
+    config.seed = 2016;
+    config.memory = &arena;
+
+    config.threads = 1;
+    auto const serial = snl::simulate(board, config);
+    config.threads = plan.worker_threads;
     auto start_time = std::chrono::high_resolution_clock().now();
-    dice.roll();
+    auto const parallel = snl::simulate(board, config);
     auto end_time = std::chrono::high_resolution_clock().now();
 
     auto time_taken = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-    auto drps = 1000. * double{ buffer_length } / time_taken;
+    auto const reproducible = serial.turns == parallel.turns && serial.wins == parallel.wins;
 
+    std::cout << "Threads    = " << config.threads << "\n";
     std::cout << "Time taken = " << time_taken << " ms\n";
-    std::cout << "Dice rolls = " << buffer_length << "\n";
-    std::cout << "DRPS       = " << drps << "\n";
+    std::cout << "Mean turns = " << parallel.turns.mean() << "\n";
+    std::cout << "Variance   = " << parallel.turns.variance() << "\n";
+    std::cout << "Identical  = " << (reproducible ? "yes" : "NO") << "\n";
 
-    auto counter = game_count;
-    snl::game_t game(board, 3);
+    start_time = std::chrono::high_resolution_clock().now();
+    auto const batch = snl::simulate_batch(board, config);
+    end_time = std::chrono::high_resolution_clock().now();
 
-    //player_strategy_t strategy;
+    std::cout << "Batch time = " << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << " ms\n";
+    std::cout << "Batch mean = " << batch.turns.mean() << "\n";
 
+    snl::game_kernel_t const jit(board, config.players), table(board, config.players, false);
+    auto const speedup = measure_kernel_mps(jit, true) / measure_kernel_mps(table, true);
     start_time = std::chrono::high_resolution_clock().now();
-    while (counter--) {
-        game.reset();
-        while (game) {
-            auto roll = dice.roll();
-            game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
-        }
-    }
+    auto const compiled = snl::simulate_kernel(jit, config);
     end_time = std::chrono::high_resolution_clock().now();
+    auto const jit_identical = compiled.turns == parallel.turns && compiled.wins == parallel.wins
+        && snl::simulate_kernel(table, config).turns == parallel.turns;
+    std::cout << "Speedup    = " << speedup << "\n";
+    std::cout << "JIT time   = " << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << " ms\n";
+    std::cout << "JIT same   = " << (jit_identical ? "yes" : "NO") << "\n";
 
-    time_taken = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-    auto gps = 1000. * double{ game_count } / time_taken;
-
-    std::cout << "Time taken = " << time_taken << " ms\n";
-    std::cout << "Games      = " << game_count << "\n";
-    std::cout << "GPS        = " << gps << std::endl << std::endl;
-    return 0;
-}
+    snl::chain_config_t chain_config;
+    chain_config.players = config.players;
+    std::cout << "Chain mean = " << snl::solve_chain(board, chain_config).expected_turns << "\n";
 
+    auto const controlled = snl::simulate_controlled(board, config);
+    std::cout << "CV mean    = " << controlled.turns.mean << " +- " << controlled.turns.half_width
+        << " (plain +- " << controlled.turns.plain_half_width << ")\n";
+    std::cout << "CV seat 0  = " << controlled.wins[0].mean << " +- " << controlled.wins[0].half_width
+        << " (plain +- " << controlled.wins[0].plain_half_width << ")\n";
+    std::cout << "Arena      = " << arena.allocated() << " bytes\n\n";
+    std::cout << tlg::memory_usage() << std::endl;
+    return reproducible && jit_identical ? 0 : 1;
+}
\ No newline at end of file
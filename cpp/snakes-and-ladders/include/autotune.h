@@ -0,0 +1,359 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "include\dice.h"
+#include "include\memory_accounting.h"
+#include "include\resources.h"
+#include "batch.h"
+#include "simulation.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief The game loop of a tuned run.
+    */
+    enum class engine_t : std::uint8_t {
+        scalar,//! simulate(), one game at a time.
+        batch//! simulate_batch(), engine_choice_t::lanes games at a time.
+    };
+
+    /*! @brief The random bit generator of the dice of a tuned run.
+    */
+    enum class tuned_dice_t : std::uint8_t {
+        mt19937,//! the_learning_games::dice_t on std::mt19937.
+        splitmix64//! the_learning_games::splittable_dice_t.
+    };
+
+    /*! @brief A complete engine configuration & the throughput it reached when it was measured.
+        @details Only threads leaves the games played unchanged. The engine, lanes, dice & games_per_chunk each select
+        other, equally distributed games, so a run is reproducible given its choice, not given the board alone.
+    */
+    struct engine_choice_t {
+        engine_t engine = engine_t::scalar;
+        std::size_t lanes = 16;//! Lanes of the batch engine, one of 4, 8, 16 & 32.
+        tuned_dice_t dice = tuned_dice_t::mt19937;
+        unsigned threads = 1;
+        std::uint64_t games_per_chunk = 1 << 12;
+        double games_per_second = 0;//! Measured by the trial, 0 if never measured.
+    };
+
+    /*! @brief The search space & the trial budget of tune_engine().
+    */
+    struct tuning_config_t {
+        player_id_t players = 2;//! Players per game of the trials.
+        std::int8_t sides = 6;//! Sides of the dice.
+        std::vector<std::size_t> lanes = { 4, 8, 16, 32 };//! Batch engine widths to try.
+        std::vector<std::uint64_t> games_per_chunk = { 1 << 10, 1 << 12, 1 << 14 };//! Chunk sizes to try.
+        unsigned max_threads = 1;//! Powers of two up to max_threads are tried, & max_threads itself, @see the_learning_games::resource_limits_t
+        double trial_seconds = 0.02;//! Target duration of one trial.
+        unsigned repetitions = 3;//! Trials per candidate, the fastest counts.
+    };
+
+    namespace detail {
+        template<typename Single>
+        using tuned_upto3_t = the_learning_games::upto3_dice_t<Single>;
+
+        template<typename Dice, std::size_t Lanes>
+        simulation_result_t simulate_lanes(board_t const& board, simulation_config_t const& config) {
+            return simulate_batch<Lanes, Dice>(board, config);
+        }
+
+        template<typename Dice>
+        simulation_result_t simulate_engine(board_t const& board, simulation_config_t const& config, engine_choice_t const& choice) {
+            if (choice.engine == engine_t::scalar) return simulate<Dice>(board, config);
+            switch (choice.lanes) {
+            case 4: return simulate_lanes<Dice, 4>(board, config);
+            case 8: return simulate_lanes<Dice, 8>(board, config);
+            case 16: return simulate_lanes<Dice, 16>(board, config);
+            case 32: return simulate_lanes<Dice, 32>(board, config);
+            default: throw std::logic_error("pre: lanes not one of 4, 8, 16, 32");
+            }
+        }
+    }
+
+    /*! @brief simulate() with the engine, dice, threads & chunk size of choice. The other fields of config are kept.
+    */
+    inline simulation_result_t simulate_tuned(board_t const& board, simulation_config_t config, engine_choice_t const& choice) {
+        config.threads = choice.threads;
+        config.games_per_chunk = choice.games_per_chunk;
+        if (choice.dice == tuned_dice_t::splitmix64)
+            return detail::simulate_engine<detail::tuned_upto3_t<the_learning_games::splittable_dice_t<std::int8_t>>>(board, config, choice);
+        return detail::simulate_engine<detail::tuned_upto3_t<the_learning_games::dice_t<std::int8_t>>>(board, config, choice);
+    }
+
+    namespace detail {
+        /*! @internal @brief Games per second of choice on board, the best of config.repetitions calibrated trials.
+            @details The first runs double the games until a run takes a quarter of config.trial_seconds; every trial
+            then plays the games which that rate predicts for config.trial_seconds.
+        */
+        inline double measure_choice(board_t const& board, engine_choice_t const& choice, tuning_config_t const& config) {
+            simulation_config_t sim;
+            sim.players = config.players;
+            sim.sides = config.sides;
+            sim.seed = 2016;
+
+            auto run = [&](std::uint64_t games) {
+                sim.games = games;
+                auto const start = std::chrono::steady_clock::now();
+                simulate_tuned(board, sim, choice);
+                return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            };
+
+            std::uint64_t games = 64;
+            auto seconds = run(games);
+            while (seconds < config.trial_seconds / 4 && games < (std::uint64_t{ 1 } << 40)) {
+                games *= 2;
+                seconds = run(games);
+            }
+            games = std::max<std::uint64_t>(static_cast<std::uint64_t>(games * config.trial_seconds / std::max(seconds, 1e-9)), 1);
+
+            double rc = 0;
+            for (auto i = 0u; i != std::max(config.repetitions, 1u); ++i) {
+                sim.seed = 2016 + i;
+                rc = std::max(rc, games / std::max(run(games), 1e-9));
+            }
+            return rc;
+        }
+    }
+
+    /*! @brief Picks the fastest engine configuration for board on this host by timing short trials of each candidate.
+        @details The search is staged so that it stays short: every engine, lane width & dice is timed on one thread at
+        the first chunk size, then the thread count & the chunk size are tuned for the fastest of those. Run it on an
+        otherwise idle host, other load skews the trials.
+    */
+    inline engine_choice_t tune_engine(board_t const& board, tuning_config_t const& config) {
+        if (config.players < 1) throw std::logic_error("pre: player count less than one");
+        if (config.games_per_chunk.empty()) throw std::logic_error("pre: no chunk size");
+
+        engine_choice_t best;
+        best.games_per_chunk = config.games_per_chunk.front();
+        auto consider = [&](engine_choice_t candidate) {
+            candidate.games_per_second = detail::measure_choice(board, candidate, config);
+            if (candidate.games_per_second > best.games_per_second) best = candidate;
+        };
+
+        for (auto dice : { tuned_dice_t::mt19937, tuned_dice_t::splitmix64 }) {
+            auto candidate = best;
+            candidate.dice = dice;
+            candidate.engine = engine_t::scalar;
+            consider(candidate);
+            candidate.engine = engine_t::batch;
+            for (auto lanes : config.lanes) {
+                candidate.lanes = lanes;
+                consider(candidate);
+            }
+        }
+
+        std::vector<unsigned> threads;
+        for (auto t = 1u; t < config.max_threads; t *= 2) threads.push_back(t);
+        threads.push_back(std::max(config.max_threads, 1u));
+
+        auto const fastest_single = best;
+        for (auto t : threads) {
+            for (auto chunk : config.games_per_chunk) {
+                if (t == fastest_single.threads && chunk == fastest_single.games_per_chunk) continue;
+                auto candidate = fastest_single;
+                candidate.threads = t;
+                candidate.games_per_chunk = chunk;
+                consider(candidate);
+            }
+        }
+        return best;
+    }
+
+    /*! @brief Prints a choice as e.g. `batch x16 splitmix64, 4 threads, 4096 games per chunk (1.2e+06 games/s)`
+    */
+    inline std::ostream& operator<< (std::ostream& os, engine_choice_t const& choice) {
+        os << (choice.engine == engine_t::scalar ? "scalar" : "batch");
+        if (choice.engine == engine_t::batch) os << " x" << choice.lanes;
+        return os << " " << (choice.dice == tuned_dice_t::mt19937 ? "mt19937" : "splitmix64") << ", " << choice.threads
+            << " threads, " << choice.games_per_chunk << " games per chunk (" << choice.games_per_second << " games/s)";
+    }
+
+    /*! @brief Remembers tune_engine() decisions keyed by (cpu model, board hash, players).
+        @details A decision is tuned again on its next lookup when
+            1. the usable cpus differ from those it was tuned with, e.g. after the cgroup quota changed,
+            2. it is older than max_age, or
+            3. a run reported through report() fell below drift times the tuned throughput.
+        Tuning is serialized, so that trials of different boards don't skew each other; lookups of tuned boards don't
+        wait for it. The entries are charged to the_learning_games::memory_component_t::caches & can be saved & loaded,
+        so that a restarted process skips the trials.
+    */
+    class tuning_cache_t {
+    public:
+        //! Identifies a decision.
+        using key_t = std::tuple<std::string, std::uint64_t, player_id_t>;
+
+        //! A decision & the conditions it was made under.
+        struct entry_t {
+            engine_choice_t choice;
+            unsigned cpus = 0;//! Usable cpus when tuned.
+            std::int64_t tuned_at = 0;//! Seconds since the epoch.
+            bool stale = false;
+        };
+
+    private:
+        using map_t = std::map<key_t, entry_t, std::less<key_t>,
+            the_learning_games::accounted_allocator_t<std::pair<key_t const, entry_t>, the_learning_games::memory_component_t::caches>>;
+
+        tuning_config_t config;
+        std::function<unsigned()> usable_cpus;
+        std::string const cpu;
+        std::mutex mutex;//! @internal guards entries
+        std::mutex tuning;//! @internal held for the whole of a tune_engine()
+        map_t entries;
+
+    public:
+        std::chrono::seconds max_age = std::chrono::hours(24 * 7);//! 0 for no expiry.
+        double drift = 0.7;//! Fraction of the tuned throughput below which a report() marks the decision stale.
+
+        /*! @param config The trial budget & search space. players & max_threads are set per lookup.
+            @param usable_cpus Returns the cpus the process may use now, the cgroup aware count by default.
+        */
+        explicit tuning_cache_t(tuning_config_t config = {}, std::function<unsigned()> usable_cpus = {}) :
+            config(std::move(config)),
+            usable_cpus(usable_cpus ? std::move(usable_cpus) : [] { return the_learning_games::discover_resources().cpus; }),
+            cpu(the_learning_games::cpu_model())
+        {}
+
+        /*! @brief Returns the decision for board & players, tuning it first if there is none or it is out of date.
+        */
+        engine_choice_t choose(board_t const& board, player_id_t players) {
+            auto const key = key_t(cpu, board_hash(board), players);
+            auto const cpus = usable_cpus();
+            if (auto const cached = find(key, cpus)) return *cached;
+
+            std::lock_guard<std::mutex> guard(tuning);
+            if (auto const cached = find(key, cpus)) return *cached;//! @internal tuned while we waited
+
+            auto trial = config;
+            trial.players = players;
+            trial.max_threads = cpus;
+            entry_t entry{ tune_engine(board, trial), cpus, now(), false };
+
+            std::lock_guard<std::mutex> lock(mutex);
+            entries[key] = entry;
+            return entry.choice;
+        }
+
+        /*! @brief Reports the throughput of a run made with the decision for board & players.
+            @return Returns true if the decision was marked stale.
+        */
+        bool report(board_t const& board, player_id_t players, double games_per_second) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto const it = entries.find(key_t(cpu, board_hash(board), players));
+            if (it == entries.end() || games_per_second >= drift * it->second.choice.games_per_second) return false;
+            it->second.stale = true;
+            return true;
+        }
+
+        /*! @brief Drops every decision, e.g. after a change the cache can't observe such as a new build.
+        */
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.clear();
+        }
+
+        std::size_t size() {//! @brief Returns the number of decisions held, stale ones included.
+            std::lock_guard<std::mutex> lock(mutex);
+            return entries.size();
+        }
+
+        /*! @brief Writes every decision, one tab separated line each.
+        */
+        void save(std::ostream& os) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto const& e : entries) {
+                auto const& c = e.second.choice;
+                os << std::get<0>(e.first) << '\t' << std::get<1>(e.first) << '\t' << std::get<2>(e.first) << '\t'
+                    << static_cast<int>(c.engine) << '\t' << c.lanes << '\t' << static_cast<int>(c.dice) << '\t' << c.threads << '\t'
+                    << c.games_per_chunk << '\t' << c.games_per_second << '\t' << e.second.cpus << '\t' << e.second.tuned_at << '\t'
+                    << e.second.stale << '\n';
+            }
+        }
+
+        /*! @brief Adds the decisions written by save(), replacing those with the same key.
+            @throws std::runtime_error On a malformed line.
+        */
+        void load(std::istream& is) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::string line; std::getline(is, line);) {
+                if (line.empty()) continue;
+                auto const tab = line.find('\t');
+                if (tab == std::string::npos) throw std::runtime_error("tuning cache: malformed line");
+                std::istringstream fields(line.substr(tab + 1));
+                std::uint64_t hash;
+                int players, engine, dice;
+                entry_t entry;
+                auto& c = entry.choice;
+                if (!(fields >> hash >> players >> engine >> c.lanes >> dice >> c.threads >> c.games_per_chunk >> c.games_per_second
+                    >> entry.cpus >> entry.tuned_at >> entry.stale) || engine > 1 || dice > 1)
+                    throw std::runtime_error("tuning cache: malformed line");
+                c.engine = static_cast<engine_t>(engine);
+                c.dice = static_cast<tuned_dice_t>(dice);
+                entries[key_t(line.substr(0, tab), hash, static_cast<player_id_t>(players))] = entry;
+            }
+        }
+
+    private:
+        static std::int64_t now() {
+            return static_cast<std::int64_t>(std::time(nullptr));
+        }
+
+        /*! @internal @brief Returns the decision for key if it is up to date.
+        */
+        std::optional<engine_choice_t> find(key_t const& key, unsigned cpus) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto const it = entries.find(key);
+            if (it == entries.end()) return std::nullopt;
+            auto const& e = it->second;
+            auto const expired = max_age.count() > 0 && now() - e.tuned_at > max_age.count();
+            if (e.stale || e.cpus != cpus || expired) return std::nullopt;
+            return e.choice;
+        }
+    };
+}
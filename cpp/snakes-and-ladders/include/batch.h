@@ -0,0 +1,159 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <vector>
+
+#include "simulation.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief Simulates a chunk of games Lanes games at a time.
+        @details Every lane holds an independent game, kept as a structure of arrays, and one step moves the current
+        player of every live lane once. The board lookups of different lanes don't depend on each other, so they
+        overlap in the pipeline instead of queueing behind a single game's chain of moves. A lane whose game finishes
+        records it & starts the chunk's next game until all games have been started.
+        Special cells execute the same compiled tables as game_t::move(), so the result follows the same distribution
+        as simulate_chunk(), though not the same games: the lanes interleave their dice rolls.
+        Every lane indexes the board version in force at its own turn, so lanes may be on different versions.
+        @param rule_seed Game i of the chunk seeds its teleport cells from `(rule_seed, i)`.
+    */
+    template<std::size_t Lanes, typename Dice>
+    simulation_result_t simulate_chunk_batch(board_schedule_t const& schedule, simulation_config_t const& config, Dice& dice, std::uint64_t games, std::uint64_t rule_seed = 0) {
+        static_assert(Lanes > 0, "at least one lane");
+        auto const players = static_cast<std::size_t>(config.players);
+        auto const last_cell = static_cast<cell_iterator_t>(schedule.version(0).end() - 1);
+        auto rules = false;
+        for (std::size_t v = 0; v != schedule.size(); ++v) rules = rules || schedule.version(v).has_rules();
+
+        simulation_result_t rc;
+        rc.wins.resize(players);
+
+        std::vector<cell_iterator_t> positions(Lanes * players);//! @internal positions[lane * players + player]
+        std::vector<std::uint8_t> skipping(rules ? Lanes * players : 0);
+        std::array<player_id_t, Lanes> current{};
+        std::array<std::int64_t, Lanes> turns{};
+        std::array<std::uint64_t, Lanes> random{};
+        std::array<board_t const*, Lanes> board{};
+        std::array<std::uint64_t, Lanes> next_switch{};
+        std::array<bool, Lanes> live{};
+
+        std::uint64_t started = 0;
+        std::size_t live_lanes = 0;
+        auto start = [&](std::size_t lane) {
+            live[lane] = started != games;
+            if (!live[lane]) return;
+            std::fill_n(positions.begin() + lane * players, players, schedule.version(0).begin());
+            if (rules) std::fill_n(skipping.begin() + lane * players, players, std::uint8_t{});
+            current[lane] = 0;
+            turns[lane] = 0;
+            board[lane] = &schedule.version(schedule.version_at(0));
+            next_switch[lane] = schedule.next_switch(0);
+            random[lane] = detail::mix_seed(rule_seed, started++);
+        };
+        for (std::size_t lane = 0; lane != Lanes; ++lane) {
+            start(lane);
+            live_lanes += live[lane];
+        }
+
+        auto next_player = [players](player_id_t p) {
+            return static_cast<player_id_t>(static_cast<std::size_t>(p) + 1 == players ? 0 : p + 1);
+        };
+
+        while (live_lanes) {
+            for (std::size_t lane = 0; lane != Lanes; ++lane) {
+                if (!live[lane]) continue;
+
+                auto const roll = dice.roll();
+                cell_offset_t const moves[] = { std::get<0>(roll), std::get<1>(roll), std::get<2>(roll) };
+                auto& position = positions[lane * players + current[lane]];
+                auto const& lane_board = *board[lane];
+                if (static_cast<std::uint64_t>(++turns[lane]) == next_switch[lane]) {
+                    board[lane] = &schedule.version(schedule.version_at(turns[lane]));
+                    next_switch[lane] = schedule.next_switch(turns[lane]);
+                }
+
+                auto finished = false, landed = false;
+                for (auto offset : moves) {
+                    landed = landed || lane_board.lands(position, offset);
+                    position = lane_board.advance(position, offset);
+                    if ((finished = position == last_cell)) break;
+                }
+
+                auto action = cell_action_t::none;
+                if (!finished && landed && rules && lane_board.has_rules()) {
+                    action = lane_board.apply_rule(position, random[lane]);
+                    finished = position == last_cell;
+                }
+
+                if (finished) {
+                    rc.turns.add(turns[lane]);
+                    ++rc.wins[current[lane]];
+                    start(lane);
+                    live_lanes -= !live[lane];
+                    continue;
+                }
+                if (action == cell_action_t::extra_turn) continue;
+                if (action == cell_action_t::skip_turn) skipping[lane * players + current[lane]] = 1;
+
+                current[lane] = next_player(current[lane]);
+                if (rules) {
+                    while (skipping[lane * players + current[lane]]) {//each skip is consumed once, so this terminates
+                        skipping[lane * players + current[lane]] = 0;
+                        current[lane] = next_player(current[lane]);
+                    }
+                }
+            }
+        }
+        return rc;
+    }
+
+    /*! @brief simulate() with the batch engine, @see simulate_chunk_batch()
+        @details Bit identical for any thread count, like simulate(), but not to simulate() itself.
+    */
+    template<std::size_t Lanes = 16, typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    simulation_result_t simulate_batch(board_schedule_t const& schedule, simulation_config_t const& config) {
+        return detail::simulate_chunks<Dice>(config, [&](Dice& dice, std::uint64_t games, std::uint64_t rule_seed) {
+            return simulate_chunk_batch<Lanes>(schedule, config, dice, games, rule_seed);
+        });
+    }
+
+    /*! @brief simulate_batch() on a board that doesn't change.
+    */
+    template<std::size_t Lanes = 16, typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    simulation_result_t simulate_batch(board_t const& board, simulation_config_t const& config) {
+        return simulate_batch<Lanes, Dice>(board_schedule_t(board), config);
+    }
+}
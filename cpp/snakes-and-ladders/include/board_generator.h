@@ -0,0 +1,73 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief Builds a reproducible random board.
+        @param side The side length of the board.
+        @param jumps The number of snakes & ladders together.
+        @param seed Equal seeds produce equal boards.
+        @details Snakes & ladders are equally likely & at most 2 * side cells long, like the rows spanned on a printed
+        board, so the expected game length grows roughly linearly with the number of cells. Sources & targets are
+        distinct cells of [1, side * side - 2], so no jump starts where another one ends and board_t::advance() never
+        follows a chain, let alone a cycle.
+        @return Returns a finalized board_builder_t.
+    */
+    inline board_builder_t random_board_builder(length_t side, std::size_t jumps, std::uint64_t seed) {
+        auto const cells = cell_iterator_t{ side } *side;
+        if (cells < 4 || 2 * jumps > static_cast<std::size_t>(cells - 2)) throw std::logic_error("pre: too many jumps for the board");
+
+        std::mt19937_64 engine(seed);
+        std::uniform_int_distribution<int> cell(1, cells - 2), length(2, std::max(2 * side, 2));
+        std::bernoulli_distribution ladder(0.5);
+        std::vector<bool> used(static_cast<std::size_t>(cells));
+
+        board_builder_t builder(side);
+        for (auto attempts = 64 * jumps; builder.jumps().size() < jumps && attempts; --attempts) {
+            auto const from = cell(engine);
+            auto const to = from + (ladder(engine) ? 1 : -1) * length(engine);
+            if (to < 1 || to > cells - 2 || used[from] || used[to]) continue;
+
+            builder.add_jump(static_cast<cell_iterator_t>(from), static_cast<cell_iterator_t>(to));
+            used[from] = used[to] = true;
+        }
+        builder.finalize();
+        return builder;
+    }
+}
@@ -0,0 +1,369 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    //! The text formats of board libraries, one board per line.
+    enum class board_text_format_t {
+        csv,//! `side,from,to,from,to,...`
+        json_lines//! `{"side": 10, "jumps": [[97, 78], [94, 74]]}`, optionally followed by `,`
+    };
+
+    /*! @brief A record that was skipped, & why.
+    */
+    struct board_parse_error_t {
+        std::uint64_t line;//! 1 based.
+        char const* message;//! A string literal.
+    };
+
+    /*! @brief A board of a parsed_boards_t.
+    */
+    struct parsed_board_t {
+        std::uint64_t line;//! 1 based.
+        length_t side;
+        std::size_t first_jump;//! Index of its first jump in parsed_boards_t::jumps.
+        std::size_t jump_count;
+    };
+
+    /*! @brief The boards of a library in the packed binary layout, 4 bytes per jump as board_view_t reads them, & the
+        records that failed, in line order.
+    */
+    struct parsed_boards_t {
+        std::vector<std::uint8_t> jumps;//! The jumps of every board, one after the other.
+        std::vector<parsed_board_t> boards;
+        std::vector<board_parse_error_t> errors;
+        std::uint64_t lines = 0;//! Lines read, blank lines & comments included.
+
+        std::size_t size() const { return boards.size(); }//! @brief Returns the number of valid boards.
+
+        board_view_t view(std::size_t i) const {//! @brief Returns board i, read in place.
+            return board_view_t(boards[i].side, jumps.data() + 4 * boards[i].first_jump, boards[i].jump_count);
+        }
+
+        /*! @brief Appends the boards of a later part of the same library, renumbering its lines after these.
+        */
+        parsed_boards_t& append(parsed_boards_t const& other) {
+            auto const jump_base = jumps.size() / 4;
+            jumps.insert(jumps.end(), other.jumps.begin(), other.jumps.end());
+            for (auto board : other.boards) {
+                board.line += lines;
+                board.first_jump += jump_base;
+                boards.push_back(board);
+            }
+            for (auto error : other.errors) {
+                error.line += lines;
+                errors.push_back(error);
+            }
+            lines += other.lines;
+            return *this;
+        }
+    };
+
+    /*! @brief Parameters of parse_boards().
+    */
+    struct board_parse_config_t {
+        board_text_format_t format = board_text_format_t::csv;
+        unsigned threads = 1;//! Workers, each parsing a chunk at a time.
+        std::size_t chunk_bytes = std::size_t{ 1 } << 20;//! Text per chunk, extended to the end of its last line.
+    };
+
+    namespace detail {
+        /*! @internal @brief Reads the tokens of a single line without allocating.
+        */
+        class board_text_cursor_t {
+            char const* at;
+            char const* end;
+
+        public:
+            board_text_cursor_t(char const* begin, char const* end) : at(begin), end(end) {}
+
+            bool done() { skip_spaces(); return at == end; }
+            char peek() { skip_spaces(); return at == end ? '\0' : *at; }
+
+            bool literal(char c) {
+                if (at == end || *at != c) {//! @internal the text is rarely spaced, so look before skipping
+                    if (peek() != c) return false;
+                }
+                ++at;
+                return true;
+            }
+
+            bool key(char const* name) {//! @internal a quoted JSON key & its colon
+                auto const length = std::strlen(name);
+                if (peek() != '"' || static_cast<std::size_t>(end - at) < length + 2 || std::memcmp(at + 1, name, length) != 0 || at[length + 1] != '"') return false;
+                at += length + 2;
+                return literal(':');
+            }
+
+            bool number(int& value) {//! @internal a decimal integer of at most 8 digits
+                skip_spaces();
+                auto const negative = at != end && *at == '-';
+                auto p = at + negative;
+                auto const last = p + std::min<std::ptrdiff_t>(end - p, 9);
+                auto v = 0u;
+                for (unsigned d; p != last && (d = static_cast<unsigned>(*p) - '0') < 10; ++p)
+                    v = v * 10 + d;
+                if (p == at + negative || p - (at + negative) > 8) return false;
+                value = negative ? -static_cast<int>(v) : static_cast<int>(v);
+                at = p;
+                return true;
+            }
+
+        private:
+            void skip_spaces() {
+                while (at != end && (*at == ' ' || *at == '\t' || *at == '\r')) ++at;
+            }
+        };
+
+        /*! @internal @brief Checks a jump as board_builder_t::add_jump() would & appends it to jumps.
+        */
+        inline char const* add_parsed_jump(length_t side, int from, int to, std::vector<board_builder_t::jump_t>& jumps) {
+            if (auto const error = board_builder_t::jump_error(side, from, to)) return error;
+            jumps.emplace_back(static_cast<cell_iterator_t>(from), static_cast<cell_iterator_t>(to));
+            return nullptr;
+        }
+
+        inline char const* parse_side(board_text_cursor_t& cursor, length_t& side) {
+            int value;
+            if (!cursor.number(value)) return "expected the side";
+            if (value < 1 || value > 127) return "side out of range";
+            side = static_cast<length_t>(value);
+            return nullptr;
+        }
+
+        /*! @internal @brief Parses a csv record. @return Returns nullptr, or why the record is invalid.
+        */
+        inline char const* parse_csv_board(board_text_cursor_t& cursor, length_t& side, std::vector<board_builder_t::jump_t>& jumps) {
+            if (auto const error = parse_side(cursor, side)) return error;
+            while (cursor.literal(',')) {
+                int from, to;
+                if (!cursor.number(from)) return "expected a jump source";
+                if (!cursor.literal(',') || !cursor.number(to)) return "expected a jump destination";
+                if (auto const error = add_parsed_jump(side, from, to, jumps)) return error;
+            }
+            return cursor.done() ? nullptr : "expected a jump source";
+        }
+
+        /*! @internal @brief Parses a json record. @return Returns nullptr, or why the record is invalid.
+        */
+        inline char const* parse_json_board(board_text_cursor_t& cursor, length_t& side, std::vector<board_builder_t::jump_t>& jumps, std::vector<std::pair<int, int>>& cells) {
+            if (!cursor.literal('{')) return "expected '{'";
+            auto have_side = false, have_jumps = false;
+            cells.clear();//! @internal the jumps may precede the side
+            do {
+                if (cursor.key("side")) {
+                    if (have_side) return "duplicate side";
+                    if (auto const error = parse_side(cursor, side)) return error;
+                    have_side = true;
+                }
+                else if (cursor.key("jumps")) {
+                    if (have_jumps) return "duplicate jumps";
+                    if (!cursor.literal('[')) return "expected '['";
+                    if (!cursor.literal(']')) {
+                        do {
+                            int from, to;
+                            if (!cursor.literal('[') || !cursor.number(from) || !cursor.literal(',') || !cursor.number(to) || !cursor.literal(']'))
+                                return "expected a [from, to] jump";
+                            cells.emplace_back(from, to);
+                        } while (cursor.literal(','));
+                        if (!cursor.literal(']')) return "expected ']'";
+                    }
+                    have_jumps = true;
+                }
+                else return "expected \"side\" or \"jumps\"";
+            } while (cursor.literal(','));
+            if (!cursor.literal('}')) return "expected '}'";
+            cursor.literal(',');
+            if (!cursor.done()) return "trailing text";
+            if (!have_side) return "missing side";
+            for (auto const& c : cells)
+                if (auto const error = add_parsed_jump(side, c.first, c.second, jumps)) return error;
+            return nullptr;
+        }
+
+        /*! @internal @brief jumps_settle() for the small boards of a library, in O(jumps) without sorting or allocating.
+            @details A table over the cells of the largest board seen so far holds each jump's destination & a state
+            stamped with the record, so starting a record costs nothing instead of clearing the table.
+        */
+        class settle_table_t {
+            std::vector<cell_iterator_t> target;
+            std::vector<std::uint64_t> state;//! @internal base + 0 a source, + 1 on the chain being followed, + 2 settles, below base no jump
+            std::uint64_t base = 0;
+
+        public:
+            bool settles(length_t side, board_builder_t::jump_t const* jumps, std::size_t count) {
+                auto const cells = static_cast<std::size_t>(side) * side;
+                if (state.size() < cells) {
+                    target.resize(cells);
+                    state.resize(cells);
+                }
+                base += 3;
+                for (std::size_t i = 0; i != count; ++i) {
+                    auto const from = static_cast<std::size_t>(jumps[i].first);
+                    if (state[from] >= base) return false;//! @internal two jumps from one cell
+                    state[from] = base;
+                    target[from] = jumps[i].second;
+                }
+                for (std::size_t i = 0; i != count; ++i) {
+                    auto c = static_cast<std::size_t>(jumps[i].first);
+                    for (; state[c] == base; c = static_cast<std::size_t>(target[c])) state[c] = base + 1;
+                    if (state[c] == base + 1) return false;
+                    for (c = static_cast<std::size_t>(jumps[i].first); state[c] == base + 1; c = static_cast<std::size_t>(target[c])) state[c] = base + 2;
+                }
+                return true;
+            }
+        };
+
+        /*! @internal @brief Parses the whole lines of [begin, end).
+        */
+        inline parsed_boards_t parse_board_chunk(char const* begin, char const* end, board_text_format_t format) {
+            parsed_boards_t rc;
+            std::vector<board_builder_t::jump_t> jumps;
+            std::vector<std::pair<int, int>> cells;
+            settle_table_t settle;
+
+            for (auto line = begin; line != end;) {
+                auto const newline = static_cast<char const*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+                auto const line_end = newline ? newline : end;
+                ++rc.lines;
+                board_text_cursor_t cursor(line, line_end);
+                line = newline ? newline + 1 : end;
+
+                auto const first = cursor.peek();
+                if (first == '\0' || first == '#') continue;
+                if (format == board_text_format_t::csv && ((first >= 'a' && first <= 'z') || (first >= 'A' && first <= 'Z'))) continue;//! @internal a header
+                if (format == board_text_format_t::json_lines && (first == '[' || first == ']')) {
+                    cursor.literal(first);
+                    cursor.literal(',');
+                    if (cursor.done()) continue;//! @internal the brackets of an array with one board per line
+                }
+
+                length_t side = 0;
+                jumps.clear();
+                auto error = format == board_text_format_t::csv ? parse_csv_board(cursor, side, jumps) : parse_json_board(cursor, side, jumps, cells);
+                if (!error && !settle.settles(side, jumps.data(), jumps.size())) error = "two jumps from one cell, or a cycle of jumps";
+                if (error) {
+                    rc.errors.push_back({ rc.lines, error });
+                    continue;
+                }
+
+                rc.boards.push_back({ rc.lines, side, rc.jumps.size() / 4, jumps.size() });
+                auto const at = rc.jumps.size();
+                rc.jumps.resize(at + 4 * jumps.size());
+                for (std::size_t i = 0; i != jumps.size(); ++i) {
+                    std::memcpy(rc.jumps.data() + at + 4 * i, &jumps[i].first, 2);
+                    std::memcpy(rc.jumps.data() + at + 4 * i + 2, &jumps[i].second, 2);
+                }
+            }
+            return rc;
+        }
+    }
+
+    /*! @brief Parses a library of boards, one per line, checking every board as board_builder_t would.
+        @details The text is cut into chunks at line ends, which config.threads workers claim & parse in parallel, each
+        with a hand written scanner that neither allocates per token nor throws; the chunks' results are joined in
+        order. An invalid record doesn't stop the parse: it is reported with its line in parsed_boards_t::errors, e.g. a
+        jump breaking a rule of board_builder_t::add_jump(), two jumps from one cell or a cycle of jumps. Blank lines,
+        lines starting with `#` & csv header lines are skipped; json_lines also accepts an array written one board per line.
+    */
+    inline parsed_boards_t parse_boards(char const* text, std::size_t size, board_parse_config_t const& config) {
+        std::vector<std::pair<char const*, char const*>> chunks;
+        for (auto at = text, end = text + size; at != end;) {
+            auto cut = at + std::min(config.chunk_bytes, static_cast<std::size_t>(end - at));
+            if (cut != end) {
+                auto const newline = static_cast<char const*>(std::memchr(cut, '\n', static_cast<std::size_t>(end - cut)));
+                cut = newline ? newline + 1 : end;
+            }
+            chunks.emplace_back(at, cut);
+            at = cut;
+        }
+
+        std::vector<parsed_boards_t> parts(chunks.size());
+        std::atomic<std::size_t> next_chunk{ 0 };
+        auto const worker = [&] {
+            for (std::size_t c; (c = next_chunk.fetch_add(1)) < chunks.size();)
+                parts[c] = detail::parse_board_chunk(chunks[c].first, chunks[c].second, config.format);
+        };
+        std::vector<std::future<void>> workers;
+        for (unsigned t = 1; t < std::min<std::size_t>(std::max(config.threads, 1u), chunks.size()); ++t)
+            workers.push_back(std::async(std::launch::async, worker));
+        worker();
+        for (auto& w : workers) w.get();
+
+        if (parts.empty()) return{};
+        std::size_t jump_bytes = 0, boards = 0;
+        for (auto const& part : parts) jump_bytes += part.jumps.size(), boards += part.boards.size();
+        auto rc = std::move(parts.front());//! @internal the first part needs no renumbering
+        rc.jumps.reserve(jump_bytes);
+        rc.boards.reserve(boards);
+        for (std::size_t c = 1; c != parts.size(); ++c) rc.append(parts[c]);
+        return rc;
+    }
+
+    /*! @brief parse_boards() of a stream, read config.threads chunks at a time.
+        @throws std::runtime_error If the stream fails other than by reaching its end.
+    */
+    inline parsed_boards_t parse_boards(std::istream& is, board_parse_config_t const& config) {
+        parsed_boards_t rc;
+        std::vector<char> block;
+        auto const block_bytes = config.chunk_bytes * std::max(config.threads, 1u);
+        while (is) {
+            auto const carried = block.size();
+            block.resize(carried + block_bytes);
+            is.read(block.data() + carried, static_cast<std::streamsize>(block_bytes));
+            block.resize(carried + static_cast<std::size_t>(is.gcount()));
+            if (is.bad()) throw std::runtime_error("boards: read failed");
+
+            auto whole = block.size();//! @internal up to the last line end, unless the stream is over
+            if (is) {
+                while (whole && block[whole - 1] != '\n') --whole;
+                if (!whole) continue;//! @internal a line longer than the block
+            }
+            rc.append(parse_boards(block.data(), whole, config));
+            block.erase(block.begin(), block.begin() + static_cast<std::ptrdiff_t>(whole));
+        }
+        return rc;
+    }
+}
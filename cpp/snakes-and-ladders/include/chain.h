@@ -0,0 +1,555 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "include\dice_pool.h"
+#include "include\memory_accounting.h"
+#include "renumbering.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    //! A solver table, charged to the_learning_games::memory_component_t::tables.
+    template<typename T>
+    using table_vector_t = the_learning_games::accounted_vector_t<T, the_learning_games::memory_component_t::tables>;
+
+    //! The up to 3 offsets of one roll & its probability.
+    using weighted_roll_t = std::pair<std::array<cell_offset_t, 3>, double>;
+
+    /*! @brief Returns every roll of a the_learning_games::upto3_dice_t with sides sides & its probability.
+    */
+    inline std::vector<weighted_roll_t> upto3_roll_distribution(std::int8_t sides) {
+        if (sides < 1) throw std::logic_error("pre: sides less than one");
+
+        auto const p = 1. / sides;
+        std::vector<weighted_roll_t> rc;
+        for (cell_offset_t r = 1; r < sides; ++r) {
+            rc.push_back({ { r, 0, 0 }, p });
+            rc.push_back({ { sides, r, 0 }, p * p });
+            rc.push_back({ { sides, sides, r }, p * p * p });
+        }
+        rc.push_back({ { 0, 0, 0 }, p * p * p });//! @internal three times sides forfeits the move
+        return rc;
+    }
+
+    /*! @brief Returns every roll of an upto3_dice_t<the_learning_games::pool_dice_t> on distribution & its probability.
+            The highest value of distribution plays the part of sides: it rerolls, 3 times over it forfeits the move.
+    */
+    inline std::vector<weighted_roll_t> upto3_roll_distribution(the_learning_games::dice_distribution_t const& distribution) {
+        if (distribution.min() < 0) throw std::logic_error("pre: negative roll");
+
+        auto const top = distribution.max();
+        auto const p_top = distribution.probability(top);
+        std::vector<weighted_roll_t> rc;
+        for (auto v = distribution.min(); v < top; ++v) {
+            auto const p = distribution.probability(v);
+            if (p == 0.) continue;
+            auto const r = static_cast<cell_offset_t>(v);
+            rc.push_back({ { r, 0, 0 }, p });
+            rc.push_back({ { static_cast<cell_offset_t>(top), r, 0 }, p_top * p });
+            rc.push_back({ { static_cast<cell_offset_t>(top), static_cast<cell_offset_t>(top), r }, p_top * p_top * p });
+        }
+        rc.push_back({ { 0, 0, 0 }, p_top * p_top * p_top });
+        return rc;
+    }
+
+    /*! @brief Returns every roll of a move of a single roll of distribution, e.g. 2d6 without rerolls, & its probability.
+    */
+    inline std::vector<weighted_roll_t> single_roll_distribution(the_learning_games::dice_distribution_t const& distribution) {
+        if (distribution.min() < 0) throw std::logic_error("pre: negative roll");
+
+        std::vector<weighted_roll_t> rc;
+        for (auto v = distribution.min(); v <= distribution.max(); ++v)
+            if (distribution.weight(v))
+                rc.push_back({ { static_cast<cell_offset_t>(v), 0, 0 }, distribution.probability(v) });
+        return rc;
+    }
+
+    /*! @brief The transitions of a single player's move on one board, in compressed sparse rows.
+        @details Row c lists the cells a player on c can end the move on & their probabilities, following
+        game_t::move() exactly: up to 3 steps, stopping on the end cell, then the rule of the cell moved to.
+    */
+    class transition_table_t {
+        table_vector_t<std::uint32_t> row_begin;//! @internal row c is [row_begin[c], row_begin[c + 1])
+        table_vector_t<cell_iterator_t> targets;
+        table_vector_t<double> probabilities;
+
+    public:
+        transition_table_t(board_t const& board, std::vector<weighted_roll_t> const& rolls) {
+            auto const last_cell = static_cast<cell_iterator_t>(board.end() - 1);
+            std::vector<double> row(static_cast<std::size_t>(board.end()));
+            std::vector<cell_iterator_t> touched;//! @internal the cells row may be non zero on, so a row costs its targets, not the board
+
+            row_begin.push_back(0);
+            for (auto c = board.begin(); c != board.end(); ++c) {
+                if (c != last_cell) {
+                    for (auto const& roll : rolls) {
+                        auto position = c;
+                        auto landed = false;
+                        for (auto offset : roll.first) {
+                            landed = landed || board.lands(position, offset);
+                            position = board.advance(position, offset);
+                            if (position == last_cell) break;
+                        }
+                        add_rule_outcomes(board, position, landed, roll.second, row, touched);
+                    }
+                }
+                std::sort(touched.begin(), touched.end());
+                touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+                for (auto target : touched) {
+                    if (row[target] == 0.) continue;
+                    targets.push_back(target);
+                    probabilities.push_back(row[target]);
+                    row[target] = 0.;
+                }
+                touched.clear();
+                row_begin.push_back(static_cast<std::uint32_t>(targets.size()));
+            }
+        }
+
+        /*! @brief Returns this table in the state space of order: row s is the row of `order.cell(s)`, its targets states.
+            @details propagate() & expect() then take & return vectors indexed by state, @see cell_order_t::to_states()
+        */
+        transition_table_t renumbered(cell_order_t const& order) const {
+            if (order.size() != cells()) throw std::logic_error("pre: order doesn't match the table");
+            transition_table_t rc;
+            rc.row_begin.reserve(row_begin.size());
+            rc.targets.reserve(targets.size());
+            rc.probabilities.reserve(probabilities.size());
+            rc.row_begin.push_back(0);
+            for (std::size_t s = 0; s != cells(); ++s) {
+                auto const c = static_cast<std::size_t>(order.cell(static_cast<cell_iterator_t>(s)));
+                for (auto i = row_begin[c]; i != row_begin[c + 1]; ++i) {
+                    rc.targets.push_back(order.state(targets[i]));
+                    rc.probabilities.push_back(probabilities[i]);
+                }
+                rc.row_begin.push_back(static_cast<std::uint32_t>(rc.targets.size()));
+            }
+            return rc;
+        }
+
+        std::size_t cells() const { return row_begin.size() - 1; }//! @brief Returns the number of rows, one per cell.
+        std::size_t row_size(cell_iterator_t c) const { return row_begin[c + 1] - row_begin[c]; }//! @brief Returns the number of cells a move from c can end on.
+
+        /*! @brief Adds the move of a player distributed as from to the distribution to.
+        */
+        void propagate(std::vector<double> const& from, std::vector<double>& to) const {
+            for (std::size_t c = 0; c + 1 < row_begin.size(); ++c) {
+                if (from[c] == 0.) continue;
+                for (auto i = row_begin[c]; i != row_begin[c + 1]; ++i)
+                    to[targets[i]] += from[c] * probabilities[i];
+            }
+        }
+
+        /*! @brief Sets to[c] to the expectation of values over the cell a player on c moves to.
+        */
+        void expect(std::vector<double> const& values, std::vector<double>& to) const {
+            for (std::size_t c = 0; c + 1 < row_begin.size(); ++c) {
+                auto sum = 0.;
+                for (auto i = row_begin[c]; i != row_begin[c + 1]; ++i)
+                    sum += probabilities[i] * values[targets[i]];
+                to[c] = sum;
+            }
+        }
+
+        /*! @brief Calls f(target, probability) for every cell a player on c can end the move on.
+        */
+        template<typename F>
+        void for_each_target(cell_iterator_t c, F&& f) const {
+            for (auto i = row_begin[c]; i != row_begin[c + 1]; ++i)
+                f(targets[i], probabilities[i]);
+        }
+
+    private:
+        transition_table_t() = default;
+
+        static void add_rule_outcomes(board_t const& board, cell_iterator_t position, bool landed, double p, std::vector<double>& row, std::vector<cell_iterator_t>& touched) {
+            auto add = [&](cell_iterator_t target, double q) {
+                row[target] += q;
+                touched.push_back(target);
+            };
+            if (position == board.end() - 1 || !landed || !board.has_rules()) {
+                add(position, p);
+                return;
+            }
+            auto const& rule = board.rule(position);
+            if (rule.action == cell_action_t::bounce_back)
+                add(rule.landing, p);
+            else if (rule.action == cell_action_t::teleport)
+                for (std::uint32_t i = 0; i != rule.span; ++i)
+                    add(board.teleport_landing(rule, i), p / rule.span);
+            else
+                add(position, p);
+        }
+    };
+
+    namespace detail {
+        /*! @internal @brief Returns true if board has extra_turn or skip_turn cells.
+        */
+        inline bool has_turn_order_rules(board_t const& board) {
+            if (!board.has_rules()) return false;
+            for (auto c = board.begin(); c != board.end(); ++c)
+                if (board.rule(c).action == cell_action_t::extra_turn || board.rule(c).action == cell_action_t::skip_turn)
+                    return true;
+            return false;
+        }
+    }
+
+    /*! @brief Returns true if a single player's game on board ends with probability 1 under rolls.
+        @details That holds iff the end is reachable from every cell reachable from the start. Otherwise a simulation of
+        the board may never return, e.g. a single sided dice or a board whose last cells all lead back.
+    */
+    inline bool game_always_ends(board_t const& board, std::vector<weighted_roll_t> const& rolls) {
+        transition_table_t const table(board, rolls);
+        auto const cells = static_cast<std::size_t>(board.end());
+        auto const last_cell = static_cast<cell_iterator_t>(board.end() - 1);
+
+        std::vector<std::vector<cell_iterator_t>> sources(cells);
+        std::vector<char> reached(cells), ends(cells);
+        std::vector<cell_iterator_t> stack{ board.begin() };
+        reached[board.begin()] = 1;
+        while (!stack.empty()) {
+            auto const c = stack.back();
+            stack.pop_back();
+            table.for_each_target(c, [&](cell_iterator_t to, double) {
+                sources[to].push_back(c);
+                if (!reached[to]) {
+                    reached[to] = 1;
+                    stack.push_back(to);
+                }
+            });
+        }
+
+        stack.assign(1, last_cell);
+        ends[last_cell] = 1;
+        while (!stack.empty()) {
+            auto const c = stack.back();
+            stack.pop_back();
+            for (auto from : sources[c]) {
+                if (!ends[from]) {
+                    ends[from] = 1;
+                    stack.push_back(from);
+                }
+            }
+        }
+        for (std::size_t c = 0; c != cells; ++c)
+            if (reached[c] && !ends[c]) return false;
+        return true;
+    }
+
+    /*! @brief Parameters of solve_chain().
+    */
+    struct chain_config_t {
+        player_id_t players = 1;//! Players per game.
+        std::int8_t sides = 6;//! Sides of the upto 3 dice.
+        std::vector<weighted_roll_t> rolls;//! The rolls of a move & their probabilities, if not those of the upto 3 dice of sides.
+        std::uint64_t max_turns = 1 << 16;//! Turns after which the remaining probability is reported as unresolved.
+        double tolerance = 1e-15;//! Stop once less probability than this is left in play.
+        bool renumber = false;//! Propagate in locality_order(), for large boards whose jumps scatter the lookups. Equal up to rounding.
+    };
+
+    /*! @brief The exact distribution of game length & winner, up to floating point rounding.
+    */
+    struct chain_result_t {
+        std::vector<double> length;//! length[t] is the probability that the game ends on turn t, i.e. after t + 1 calls to game_t::move().
+        std::vector<double> wins;//! wins[p] is the probability that the player seated at p wins.
+        double expected_turns = 0;//! Expected number of calls to game_t::move(), comparable to simulation_result_t::turns.
+        double unresolved = 0;//! Probability of games still running after max_turns turns.
+    };
+
+    /*! @brief Solves the Markov chain of a game on a board that may change during the game.
+        @details Players don't interact, so the chain is solved per seat over the cells of a single player, a vector of
+        cells instead of the product of all positions. Seat s makes its k-th move on turn `k * players + s` & takes
+        that turn's version of the schedule, which makes each seat's chain time inhomogeneous: every step propagates the
+        distribution through the precomputed transition_table_t of the version in force. The game ends on the first
+        seat to finish, which combines the per seat finishing times into the length & winner distributions.
+        With config.renumber every table is laid out in the locality_order() of the traces of a few hundred sampled
+        games on the first version, far cheaper than the solve, & the seats start from the state of cell 0; the
+        results don't refer to cells, so nothing needs mapping back.
+        @throws std::logic_error With several players, if a version has extra_turn or skip_turn cells: they break the
+        fixed turn order the solution relies on.
+    */
+    inline chain_result_t solve_chain(board_schedule_t const& schedule, chain_config_t const& config) {
+        if (config.players < 1) throw std::logic_error("pre: player count less than one");
+
+        auto const rolls = config.rolls.empty() ? upto3_roll_distribution(config.sides) : config.rolls;
+        std::vector<transition_table_t> tables;
+        for (std::size_t v = 0; v != schedule.size(); ++v) {
+            auto const& board = schedule.version(v);
+            if (config.players > 1 && detail::has_turn_order_rules(board))
+                throw std::logic_error("pre: turn order rules need a single player");
+            tables.emplace_back(board, rolls);
+        }
+
+        auto const players = static_cast<std::uint64_t>(config.players);
+        auto const cells = static_cast<std::size_t>(schedule.version(0).end());
+        cell_order_t order(cells);
+        if (config.renumber) {
+            order = locality_order(tables[0], sampled_visits(schedule.version(0), 256, config.sides, 0, config.max_turns));
+            for (auto& table : tables) table = table.renumbered(order);
+        }
+        auto const start = static_cast<std::size_t>(order.state(schedule.version(0).begin()));
+        auto const last_cell = static_cast<std::size_t>(order.state(static_cast<cell_iterator_t>(cells - 1)));
+
+        //! @internal finish[s][k] is the probability that seat s first reaches the end on its k-th move.
+        std::vector<std::vector<double>> finish(players);
+        for (std::uint64_t s = 0; s != players; ++s) {
+            std::vector<double> current(cells), next(cells);
+            current[start] = 1.;
+            auto in_play = 1.;
+            for (std::uint64_t k = 0; k * players + s < config.max_turns && in_play >= config.tolerance; ++k) {
+                std::fill(next.begin(), next.end(), 0.);
+                tables[schedule.version_at(k * players + s)].propagate(current, next);
+                finish[s].push_back(next[last_cell]);
+                in_play -= next[last_cell];
+                next[last_cell] = 0.;
+                std::swap(current, next);
+            }
+        }
+
+        chain_result_t rc;
+        rc.wins.resize(players);
+        std::vector<double> survival(players, 1.);//! @internal survival[j] is the probability seat j hasn't finished after its moves so far
+        for (std::uint64_t k = 0; ; ++k) {
+            auto any = false;
+            for (std::uint64_t s = 0; s != players; ++s) {
+                if (k >= finish[s].size()) continue;
+                any = true;
+
+                auto p = finish[s][k];
+                for (std::uint64_t j = 0; j != players; ++j)
+                    if (j != s) p *= survival[j];//! @internal seats before s have made k + 1 moves, seats after it k
+                survival[s] -= finish[s][k];
+
+                auto const turn = k * players + s;
+                if (rc.length.size() <= turn) rc.length.resize(turn + 1);
+                rc.length[turn] = p;
+                rc.wins[s] += p;
+                rc.expected_turns += p * static_cast<double>(turn + 1);
+            }
+            if (!any) break;
+        }
+
+        auto resolved = 0.;
+        for (auto p : rc.length) resolved += p;
+        rc.unresolved = std::max(1. - resolved, 0.);
+        return rc;
+    }
+
+    /*! @brief solve_chain() on a board that doesn't change.
+    */
+    inline chain_result_t solve_chain(board_t const& board, chain_config_t const& config) {
+        return solve_chain(board_schedule_t(board), config);
+    }
+
+    /*! @brief The win probabilities of every player from any mid-game state of a fixed board.
+        @details As in solve_chain() the players don't interact, so a state's win probabilities follow from how long
+        each player still needs from its own cell. The constructor tabulates, per cell, the probability of not having
+        finished after k more moves, until less than tolerance is left on every cell; a query then combines the rows
+        of the players' cells in turn order from the current player, in O(players^2 * moves) without touching the
+        product of all positions, & stops once less than tolerance of the game is left to decide.
+    */
+    class win_probability_model_t {
+        std::size_t moves = 1;//! @internal columns of survival, k = 0 .. moves - 1
+        table_vector_t<double> survival;//! @internal survival[c * moves + k]: still playing after k moves from c
+        double tolerance;
+
+    public:
+        /*! @throws std::logic_error With several players, if board has extra_turn or skip_turn cells.
+        */
+        win_probability_model_t(board_t const& board, player_id_t players, std::int8_t sides = 6, double tolerance = 1e-12, std::size_t max_moves = 1 << 14) :
+            win_probability_model_t(board, players, upto3_roll_distribution(sides), tolerance, max_moves)
+        {}
+
+        /*! @param rolls The rolls of a move & their probabilities, e.g. from single_roll_distribution().
+        */
+        win_probability_model_t(board_t const& board, player_id_t players, std::vector<weighted_roll_t> const& rolls, double tolerance = 1e-12, std::size_t max_moves = 1 << 14) :
+            tolerance(tolerance)
+        {
+            if (players < 1) throw std::logic_error("pre: player count less than one");
+            if (players > 1 && detail::has_turn_order_rules(board)) throw std::logic_error("pre: turn order rules need a single player");
+
+            transition_table_t const table(board, rolls);
+            auto const cells = static_cast<std::size_t>(board.end());
+            auto const last_cell = cells - 1;
+
+            //! @internal columns[k][c]: probability that a player on c is still playing after k moves, by backward induction over k
+            std::vector<std::vector<double>> columns(1, std::vector<double>(cells, 1.));
+            columns[0][last_cell] = 0.;
+            auto left = 1.;
+            while (left >= tolerance && columns.size() < max_moves) {
+                std::vector<double> next(cells);
+                table.expect(columns.back(), next);
+                left = *std::max_element(next.begin(), next.end());
+                columns.push_back(std::move(next));
+            }
+
+            moves = columns.size();
+            survival.resize(cells * moves);
+            for (std::size_t k = 0; k != moves; ++k)
+                for (std::size_t c = 0; c != cells; ++c)
+                    survival[c * moves + k] = columns[k][c];
+        }
+
+        /*! @brief Writes the probability that each player wins to wins.
+            @param positions The cells of all players, by player id.
+            @param current The player to move next.
+            @param wins Receives positions.size() probabilities, by player id.
+        */
+        template<typename Positions, typename Wins>
+        void operator()(Positions const& positions, player_id_t current, Wins& wins) const {
+            auto const players = static_cast<std::size_t>(positions.size());
+            for (std::size_t i = 0; i != players; ++i) wins[i] = 0;
+
+            for (std::size_t k = 1; k != moves; ++k) {
+                auto running = 1.;//! @internal no seat can win later than every seat has finished
+                for (std::size_t i = 0; i != players; ++i) running *= survival[static_cast<std::size_t>(positions[(current + i) % players]) * moves + k - 1];
+                if (running < tolerance) break;
+                for (std::size_t j = 0; j != players; ++j) {
+                    auto const seat = (current + j) % players;
+                    auto const* row = &survival[static_cast<std::size_t>(positions[seat]) * moves];
+                    auto p = row[k - 1] - row[k];//! @internal seat finishes on its k-th move
+                    if (p == 0.) continue;
+                    for (std::size_t i = 0; i != players; ++i) {
+                        if (i == j) continue;
+                        auto const* other = &survival[static_cast<std::size_t>(positions[(current + i) % players]) * moves];
+                        p *= i < j ? other[k] : other[k - 1];//! @internal seats before j have made k moves, seats after it k - 1
+                    }
+                    wins[seat] += p;
+                }
+            }
+        }
+    };
+
+    /*! @brief Solves the Markov chain of a game whose moves draw single cards from a deck, @see game_t::move(Deck&)
+        @details Draws without replacement tie every player's moves to the cards drawn before, so unlike solve_chain()
+        the state is the product of all positions & of the cards left, a count per distinct card. Each turn propagates
+        the probability of every state forward, which is tractable for small decks & few players: the states number
+        (cells - 1)^players times the product of (count + 1) over the distinct cards. The game starts on a freshly
+        shuffled deck, @see the_learning_games::deck_t::reshuffle(), & an exhausted deck is the full deck, as deck_t
+        reshuffles before its next draw.
+        config.sides & config.rolls are not used.
+        @throws std::logic_error If there are more than 2^26 states, on negative cards, or with several players if
+        board has extra_turn or skip_turn cells.
+    */
+    inline chain_result_t solve_deck_chain(board_t const& board, std::vector<int> const& cards, chain_config_t const& config) {
+        if (config.players < 1) throw std::logic_error("pre: player count less than one");
+        if (cards.empty()) throw std::logic_error("pre: empty deck");
+        if (config.players > 1 && detail::has_turn_order_rules(board)) throw std::logic_error("pre: turn order rules need a single player");
+
+        auto values = cards;
+        std::sort(values.begin(), values.end());
+        if (values.front() < 0) throw std::logic_error("pre: negative card");
+        std::vector<std::size_t> counts;
+        for (auto i = values.begin(); i != values.end(); ) {
+            auto const j = std::upper_bound(i, values.end(), *i);
+            counts.push_back(static_cast<std::size_t>(j - i));
+            i = j;
+        }
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        auto const kinds = values.size();
+
+        //! @internal Deck states count the cards of each kind left, in mixed radix.
+        std::vector<std::size_t> place(kinds);
+        std::size_t decks = 1;
+        for (std::size_t k = 0; k != kinds; ++k) {
+            place[k] = decks;
+            decks *= counts[k] + 1;
+            if (decks > (std::size_t{ 1 } << 26)) throw std::logic_error("pre: deck too large for the chain solver");
+        }
+        auto const full = decks - 1;
+
+        //! @internal after[d * kinds + k] is the deck after drawing kind k from d, left[d * kinds + k] the cards of kind k in d.
+        std::vector<std::uint32_t> after(decks * kinds), left(decks * kinds), total(decks);
+        for (std::size_t d = 0; d != decks; ++d) {
+            for (std::size_t k = 0; k != kinds; ++k) {
+                left[d * kinds + k] = static_cast<std::uint32_t>(d / place[k] % (counts[k] + 1));
+                total[d] += left[d * kinds + k];
+                auto const drawn = d - place[k];
+                after[d * kinds + k] = static_cast<std::uint32_t>(left[d * kinds + k] && drawn == 0 ? full : drawn);
+            }
+        }
+
+        std::vector<transition_table_t> tables;
+        for (auto v : values)
+            tables.emplace_back(board, std::vector<weighted_roll_t>{ { { static_cast<cell_offset_t>(v), 0, 0 }, 1. } });
+
+        auto const players = static_cast<std::size_t>(config.players);
+        auto const cells = static_cast<std::size_t>(board.end() - 1);//! @internal cells a running game has players on
+        std::vector<std::size_t> seat_place(players, 1);
+        auto states = decks;
+        for (std::size_t p = 0; p != players; ++p) {
+            seat_place[p] = states;
+            if (states > (std::size_t{ 1 } << 26) / cells) throw std::logic_error("pre: deck too large for the chain solver");
+            states *= cells;
+        }
+
+        chain_result_t rc;
+        rc.wins.resize(players);
+        std::vector<double> current(states), next(states);
+        current[full] = 1.;//! @internal everyone on cell 0 with a full deck
+        auto in_play = 1.;
+        for (std::uint64_t turn = 0; turn < config.max_turns && in_play >= config.tolerance; ++turn) {
+            auto const mover = static_cast<std::size_t>(turn % players);
+            auto finished = 0.;
+            std::fill(next.begin(), next.end(), 0.);
+            for (std::size_t s = 0; s != states; ++s) {
+                if (current[s] == 0.) continue;
+                auto const d = s % decks;
+                auto const cell = s / seat_place[mover] % cells;
+                auto const rest = s - d - cell * seat_place[mover];
+                for (std::size_t k = 0; k != kinds; ++k) {
+                    if (!left[d * kinds + k]) continue;
+                    auto const p = current[s] * left[d * kinds + k] / total[d];
+                    auto const deck = after[d * kinds + k];
+                    tables[k].for_each_target(static_cast<cell_iterator_t>(cell), [&](cell_iterator_t target, double q) {
+                        if (static_cast<std::size_t>(target) == cells) finished += p * q;
+                        else next[rest + static_cast<std::size_t>(target) * seat_place[mover] + deck] += p * q;
+                    });
+                }
+            }
+            rc.length.push_back(finished);
+            rc.wins[mover] += finished;
+            rc.expected_turns += finished * static_cast<double>(turn + 1);
+            in_play -= finished;
+            std::swap(current, next);
+        }
+
+        rc.unresolved = std::max(in_play, 0.);
+        return rc;
+    }
+}
@@ -0,0 +1,151 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <memory_resource>
+#include <tuple>
+#include <vector>
+
+#include "include\statistics.h"
+#include "chain.h"
+#include "simulation.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief Seat win rates & game length of simulate_controlled(), with & without control variates.
+    */
+    struct controlled_result_t {
+        simulation_result_t plain;//! The statistics of the simulated games.
+        std::vector<the_learning_games::control_variate_estimate_t> wins;//! wins[p] estimates the probability that the player seated at p wins.
+        the_learning_games::control_variate_estimate_t turns;//! Estimates the expected number of calls to game_t::move().
+        double solo_turns = 0;//! The exact expected moves of a single player to finish, the mean of every control.
+    };
+
+    namespace detail {
+        /*! @internal @brief A chunk of simulate_controlled(): the plain statistics & the moments of responses & controls.
+        */
+        struct controlled_chunk_t {
+            simulation_result_t plain;
+            the_learning_games::control_variate_moments_t moments;
+
+            controlled_chunk_t& merge(controlled_chunk_t const& other) {
+                plain.merge(other.plain);
+                moments.merge(other.moments);
+                return *this;
+            }
+        };
+
+        /*! @internal @brief Simulates a chunk of games, each seat shadowed by a single player game on the seat's own rolls.
+        */
+        template<typename Dice>
+        controlled_chunk_t simulate_controlled_chunk(board_t const& board, simulation_config_t const& config, Dice& dice, std::uint64_t games, std::uint64_t rule_seed) {
+            auto const players = static_cast<std::size_t>(config.players);
+            controlled_chunk_t rc{ {}, the_learning_games::control_variate_moments_t(players + 1, players) };
+            rc.plain.wins.resize(players);
+            std::vector<std::int64_t> responses(players + 1), controls(players);
+            game_scratch_t scratch(game_t::state_bytes(config.players) + alignof(std::max_align_t) + players * (sizeof(game_t) + game_t::state_bytes(1)), memory_of(config));
+
+            for (std::uint64_t i = 0; i != games; ++i) {
+                auto const game_seed = mix_seed(rule_seed, i);
+                auto const memory = scratch.next();
+                game_t game(board, config.players, game_seed, memory);
+                std::pmr::vector<game_t> shadows(memory);
+                shadows.reserve(players);
+                for (std::size_t p = 0; p != players; ++p) shadows.emplace_back(board, player_id_t{ 1 }, mix_seed(game_seed, p));
+                std::fill(controls.begin(), controls.end(), 0);
+
+                auto turns = std::int64_t{};
+                while (game) {
+                    auto const mover = static_cast<std::size_t>(game.current_player());
+                    auto roll = dice.roll();
+                    game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                    if (shadows[mover]) {
+                        shadows[mover].move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                        ++controls[mover];
+                    }
+                    ++turns;
+                }
+                for (std::size_t p = 0; p != players; ++p) {//! @internal the shadows of the losers play on to their end
+                    while (shadows[p]) {
+                        auto roll = dice.roll();
+                        shadows[p].move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                        ++controls[p];
+                    }
+                }
+
+                auto const winner = static_cast<std::size_t>(game.current_player());
+                rc.plain.turns.add(turns);
+                ++rc.plain.wins[winner];
+                for (std::size_t p = 0; p != players; ++p) responses[p] = p == winner;
+                responses[players] = turns;
+                rc.moments.add(responses.data(), controls.data());
+            }
+            return rc;
+        }
+    }
+
+    /*! @brief Simulates like simulate() & sharpens the seat win rates & the game length with control variates.
+        @details Each seat's moves follow the single player chain of the board whatever the other seats do, turn order
+        rules included, so a single player game fed the seat's own rolls, a shadow, reaches the end after a number of
+        moves whose expectation solve_chain() gives exactly. The shadows of the losers play on after the game on
+        further rolls. With these per seat counts as controls every estimate subtracts its least squares fit to their
+        deviation from the known mean. A seat wins largely because its own shadow was quick & the others' slow, & on
+        10 x 10 boards this about halves the variance of the win rates & of the game length. The shadows keep their own teleport randomness,
+        which only weakens the correlation, never biases the estimates.
+        The extra moves of the shadows roughly double the cost per game, so the games after the first differ from those
+        of simulate() with the same config; the result is still bit identical for any thread count.
+        @param confidence The level of the reported confidence intervals.
+        @throws std::logic_error If the single player chain leaves more than 1e-9 of its games unresolved.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    controlled_result_t simulate_controlled(board_t const& board, simulation_config_t const& config, double confidence = 0.95) {
+        chain_config_t chain_config;
+        chain_config.sides = config.sides;
+        auto const solo = solve_chain(board, chain_config);
+        if (solo.unresolved > 1e-9) throw std::logic_error("pre: single player games don't end with certainty");
+
+        auto const chunks = detail::simulate_chunks<Dice>(config, [&](Dice& dice, std::uint64_t games, std::uint64_t rule_seed) {
+            return detail::simulate_controlled_chunk(board, config, dice, games, rule_seed);
+        });
+
+        controlled_result_t rc;
+        rc.plain = chunks.plain;
+        rc.solo_turns = solo.expected_turns;
+        std::vector<double> const means(static_cast<std::size_t>(config.players), solo.expected_turns);
+        for (player_id_t p = 0; p != config.players; ++p)
+            rc.wins.push_back(chunks.moments.estimate(static_cast<std::size_t>(p), means, confidence));
+        rc.turns = chunks.moments.estimate(static_cast<std::size_t>(config.players), means, confidence);
+        return rc;
+    }
+}
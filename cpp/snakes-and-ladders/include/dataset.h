@@ -0,0 +1,342 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "include\dice.h"
+#include "chain.h"
+#include "simulation.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief What a dataset record is labelled with besides the eventual winner.
+    */
+    enum class dataset_label_t : std::uint8_t {
+        outcome,//! Only the player who went on to win the game.
+        win_probability//! Also every player's win probability from the sampled state, @see win_probability_model_t
+    };
+
+    /*! @brief Parameters of export_dataset().
+        @details The files depend on every field except threads, buffer_bytes & table_bytes.
+    */
+    struct dataset_config_t {
+        std::string path = "snl_dataset";//! Shard i is written to `path-<i>.bin`, i in 5 digits.
+        player_id_t players = 2;//! Players per game.
+        std::uint64_t games = 1 << 20;//! Total number of games to simulate.
+        std::uint64_t games_per_shard = 1 << 18;//! Games per independently seeded shard file.
+        std::vector<std::uint32_t> sample_turns = { 4, 8, 16, 32 };//! Sorted. A game still running after this many calls to game_t::move() is sampled.
+        dataset_label_t label = dataset_label_t::outcome;
+        unsigned threads = 1;//! Worker count, has no influence on the files.
+        std::uint64_t seed = 0;//! Master seed, every shard derives its own dice seed from it.
+        std::int8_t sides = 6;//! Sides of the dice.
+        std::size_t buffer_bytes = 1 << 20;//! Records each worker buffers between writes. Bounds the memory of a run.
+        std::size_t table_bytes = 1 << 26;//! Win probabilities of all states are tabulated if they fit, else computed per sample.
+    };
+
+    /*! @brief The header at the start of every shard file, followed by fixed width records up to the end of the file.
+        @details All fields are little endian. A record is, in order: the turn it was sampled after (uint32), the
+        player to move (uint16), the player who won the game (uint16), the cell of every player by id (int16 each) &
+        for dataset_label_t::win_probability the win probability of every player by id (float32 each).
+    */
+    struct dataset_header_t {
+        char magic[4] = { 'S', 'N', 'L', 'D' };
+        std::uint16_t version = 1;
+        std::uint16_t players = 0;
+        std::uint32_t record_bytes = 0;//! Width of every record.
+        std::uint8_t label = 0;//! A dataset_label_t.
+        std::uint8_t reserved[3] = {};
+        std::uint64_t shard = 0;//! Index of the shard.
+    };
+    static_assert(sizeof(dataset_header_t) == 24, "dataset_header_t must match the file format");
+
+    /*! @brief Summary of an export_dataset() run.
+    */
+    struct dataset_result_t {
+        std::vector<std::string> files;//! The shards written, in shard order.
+        std::uint64_t samples = 0;//! Records written over all shards.
+        std::uint64_t bytes = 0;//! Bytes written over all shards, headers included.
+    };
+
+    /*! @brief Returns the width of a record of a game of players players.
+    */
+    inline std::uint32_t dataset_record_bytes(player_id_t players, dataset_label_t label) {
+        return static_cast<std::uint32_t>(8 + players * sizeof(cell_iterator_t) + (label == dataset_label_t::win_probability ? players * sizeof(float) : 0));
+    }
+
+    namespace detail {
+        /*! @internal @brief Returns the board win probabilities are computed on; a schedule only qualifies with a single version.
+        */
+        inline board_t const& probability_board(board_t const& board) { return board; }
+        inline board_t const& probability_board(board_schedule_t const& schedule) {
+            if (schedule.size() != 1) throw std::logic_error("pre: win probability labels need a fixed board");
+            return schedule.version(0);
+        }
+
+        /*! @internal @brief Win probability labels, looked up in a table of every state when it fits in table_bytes.
+            @details The table holds the win probabilities by seat of the positions in seat order, the player to move
+            first, so one entry serves every rotation. It is filled by threads workers.
+        */
+        class win_probability_labels_t {
+            win_probability_model_t model;
+            std::size_t cells;
+            table_vector_t<float> table;
+
+        public:
+            win_probability_labels_t(board_t const& board, player_id_t players, std::int8_t sides, std::size_t table_bytes, unsigned threads) :
+                model(board, players, sides, 1e-9),
+                cells(static_cast<std::size_t>(board.end()))
+            {
+                auto const seats = static_cast<std::size_t>(players);
+                std::size_t states = 1;
+                for (std::size_t i = 0; i != seats; ++i) {
+                    if (states * cells * seats > table_bytes / sizeof(float)) return;
+                    states *= cells;
+                }
+                table.resize(states * seats);
+
+                std::atomic<std::size_t> next{ 0 };
+                auto const block = std::size_t{ 1024 };
+                auto worker = [&]() {
+                    std::vector<cell_iterator_t> positions(seats);
+                    std::vector<double> wins(seats);
+                    for (auto first = block * next++; first < states; first = block * next++) {
+                        for (auto s = first; s != std::min(first + block, states); ++s) {
+                            auto r = s;
+                            for (auto& p : positions) {
+                                p = static_cast<cell_iterator_t>(r % cells);
+                                r /= cells;
+                            }
+                            model(positions, 0, wins);
+                            std::copy(wins.begin(), wins.end(), table.begin() + s * seats);
+                        }
+                    }
+                };
+                std::vector<std::future<void>> workers;
+                for (auto i = 1u; i < std::max(threads, 1u); ++i)
+                    workers.emplace_back(std::async(std::launch::async, worker));
+                worker();
+                for (auto& w : workers) w.get();
+            }
+
+            //! @param scratch Holds the double precision probabilities when they are computed per sample.
+            template<typename Positions>
+            void operator()(Positions const& positions, player_id_t current, std::vector<float>& wins, std::vector<double>& scratch) const {
+                if (table.empty()) {
+                    model(positions, current, scratch);
+                    std::copy(scratch.begin(), scratch.end(), wins.begin());
+                    return;
+                }
+                auto const seats = positions.size();
+                std::size_t s = 0;
+                for (auto i = seats; i--; )
+                    s = s * cells + static_cast<std::size_t>(positions[(current + i) % seats]);
+                for (std::size_t i = 0; i != seats; ++i)
+                    wins[(current + i) % seats] = table[s * seats + i];
+            }
+        };
+
+        /*! @internal @brief Appends records to a shard file through a fixed size buffer.
+        */
+        class shard_writer_t {
+            std::ofstream out;
+            std::string file;
+            std::vector<char> buffer;
+            std::size_t used = 0;
+
+        public:
+            std::uint64_t records = 0;
+            std::uint64_t bytes = 0;
+
+            shard_writer_t(std::string file, dataset_header_t const& header, std::size_t buffer_bytes) :
+                out(file, std::ios::binary | std::ios::trunc),
+                file(std::move(file)),
+                buffer(std::max<std::size_t>(buffer_bytes, header.record_bytes))
+            {
+                write(reinterpret_cast<char const*>(&header), sizeof(header));
+            }
+
+            //! Returns space for one record of the given width, flushing the buffer if it is full.
+            char* record(std::size_t width) {
+                if (used + width > buffer.size()) flush();
+                auto rc = buffer.data() + used;
+                used += width;
+                ++records;
+                return rc;
+            }
+
+            //! Flushes the buffer unless size more bytes fit, so the next records stay in place until then.
+            void reserve(std::size_t size) {
+                if (used + size > buffer.size()) flush();
+            }
+
+            void flush() {
+                write(buffer.data(), used);
+                used = 0;
+            }
+
+        private:
+            void write(char const* data, std::size_t size) {
+                out.write(data, static_cast<std::streamsize>(size));
+                if (!out) throw std::runtime_error("dataset: cannot write " + file);
+                bytes += size;
+            }
+        };
+
+        /*! @internal @brief Simulates the games of one shard & writes their samples.
+            @details The samples of a game are held back until it ends, as they are labelled with its winner.
+        */
+        template<typename Dice, typename Board>
+        void export_shard(Board const& board, dataset_config_t const& config, win_probability_labels_t const* model,
+            Dice& dice, std::uint64_t games, std::uint64_t rule_seed, shard_writer_t& writer) {
+            auto const players = static_cast<std::size_t>(config.players);
+            auto const width = dataset_record_bytes(config.players, config.label);
+            std::vector<char*> pending;
+            std::vector<float> wins(players);
+            std::vector<double> scratch(players);
+
+            for (std::uint64_t i = 0; i != games; ++i) {
+                game_t game(board, config.players, mix_seed(rule_seed, i));
+                std::uint32_t turns = 0;
+                auto next_sample = config.sample_turns.begin();
+                pending.clear();
+                writer.reserve(config.sample_turns.size() * width);
+                while (game) {
+                    for (; next_sample != config.sample_turns.end() && *next_sample == turns; ++next_sample) {
+                        auto record = writer.record(width);
+                        auto const current = static_cast<std::uint16_t>(game.current_player());
+                        std::memcpy(record, &turns, 4);
+                        std::memcpy(record + 4, &current, 2);
+                        std::memcpy(record + 8, game.all_player_positions().data(), players * sizeof(cell_iterator_t));
+                        if (model) {
+                            (*model)(game.all_player_positions(), game.current_player(), wins, scratch);
+                            std::memcpy(record + 8 + players * sizeof(cell_iterator_t), wins.data(), players * sizeof(float));
+                        }
+                        pending.push_back(record + 6);
+                    }
+                    if (next_sample == config.sample_turns.end()) break;
+                    auto roll = dice.roll();
+                    game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                    ++turns;
+                }
+                if (pending.empty()) continue;
+                while (game) {//! @internal play on to the winner without sampling
+                    auto roll = dice.roll();
+                    game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                }
+                auto const winner = static_cast<std::uint16_t>(game.current_player());
+                for (auto label : pending) std::memcpy(label, &winner, 2);
+            }
+        }
+    }
+
+    /*! @brief Writes labelled mid-game states of config.games simulated games to sharded binary files.
+        @details Every game is sampled after each of config.sample_turns moves it is still running at. The games are cut
+        into shards of config.games_per_shard, each a file of its own with a Dice seeded from `(config.seed, i)` like
+        the chunks of simulate(), so the files are identical for any thread count. The config.threads workers claim
+        whole shards; each holds a single config.buffer_bytes buffer & the samples of the game in play, so memory
+        doesn't grow with the number of games. A game's records wait in the buffer for its winner, so they are never
+        split across a flush.
+        Win probability labels come from one win_probability_model_t shared by all workers, tabulated over every state
+        up front if the table fits config.table_bytes.
+        Board is a board_t, or a board_schedule_t for outcome labels.
+        @throws std::logic_error For win probability labels with several players on a board with extra_turn or skip_turn cells.
+        @throws std::runtime_error If a file can't be written.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>, typename Board>
+    dataset_result_t export_dataset(Board const& board, dataset_config_t const& config) {
+        if (config.players < 1) throw std::logic_error("pre: player count less than one");
+        if (config.games_per_shard == 0) throw std::logic_error("pre: shard size is zero");
+        if (!std::is_sorted(config.sample_turns.begin(), config.sample_turns.end())) throw std::logic_error("pre: sample turns not sorted");
+
+        std::unique_ptr<detail::win_probability_labels_t> model;
+        if (config.label == dataset_label_t::win_probability)
+            model.reset(new detail::win_probability_labels_t(detail::probability_board(board), config.players, config.sides, config.table_bytes, config.threads));
+
+        auto const shards = std::max<std::uint64_t>((config.games + config.games_per_shard - 1) / config.games_per_shard, 1);
+        auto const width = dataset_record_bytes(config.players, config.label);
+        //! @internal a game's samples must fit the buffer together, see detail::export_shard()
+        auto const buffer_bytes = std::max<std::size_t>(config.buffer_bytes, config.sample_turns.size() * width);
+
+        dataset_result_t rc;
+        rc.files.resize(shards);
+        std::vector<std::uint64_t> samples(shards), bytes(shards);
+        std::atomic<std::uint64_t> next_shard{ 0 };
+
+        auto worker = [&]() {
+            for (auto shard = next_shard++; shard < shards; shard = next_shard++) {
+                auto const first_game = shard * config.games_per_shard;
+                auto const games = std::min(config.games_per_shard, config.games - std::min(first_game, config.games));
+                auto const shard_seed = detail::mix_seed(config.seed, shard);
+                Dice dice(config.sides, shard_seed);
+
+                char suffix[32];//! @internal "-", up to 20 digits of a 64 bit shard & ".bin"
+                std::snprintf(suffix, sizeof(suffix), "-%05llu.bin", static_cast<unsigned long long>(shard));
+                rc.files[shard] = config.path + suffix;
+
+                dataset_header_t header;
+                header.players = static_cast<std::uint16_t>(config.players);
+                header.record_bytes = width;
+                header.label = static_cast<std::uint8_t>(config.label);
+                header.shard = shard;
+
+                detail::shard_writer_t writer(rc.files[shard], header, buffer_bytes);
+                detail::export_shard(board, config, model.get(), dice, games, shard_seed, writer);
+                writer.flush();
+                samples[shard] = writer.records;
+                bytes[shard] = writer.bytes;
+            }
+        };
+
+        std::vector<std::future<void>> workers;
+        for (auto i = 1u; i < std::max(config.threads, 1u); ++i)
+            workers.emplace_back(std::async(std::launch::async, worker));
+        worker();
+        for (auto& w : workers) w.get();
+
+        for (std::uint64_t shard = 0; shard != shards; ++shard) {
+            rc.samples += samples[shard];
+            rc.bytes += bytes[shard];
+        }
+        return rc;
+    }
+}
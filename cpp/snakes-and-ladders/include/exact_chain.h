@@ -0,0 +1,515 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "include\exact.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief Parameters of solve_chain_exact().
+    */
+    struct exact_chain_config_t {
+        player_id_t players = 1;//! Players per game.
+        std::int8_t sides = 6;//! Sides of the upto 3 dice.
+        unsigned threads = 1;//! Primes solved concurrently, each needing its own working memory.
+        std::size_t primes_per_round = 8;//! Primes added between two attempts at reconstruction.
+        std::size_t max_primes = 1 << 14;//! Give up beyond this many primes.
+        std::size_t memory_per_prime = std::size_t{ 1 } << 30;//! Bytes of working memory one prime may use.
+        std::size_t horizon = 128;//! Turns of the length distribution, see solve_length_exact().
+    };
+
+    /*! @brief Exact game length & winner probabilities.
+    */
+    struct exact_chain_result_t {
+        std::vector<the_learning_games::big_rational_t> length;//! length[t] is the probability that the game ends on turn t, for t below the horizon.
+        the_learning_games::big_rational_t expected_turns;//! Expected number of calls to game_t::move().
+        std::vector<the_learning_games::big_rational_t> wins;//! wins[p] is the probability that the player seated at p wins.
+        std::size_t primes = 0;//! The number of primes the result was reconstructed from.
+    };
+
+    namespace detail {
+        /*! @internal @brief The chain of a single seat: the cells it moves between & the integer weights of its moves.
+            @details Shared by the product system of solve_chain_exact() & the per seat propagation of
+            solve_length_exact(); the players only matter to reject turn order rules, which couple the seats.
+        */
+        struct exact_moves_t {
+            std::size_t players;
+            std::size_t cells;//! @internal Cells a player can be on before the game ends, i.e. all but the end cell.
+            std::uint64_t denominator;//! @internal Every transition probability is a weight / denominator.
+            std::vector<std::vector<std::pair<std::uint32_t, std::uint64_t>>> moves;//! @internal moves[a] lists (a', weight), a' == cells is the end.
+
+            exact_moves_t(board_t const& board, std::size_t players, std::int8_t sides) :
+                players(players),
+                cells(static_cast<std::size_t>(board.end() - 1))
+            {
+                if (sides < 1) throw std::logic_error("pre: sides less than one");
+                auto const last_cell = static_cast<cell_iterator_t>(board.end() - 1);
+                std::uint64_t const s = static_cast<std::uint64_t>(sides);
+
+                std::uint64_t spans = 1;//! @internal lcm of the teleport spans, so that every share is integral
+                if (board.has_rules())
+                    for (auto c = board.begin(); c != last_cell; ++c)
+                        if (board.rule(c).action == cell_action_t::teleport) {
+                            spans = spans / std::gcd<std::uint64_t>(spans, board.rule(c).span) * board.rule(c).span;
+                            if (spans > (std::uint64_t{ 1 } << 32)) throw std::logic_error("pre: teleport spans too diverse for the exact solver");
+                        }
+                denominator = s * s * s * spans;
+
+                std::vector<std::pair<std::array<cell_offset_t, 3>, std::uint64_t>> rolls;
+                for (cell_offset_t r = 1; r < sides; ++r) {
+                    rolls.push_back({ { r, 0, 0 }, s * s * spans });
+                    rolls.push_back({ { sides, r, 0 }, s * spans });
+                    rolls.push_back({ { sides, sides, r }, spans });
+                }
+                rolls.push_back({ { 0, 0, 0 }, spans });
+
+                moves.resize(cells);
+                std::vector<std::uint64_t> row(cells + 1);
+                for (std::size_t a = 0; a != cells; ++a) {
+                    for (auto const& roll : rolls) {
+                        auto position = static_cast<cell_iterator_t>(a);
+                        auto landed = false;
+                        for (auto offset : roll.first) {
+                            landed = landed || board.lands(position, offset);
+                            position = board.advance(position, offset);
+                            if (position == last_cell) break;
+                        }
+                        if (position == last_cell || !landed || !board.has_rules()) {
+                            row[position] += roll.second;
+                            continue;
+                        }
+                        auto const& rule = board.rule(position);
+                        if (rule.action == cell_action_t::extra_turn || rule.action == cell_action_t::skip_turn) {
+                            if (players > 1) throw std::logic_error("pre: turn order rules need a single player");
+                            row[position] += roll.second;
+                        }
+                        else if (rule.action == cell_action_t::bounce_back)
+                            row[rule.landing] += roll.second;
+                        else if (rule.action == cell_action_t::teleport)
+                            for (std::uint32_t i = 0; i != rule.span; ++i)
+                                row[board.teleport_landing(rule, i)] += roll.second / rule.span;
+                        else
+                            row[position] += roll.second;
+                    }
+                    for (std::size_t target = 0; target != row.size(); ++target)
+                        if (row[target]) {
+                            moves[a].emplace_back(static_cast<std::uint32_t>(target), row[target]);
+                            row[target] = 0;
+                        }
+                }
+            }
+        };
+
+        /*! @internal @brief The prime independent part of the exact solver: states, transitions & the order of elimination.
+            @details A state is the cells of all players in turn order, the player to move first. A move of that player
+            from a to a' leads to the state rotated by one with a' last. The expected turns y & the win probabilities
+            w_i of the player i seats after the mover satisfy, per state, a linear equation over the states it leads to.
+            Eliminating states in order of decreasing total progress resolves every forward reference, so only the
+            states a backward move (snake, bounce or teleport) leads to remain unknown: each state becomes an affine
+            form in those, a dense system over them is solved & the start state's form is evaluated.
+        */
+        class exact_chain_system_t : exact_moves_t {
+            std::size_t states;
+            std::vector<std::uint32_t> order;//! @internal States by decreasing total progress, rotations adjacent.
+            std::vector<std::int64_t> unknown;//! @internal unknown[s] is the index of s among the unknown states, or -1.
+            std::size_t unknowns = 0;
+
+        public:
+            exact_chain_system_t(board_t const& board, std::size_t players, std::int8_t sides, std::size_t memory_per_prime) :
+                exact_moves_t(board, players, sides)
+            {
+                std::vector<bool> backward(cells);
+                for (std::size_t a = 0; a != cells; ++a)
+                    for (auto const& move : moves[a])
+                        if (move.first < a) backward[move.first] = true;
+
+                states = 1;
+                for (std::size_t i = 0; i != players; ++i) {
+                    if (states > (std::size_t{ 1 } << 26) / cells) throw std::logic_error("pre: board too large for the exact solver");
+                    states *= cells;
+                }
+
+                auto const last = states / cells;//! @internal place value of the last player's cell
+                unknown.assign(states, -1);
+                for (std::size_t s = 0; s != states; ++s)
+                    if (backward[s / last]) unknown[s] = static_cast<std::int64_t>(unknowns++);
+
+                auto const components = std::max<std::size_t>(players - 1, 1);
+                if (static_cast<double>(states) * components * (unknowns * components + 1) * sizeof(std::uint32_t) > static_cast<double>(memory_per_prime))
+                    throw std::logic_error("pre: board too large for the exact solver");
+
+                std::vector<std::size_t> progress(states);
+                for (std::size_t s = 0; s != states; ++s)
+                    for (auto r = s; r; r /= cells) progress[s] += r % cells;
+                std::vector<bool> placed(states);
+                std::vector<std::uint32_t> by_progress(states);
+                std::iota(by_progress.begin(), by_progress.end(), 0);
+                std::stable_sort(by_progress.begin(), by_progress.end(), [&](std::uint32_t a, std::uint32_t b) { return progress[a] > progress[b]; });
+                for (auto s : by_progress) {
+                    for (auto t = s; !placed[t]; t = static_cast<std::uint32_t>(rotate(t, t % cells))) {
+                        placed[t] = true;
+                        order.push_back(t);
+                    }
+                }
+            }
+
+            /*! @internal @brief Returns the residues of the expected turns & of every seat's win probability modulo m,
+                or nothing if the system is singular modulo m.
+            */
+            std::vector<std::uint32_t> solve(the_learning_games::modulus_t const& m) const {
+                std::vector<std::uint32_t> rc(1);
+                if (!solve_system(m, true, rc)) return{};
+                if (players == 1) {
+                    rc.push_back(1);
+                    return rc;
+                }
+                std::vector<std::uint32_t> wins(players - 1);
+                if (!solve_system(m, false, wins)) return{};
+                auto last = 1u;
+                for (auto w : wins) last = m.sub(last, w);
+                rc.insert(rc.end(), wins.begin(), wins.end());
+                rc.push_back(last);
+                return rc;
+            }
+
+        private:
+            /*! @internal @brief The state after the mover of s moves to cell to.
+            */
+            std::size_t rotate(std::size_t s, std::size_t to) const {
+                return s / cells + to * (states / cells);
+            }
+
+            /*! @internal @brief Solves the expected turns, or the win probabilities of all seats but the last, of the start state.
+                @details Win probabilities use w_last = 1 - the sum of the others, which holds as the games end with certainty.
+                @return Returns false if the system is singular modulo m.
+            */
+            bool solve_system(the_learning_games::modulus_t const& m, bool turns, std::vector<std::uint32_t>& result) const {
+                using the_learning_games::axpy_mod;
+
+                auto const components = turns ? std::size_t{ 1 } : players - 1;
+                auto const width = unknowns * components + 1;//! @internal slot 0 is the constant, slot 1 + u * components + c unknown (u, c)
+                auto const inverse_denominator = m.reduce(denominator) ? m.inverse(m.reduce(denominator)) : 0;
+                if (!inverse_denominator) return false;
+
+                std::vector<std::uint32_t> forms(states * components * width);
+                auto form = [&](std::size_t s, std::size_t c) { return forms.data() + (s * components + c) * width; };
+
+                //! @internal Adds coef times component c of state x to the form f. c == components is the complement of the others.
+                auto add_reference = [&](std::uint32_t* f, std::uint32_t coef, std::size_t x, std::size_t c) {
+                    if (c == components) {
+                        f[0] = m.add(f[0], coef);
+                        coef = m.sub(0, coef);
+                    }
+                    for (auto i = c == components ? 0 : c; i != (c == components ? components : c + 1); ++i) {
+                        if (unknown[x] >= 0) {
+                            auto& slot = f[1 + static_cast<std::size_t>(unknown[x]) * components + i];
+                            slot = m.add(slot, coef);
+                        }
+                        else axpy_mod(f, form(x, i), width, coef, m.p);
+                    }
+                };
+                auto shift = [&](std::size_t c) { return turns ? c : (c == 0 ? players - 1 : c - 1); };
+
+                std::vector<std::size_t> orbit;
+                std::vector<std::uint32_t> a, b;//! @internal (I - M) of the orbit, & its right hand sides
+                for (std::size_t i = 0; i != order.size(); i += orbit.size()) {
+                    orbit.clear();
+                    for (auto t = order[i]; orbit.empty() || t != orbit.front(); t = static_cast<std::uint32_t>(rotate(t, t % cells))) orbit.push_back(t);
+                    auto const n = orbit.size() * components;
+                    a.assign(n * n, 0);
+                    b.assign(n * width, 0);
+                    for (std::size_t row = 0; row != n; ++row) a[row * n + row] = 1;
+
+                    for (std::size_t j = 0; j != orbit.size(); ++j) {
+                        auto const t = orbit[j];
+                        auto const mover = t % cells;
+                        for (std::size_t c = 0; c != components; ++c) {
+                            auto const row = j * components + c;
+                            auto* g = b.data() + row * width;
+                            if (turns) g[0] = 1;
+                            for (auto const& move : moves[mover]) {
+                                auto const coef = m.mul(m.reduce(move.second), inverse_denominator);
+                                if (move.first == cells) {
+                                    if (!turns && c == 0) g[0] = m.add(g[0], coef);
+                                    continue;
+                                }
+                                auto const x = rotate(t, move.first);
+                                auto const target = shift(c);
+                                if (move.first != mover || unknown[x] >= 0) {
+                                    add_reference(g, coef, x, target);
+                                    continue;
+                                }
+                                auto const k = static_cast<std::size_t>(std::find(orbit.begin(), orbit.end(), x) - orbit.begin());
+                                if (target == components) {//! @internal complement within the orbit
+                                    g[0] = m.add(g[0], coef);
+                                    for (std::size_t other = 0; other != components; ++other)
+                                        a[row * n + k * components + other] = m.add(a[row * n + k * components + other], coef);
+                                }
+                                else a[row * n + k * components + target] = m.sub(a[row * n + k * components + target], coef);
+                            }
+                        }
+                    }
+
+                    if (!gauss_jordan(m, a, b, n, width)) return false;
+                    for (std::size_t j = 0; j != orbit.size(); ++j)
+                        for (std::size_t c = 0; c != components; ++c)
+                            std::copy_n(b.data() + (j * components + c) * width, width, form(orbit[j], c));
+                }
+
+                //! @internal Every unknown equals its own form: (I - coefficients) u = constant.
+                auto const k = width - 1;
+                std::vector<std::uint32_t> system(k * width);
+                for (std::size_t s = 0; s != states; ++s) {
+                    if (unknown[s] < 0) continue;
+                    for (std::size_t c = 0; c != components; ++c) {
+                        auto const row = static_cast<std::size_t>(unknown[s]) * components + c;
+                        auto const* f = form(s, c);
+                        auto* r = system.data() + row * width;
+                        for (std::size_t l = 0; l != k; ++l) r[l] = m.sub(l == row ? 1 : 0, f[1 + l]);
+                        r[k] = f[0];
+                    }
+                }
+                if (!eliminate(m, system, k)) return false;
+
+                for (std::size_t c = 0; c != components; ++c) {
+                    auto const* f = form(0, c);
+                    auto value = f[0];
+                    for (std::size_t l = 0; l != k; ++l) value = m.add(value, m.mul(f[1 + l], system[l * width + k]));
+                    result[c] = value;
+                }
+                return true;
+            }
+
+            /*! @internal @brief Solves a x = b for the n x n matrix a & n right hand side vectors of the given width in place.
+            */
+            static bool gauss_jordan(the_learning_games::modulus_t const& m, std::vector<std::uint32_t>& a, std::vector<std::uint32_t>& b, std::size_t n, std::size_t width) {
+                for (std::size_t col = 0; col != n; ++col) {
+                    auto pivot = col;
+                    while (pivot != n && a[pivot * n + col] == 0) ++pivot;
+                    if (pivot == n) return false;
+                    if (pivot != col) {
+                        std::swap_ranges(a.begin() + pivot * n, a.begin() + pivot * n + n, a.begin() + col * n);
+                        std::swap_ranges(b.begin() + pivot * width, b.begin() + pivot * width + width, b.begin() + col * width);
+                    }
+                    auto const inverse = m.inverse(a[col * n + col]);
+                    for (std::size_t l = 0; l != n; ++l) a[col * n + l] = m.mul(a[col * n + l], inverse);
+                    for (std::size_t l = 0; l != width; ++l) b[col * width + l] = m.mul(b[col * width + l], inverse);
+                    for (std::size_t row = 0; row != n; ++row) {
+                        auto const factor = a[row * n + col];
+                        if (row == col || factor == 0) continue;
+                        for (std::size_t l = 0; l != n; ++l) a[row * n + l] = m.sub(a[row * n + l], m.mul(factor, a[col * n + l]));
+                        the_learning_games::axpy_mod(b.data() + row * width, b.data() + col * width, width, m.sub(0, factor), m.p);
+                    }
+                }
+                return true;
+            }
+
+            /*! @internal @brief Solves the k x k system whose rows of width k + 1 end in the right hand side, in place.
+                Afterwards row l ends in the value of unknown l.
+            */
+            static bool eliminate(the_learning_games::modulus_t const& m, std::vector<std::uint32_t>& system, std::size_t k) {
+                auto const width = k + 1;
+                for (std::size_t col = 0; col != k; ++col) {
+                    auto pivot = col;
+                    while (pivot != k && system[pivot * width + col] == 0) ++pivot;
+                    if (pivot == k) return false;
+                    if (pivot != col)
+                        std::swap_ranges(system.begin() + pivot * width, system.begin() + pivot * width + width, system.begin() + col * width);
+                    auto* p = system.data() + col * width;
+                    auto const inverse = m.inverse(p[col]);
+                    for (auto l = col; l != width; ++l) p[l] = m.mul(p[l], inverse);
+                    for (auto row = col + 1; row != k; ++row) {
+                        auto* r = system.data() + row * width;
+                        if (r[col]) the_learning_games::axpy_mod(r + col, p + col, width - col, m.sub(0, r[col]), m.p);
+                    }
+                }
+                for (auto col = k; col--;) {//! @internal back substitution
+                    auto const value = system[col * width + k];
+                    for (std::size_t row = 0; row != col; ++row) {
+                        auto& r = system[row * width + k];
+                        r = m.sub(r, m.mul(system[row * width + col], value));
+                    }
+                }
+                return true;
+            }
+        };
+    }
+
+    /*! @brief The exact probabilities that a game ends on each of its first config.horizon turns.
+        @details rc[t] is the probability that the game ends on turn t, i.e. after t + 1 calls to game_t::move(), as
+        chain_result_t::length. Players don't interact, so like solve_chain() this works per seat: the integer counts
+        of a single seat's ways to each cell are propagated move by move, giving the ways F[k] to finish on move k + 1
+        & S[k] to survive k moves, over denominator^(k + 1) & denominator^k. Turn k * players + s ends the game when
+        seat s finishes on its move k + 1, the seats before it survive k + 1 moves & those after it k moves. Work
+        grows with the cells times the digits, i.e. the horizon squared, but not with cells^players, so any board
+        & any number of players will do.
+        @throws std::logic_error If the board has extra_turn or skip_turn cells with several players.
+    */
+    inline std::vector<the_learning_games::big_rational_t> solve_length_exact(board_t const& board, exact_chain_config_t const& config) {
+        using the_learning_games::big_uint_t;
+        if (config.players < 1) throw std::logic_error("pre: player count less than one");
+        if (config.horizon == 0) return{};
+
+        auto const players = static_cast<std::size_t>(config.players);
+        detail::exact_moves_t const chain(board, players, config.sides);
+        big_uint_t const denominator{ chain.denominator };
+
+        auto const steps = (config.horizon - 1) / players + 1;
+        std::vector<big_uint_t> ways(chain.cells), next(chain.cells), finished, surviving{ big_uint_t{ 1 } };
+        ways[0] = 1;
+        for (std::size_t k = 0; k != steps; ++k) {
+            big_uint_t ended;
+            for (std::size_t a = 0; a != chain.cells; ++a) {
+                if (ways[a].is_zero()) continue;
+                for (auto const& move : chain.moves[a]) {
+                    auto& target = move.first == chain.cells ? ended : next[move.first];
+                    target = target + ways[a] * big_uint_t{ move.second };
+                }
+            }
+            ways.swap(next);
+            std::fill(next.begin(), next.end(), big_uint_t{});
+            surviving.push_back(surviving.back() * denominator - ended);
+            finished.push_back(std::move(ended));
+        }
+
+        auto const power = [](big_uint_t base, std::size_t e) {
+            big_uint_t rc{ 1 };
+            for (; e; e >>= 1, base = base * base)
+                if (e & 1) rc = rc * base;
+            return rc;
+        };
+        std::vector<std::pair<std::uint32_t, std::size_t>> factors;//! @internal the primes of the denominator & their multiplicity
+        auto d = chain.denominator;
+        for (std::uint64_t p = 2; p * p <= d; ++p)
+            for (; d % p == 0; d /= p)
+                if (factors.empty() || factors.back().first != p) factors.emplace_back(static_cast<std::uint32_t>(p), 1);
+                else ++factors.back().second;
+        if (d > 1) factors.emplace_back(static_cast<std::uint32_t>(d), 1);
+
+        std::vector<the_learning_games::big_rational_t> rc(config.horizon);
+        for (std::size_t t = 0; t != config.horizon; ++t) {
+            auto const k = t / players, s = t % players;
+            auto& p = rc[t];
+            p.numerator = finished[k] * power(surviving[k + 1], s) * power(surviving[k], players - 1 - s);
+            if (p.numerator.is_zero()) continue;
+            auto const e = (k + 1) * (s + 1) + k * (players - 1 - s);
+            for (auto const& f : factors) {
+                big_uint_t const prime{ f.first };
+                auto left = e * f.second;
+                for (big_uint_t quotient, remainder; left && p.numerator.mod(f.first) == 0; --left) {
+                    divide(p.numerator, prime, quotient, remainder);
+                    p.numerator = std::move(quotient);
+                }
+                p.denominator = p.denominator * power(prime, left);
+            }
+        }
+        return rc;
+    }
+
+    /*! @brief Solves the chain of solve_chain() exactly, over the rationals.
+        @details The linear system of the product chain is solved modulo a growing set of primes below 2^31, several at
+        a time on config.threads workers, with the bulk of the work in SIMD friendly the_learning_games::axpy_mod()
+        loops. The residues are combined by Chinese remaindering & every round of config.primes_per_round primes the
+        results are rationally reconstructed. A result is returned once a whole further round of primes reconstructs
+        to the same rationals, so a wrong answer requires every one of those primes to conspire against it.
+        Work & memory grow with the number of states, cells^players, times the states a snake, bounce or teleport
+        leads back to, & the digits of the result grow with them; think 1 player on any board, or 2 players on boards
+        up to about 7 x 7 in seconds. Unlike the length, the mean & the winner are sums over all turns of products of
+        the seats' survival; as rationals they are what the product chain computes, so only the length distribution,
+        from solve_length_exact(), is available for several players on large boards.
+        @throws std::logic_error If the chain is too large for config.memory_per_prime, or has extra_turn or
+        skip_turn cells with several players.
+        @throws std::runtime_error If the games don't end with certainty or config.max_primes are not enough.
+    */
+    inline exact_chain_result_t solve_chain_exact(board_t const& board, exact_chain_config_t const& config) {
+        if (config.players < 1) throw std::logic_error("pre: player count less than one");
+        if (config.primes_per_round == 0) throw std::logic_error("pre: no primes per round");
+
+        detail::exact_chain_system_t const system(board, static_cast<std::size_t>(config.players), config.sides, config.memory_per_prime);
+        auto const outputs = 1 + static_cast<std::size_t>(config.players);
+
+        std::vector<the_learning_games::crt_accumulator_t> accumulators(outputs);
+        std::vector<the_learning_games::big_rational_t> previous, current(outputs);
+        auto stable = false;
+        std::size_t used = 0, tried = 0;
+
+        while (!stable) {
+            if (tried >= config.max_primes) throw std::runtime_error("exact solver: no stable result within max_primes");
+            auto const primes = the_learning_games::modular_primes(config.primes_per_round, tried);
+            tried += primes.size();
+
+            std::vector<std::vector<std::uint32_t>> residues(primes.size());
+            std::atomic<std::size_t> next{ 0 };
+            auto worker = [&]() {
+                for (auto i = next++; i < primes.size(); i = next++)
+                    residues[i] = system.solve(the_learning_games::modulus_t{ primes[i] });
+            };
+            std::vector<std::future<void>> workers;
+            for (auto i = 1u; i < std::max(config.threads, 1u); ++i)
+                workers.emplace_back(std::async(std::launch::async, worker));
+            worker();
+            for (auto& w : workers) w.get();
+
+            auto added = false;
+            for (std::size_t i = 0; i != primes.size(); ++i) {
+                if (residues[i].empty()) continue;//! @internal the system is singular modulo this prime
+                for (std::size_t o = 0; o != outputs; ++o) accumulators[o].add(residues[i][o], primes[i]);
+                ++used;
+                added = true;
+            }
+            if (!added) throw std::runtime_error("exact solver: singular chain, some games never end");
+
+            auto reconstructed = true;
+            for (std::size_t o = 0; o != outputs && reconstructed; ++o)
+                reconstructed = the_learning_games::rational_reconstruction(accumulators[o].value(), accumulators[o].modulus(), current[o]);
+            stable = reconstructed && current == previous;
+            if (reconstructed) previous = current;
+            else previous.clear();
+        }
+
+        exact_chain_result_t rc;
+        rc.length = solve_length_exact(board, config);
+        rc.expected_turns = current[0];
+        rc.wins.assign(current.begin() + 1, current.end());
+        rc.primes = used;
+        return rc;
+    }
+}
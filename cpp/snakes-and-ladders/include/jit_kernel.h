@@ -0,0 +1,287 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <vector>
+
+#include "include\jit.h"
+#include "simulation.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief The state a game_kernel_t resumes from & leaves behind. The layout is baked into the generated code.
+    */
+    struct kernel_context_t {
+        std::int8_t const* rolls;//! The moves to play, 4 bytes each: the 3 offsets of an upto3 roll & a pad byte.
+        std::uint64_t rolls_left;
+        cell_iterator_t* positions;//! The positions of the running game, by seat.
+        std::uint64_t current;//! The seat to move.
+        std::uint64_t turns;//! Moves made in the running game.
+        std::uint64_t games_left;//! The kernel returns once this reaches 0 or the rolls run out.
+        std::int64_t* finished_turns;//! Receives the length of every finished game & is advanced past it.
+        std::uint64_t* wins;//! wins[p] is incremented for every game won by seat p.
+    };
+
+    static_assert(sizeof(kernel_context_t) == 64, "kernel_context_t is addressed by fixed offsets");
+
+    /*! @brief The game loop of simulate_chunk() specialized to one board without rules & one player count.
+        @details On x86-64 the loop is compiled to machine code with the board folded into it: boards with at most
+        compare_chain_jumps jumps become a branch free chain of compares & conditional moves per step, larger boards
+        index a table of resolved jump targets whose address is an immediate. Elsewhere, or if executable memory is
+        refused, the same loop runs as C++ over the same table, so both paths play the same games.
+        The code pages hold a pointer to the table, so a kernel can be moved but not copied.
+    */
+    class game_kernel_t {
+        std::vector<cell_iterator_t> resolved;//! @internal resolved[c] is where a player landing on c ends up, every jump taken
+        cell_iterator_t end_;
+        player_id_t players_;
+        std::size_t jumps_ = 0;
+        the_learning_games::executable_code_t code;
+
+    public:
+        //! Boards with up to this many jumps are compiled to compare chains, larger ones to a table lookup.
+        //! Each jump adds a conditional move to the dependency chain of a step, so beyond a couple the L1 load is faster.
+        static constexpr std::size_t const compare_chain_jumps = 2;
+
+        /*! @param compile False to run the table driven loop, e.g. as the baseline of a benchmark.
+            @throws std::logic_error If board has rules, which the kernel doesn't execute. @see simulate_jit()
+        */
+        game_kernel_t(board_t const& board, player_id_t players, bool compile = true) :
+            end_(board.end()),
+            players_(players)
+        {
+            if (board.has_rules()) throw std::logic_error("pre: board has rules");
+            if (players < 1) throw std::logic_error("pre: player count less than one");
+            for (auto c = board.begin(); c != board.end(); ++c) {
+                resolved.push_back(board.advance(c, 0));
+                jumps_ += resolved.back() != c;
+            }
+            if (compile && the_learning_games::executable_code_t::supported()) {
+                try {
+                    code = the_learning_games::executable_code_t(generate());
+                }
+                catch (std::runtime_error const&) {}//! @internal executable memory refused, stay on the table
+            }
+        }
+
+        bool compiled() const { return static_cast<bool>(code); }//! @brief Returns true if running machine code.
+        bool compare_chain() const { return compiled() && jumps_ <= compare_chain_jumps; }//! @brief Returns true if the board was folded into compare chains.
+        player_id_t players() const { return players_; }
+
+        /*! @brief Plays moves from context.rolls until they or context.games_left run out.
+        */
+        void operator()(kernel_context_t& context) const {
+            if (code)
+                code.entry<void(kernel_context_t*)>()(&context);
+            else
+                run_table(context);
+        }
+
+    private:
+        /*! @internal @brief The table driven loop. The generated code follows it instruction for instruction.
+        */
+        void run_table(kernel_context_t& context) const {
+            auto const last_cell = static_cast<cell_iterator_t>(end_ - 1);
+            while (context.games_left && context.rolls_left) {
+                ++context.turns;
+                auto position = context.positions[context.current];
+                auto finished = false;
+                for (auto i = 0; i != 3 && !finished; ++i) {
+                    auto const next = position + context.rolls[i];
+                    if (next < end_) position = resolved[next];
+                    finished = position == last_cell;
+                }
+                context.rolls += 4;
+                --context.rolls_left;
+
+                if (!finished) {
+                    context.positions[context.current] = position;
+                    if (++context.current == static_cast<std::uint64_t>(players_)) context.current = 0;
+                    continue;
+                }
+                *context.finished_turns++ = static_cast<std::int64_t>(context.turns);
+                ++context.wins[context.current];
+                --context.games_left;
+                std::fill_n(context.positions, players_, cell_iterator_t{});
+                context.current = 0;
+                context.turns = 0;
+            }
+        }
+
+        /*! @internal @brief Emits run_table() for x86-64.
+            @details Registers: rbx context, rsi rolls, rdi rolls_left, r8 positions, r9 current, r10 turns,
+            r11 games_left, r12 finished_turns, r13 wins, r14 resolved, eax position, ecx & edx scratch.
+            Only the registers pushed are touched, so the code suits both the System V & the Windows calling convention.
+        */
+        std::vector<std::uint8_t> generate() const {
+            the_learning_games::code_buffer_t a;
+            auto const loop = a.label(), finished = a.label(), clear = a.label(), done = a.label();
+            auto const last_cell = static_cast<std::uint32_t>(end_ - 1);
+            auto const players = static_cast<std::uint32_t>(players_);
+
+            a.emit({ 0x53, 0x56, 0x57, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56 });//push rbx, rsi, rdi, r12, r13, r14
+#ifdef _WIN32
+            a.emit({ 0x48, 0x89, 0xCB });//mov rbx, rcx
+#else
+            a.emit({ 0x48, 0x89, 0xFB });//mov rbx, rdi
+#endif
+            a.emit({ 0x48, 0x8B, 0x73, 0x00 });//mov rsi, [rbx + 0]
+            a.emit({ 0x48, 0x8B, 0x7B, 0x08 });//mov rdi, [rbx + 8]
+            a.emit({ 0x4C, 0x8B, 0x43, 0x10 });//mov r8, [rbx + 16]
+            a.emit({ 0x4C, 0x8B, 0x4B, 0x18 });//mov r9, [rbx + 24]
+            a.emit({ 0x4C, 0x8B, 0x53, 0x20 });//mov r10, [rbx + 32]
+            a.emit({ 0x4C, 0x8B, 0x5B, 0x28 });//mov r11, [rbx + 40]
+            a.emit({ 0x4C, 0x8B, 0x63, 0x30 });//mov r12, [rbx + 48]
+            a.emit({ 0x4C, 0x8B, 0x6B, 0x38 });//mov r13, [rbx + 56]
+            a.emit({ 0x49, 0xBE }).emit64(reinterpret_cast<std::uint64_t>(resolved.data()));//mov r14, resolved
+
+            a.bind(loop);
+            a.emit({ 0x4D, 0x85, 0xDB, 0x0F, 0x84 }).rel32(done);//test r11, r11; je done
+            a.emit({ 0x48, 0x85, 0xFF, 0x0F, 0x84 }).rel32(done);//test rdi, rdi; je done
+            a.emit({ 0x49, 0xFF, 0xC2 });//inc r10
+            a.emit({ 0x43, 0x0F, 0xBF, 0x04, 0x48 });//movsx eax, word [r8 + r9 * 2]
+
+            for (std::uint8_t step = 0; step != 3; ++step) {
+                auto const stay = a.label();
+                a.emit({ 0x0F, 0xBE, 0x4E, step });//movsx ecx, byte [rsi + step]
+                a.emit({ 0x8D, 0x14, 0x08 });//lea edx, [rax + rcx]
+                a.emit({ 0x81, 0xFA }).emit32(static_cast<std::uint32_t>(end_));//cmp edx, end
+                a.emit({ 0x0F, 0x8D }).rel32(stay);//jge stay
+                if (jumps_ <= compare_chain_jumps) {
+                    a.emit({ 0x89, 0xD0 });//mov eax, edx
+                    for (std::size_t c = 0; c != resolved.size(); ++c) {
+                        if (resolved[c] == static_cast<cell_iterator_t>(c)) continue;
+                        a.emit({ 0xBA }).emit32(static_cast<std::uint32_t>(resolved[c]));//mov edx, target
+                        a.emit({ 0x3D }).emit32(static_cast<std::uint32_t>(c));//cmp eax, source
+                        a.emit({ 0x0F, 0x44, 0xC2 });//cmove eax, edx
+                    }
+                }
+                else {
+                    a.emit({ 0x41, 0x0F, 0xBF, 0x04, 0x56 });//movsx eax, word [r14 + rdx * 2]
+                }
+                a.bind(stay);
+                a.emit({ 0x3D }).emit32(last_cell);//cmp eax, last_cell
+                a.emit({ 0x0F, 0x84 }).rel32(finished);//je finished
+            }
+
+            a.emit({ 0x66, 0x43, 0x89, 0x04, 0x48 });//mov [r8 + r9 * 2], ax
+            a.emit({ 0x48, 0x83, 0xC6, 0x04 });//add rsi, 4
+            a.emit({ 0x48, 0xFF, 0xCF });//dec rdi
+            a.emit({ 0x49, 0xFF, 0xC1 });//inc r9
+            a.emit({ 0x49, 0x81, 0xF9 }).emit32(players);//cmp r9, players
+            a.emit({ 0x0F, 0x85 }).rel32(loop);//jne loop
+            a.emit({ 0x45, 0x31, 0xC9 });//xor r9d, r9d
+            a.emit({ 0xE9 }).rel32(loop);//jmp loop
+
+            a.bind(finished);
+            a.emit({ 0x48, 0x83, 0xC6, 0x04 });//add rsi, 4
+            a.emit({ 0x48, 0xFF, 0xCF });//dec rdi
+            a.emit({ 0x4D, 0x89, 0x14, 0x24 });//mov [r12], r10
+            a.emit({ 0x49, 0x83, 0xC4, 0x08 });//add r12, 8
+            a.emit({ 0x4B, 0xFF, 0x44, 0xCD, 0x00 });//inc qword [r13 + r9 * 8]
+            a.emit({ 0x49, 0xFF, 0xCB });//dec r11
+            a.emit({ 0x31, 0xC9 });//xor ecx, ecx
+            a.bind(clear);
+            a.emit({ 0x66, 0x41, 0xC7, 0x04, 0x48, 0x00, 0x00 });//mov word [r8 + rcx * 2], 0
+            a.emit({ 0x48, 0xFF, 0xC1 });//inc rcx
+            a.emit({ 0x48, 0x81, 0xF9 }).emit32(players);//cmp rcx, players
+            a.emit({ 0x0F, 0x85 }).rel32(clear);//jne clear
+            a.emit({ 0x45, 0x31, 0xC9 });//xor r9d, r9d
+            a.emit({ 0x45, 0x31, 0xD2 });//xor r10d, r10d
+            a.emit({ 0xE9 }).rel32(loop);//jmp loop
+
+            a.bind(done);
+            a.emit({ 0x48, 0x89, 0x73, 0x00 });//mov [rbx + 0], rsi
+            a.emit({ 0x48, 0x89, 0x7B, 0x08 });//mov [rbx + 8], rdi
+            a.emit({ 0x4C, 0x89, 0x4B, 0x18 });//mov [rbx + 24], r9
+            a.emit({ 0x4C, 0x89, 0x53, 0x20 });//mov [rbx + 32], r10
+            a.emit({ 0x4C, 0x89, 0x5B, 0x28 });//mov [rbx + 40], r11
+            a.emit({ 0x4C, 0x89, 0x63, 0x30 });//mov [rbx + 48], r12
+            a.emit({ 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5F, 0x5E, 0x5B });//pop r14, r13, r12, rdi, rsi, rbx
+            a.emit({ 0xC3 });//ret
+            return a.finish();
+        }
+    };
+
+    /*! @brief simulate_chunk() through kernel. Plays the same games, since the rolls are consumed in the same order.
+    */
+    template<typename Dice>
+    simulation_result_t simulate_chunk_kernel(game_kernel_t const& kernel, simulation_config_t const& config, Dice& dice, std::uint64_t games) {
+        if (kernel.players() != config.players) throw std::logic_error("pre: kernel compiled for another player count");
+        std::size_t const batch = 1024;//! @internal moves rolled ahead, a surplus at the end of the chunk is dropped with the dice
+
+        simulation_result_t rc;
+        rc.wins.resize(config.players);
+        std::vector<cell_iterator_t> positions(config.players);
+        std::vector<std::int8_t> rolls(4 * batch);
+        std::vector<std::int64_t> turns(batch);
+        kernel_context_t context{ nullptr, 0, positions.data(), 0, 0, games, nullptr, rc.wins.data() };
+
+        while (context.games_left) {
+            for (std::size_t i = 0; i != batch; ++i) {
+                auto const roll = dice.roll();
+                rolls[4 * i] = static_cast<std::int8_t>(std::get<0>(roll));
+                rolls[4 * i + 1] = static_cast<std::int8_t>(std::get<1>(roll));
+                rolls[4 * i + 2] = static_cast<std::int8_t>(std::get<2>(roll));
+            }
+            context.rolls = rolls.data();
+            context.rolls_left = batch;
+            context.finished_turns = turns.data();
+            kernel(context);
+            for (auto t = turns.data(); t != context.finished_turns; ++t) rc.turns.add(*t);
+        }
+        return rc;
+    }
+
+    /*! @brief simulate() through a prebuilt kernel, bit identical to simulate() on the kernel's board.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    simulation_result_t simulate_kernel(game_kernel_t const& kernel, simulation_config_t const& config) {
+        return detail::simulate_chunks<Dice>(config, [&](Dice& dice, std::uint64_t games, std::uint64_t) {
+            return simulate_chunk_kernel(kernel, config, dice, games);
+        });
+    }
+
+    /*! @brief simulate() with the game loop compiled for board, bit identical to simulate().
+        @details Boards with rules run simulate() itself. The kernel is compiled once per call & shared by the workers.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    simulation_result_t simulate_jit(board_t const& board, simulation_config_t const& config) {
+        if (board.has_rules()) return simulate<Dice>(board, config);
+        return simulate_kernel<Dice>(game_kernel_t(board, config.players), config);
+    }
+}
@@ -0,0 +1,161 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "include\statistics.h"
+#include "session.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief Parameters of an open loop load test against a session_store_t.
+    */
+    struct load_config_t {
+        session_id_t sessions = 4096;//! Live games the requests are spread over.
+        player_id_t players = 4;//! Players per game.
+        unsigned clients = 1;//! Threads issuing requests. Bounds the concurrency, not the arrival rate.
+        double seconds = 2.;//! Duration of each load point.
+        std::vector<double> offered_rates = { 1e4, 1e5, 2.5e5, 5e5, 1e6, 2e6 };//! Requests per second, one load point each.
+        std::uint64_t seed = 2016;
+    };
+
+    /*! @brief The measurements of one offered rate.
+    */
+    struct load_point_t {
+        double offered_rate = 0;//! Requests per second that were scheduled.
+        double achieved_rate = 0;//! Requests per second that completed.
+        the_learning_games::log_histogram_t latency_ns;//! Completion time minus scheduled arrival time.
+    };
+
+    /*! @brief Runs one open loop load point.
+        @details Arrival times are drawn up front from a Poisson process of the offered rate, each request targeting a
+        uniformly chosen session. A request's latency is measured from its scheduled arrival, not from when a client
+        got around to sending it, so a saturated engine shows up as growing latency instead of being hidden by the
+        clients slowing down (coordinated omission).
+        @param store The session engine under test.
+        @param ids The open sessions to address.
+    */
+    template<typename Store>
+    load_point_t run_load_point(Store& store, std::vector<session_id_t> const& ids, double rate, load_config_t const& config) {
+        using steady_clock_t = std::chrono::steady_clock;
+        if (rate <= 0 || ids.empty()) throw std::logic_error("pre: rate or session count not positive");
+
+        struct request_t {
+            steady_clock_t::duration arrival;
+            session_id_t session;
+        };
+        std::vector<request_t> requests;
+        {
+            std::mt19937_64 engine(config.seed);
+            std::exponential_distribution<double> gap(rate);
+            std::uniform_int_distribution<std::size_t> session(0, ids.size() - 1);
+            for (auto t = gap(engine); t < config.seconds; t += gap(engine))
+                requests.push_back({ std::chrono::duration_cast<steady_clock_t::duration>(std::chrono::duration<double>(t)), ids[session(engine)] });
+        }
+
+        std::atomic<std::size_t> next{ 0 };
+        auto const start = steady_clock_t::now() + std::chrono::milliseconds(10);
+
+        auto client = [&]() {
+            the_learning_games::log_histogram_t latency;
+            auto last = start;
+            for (auto i = next++; i < requests.size(); i = next++) {
+                auto const due = start + requests[i].arrival;
+                while (steady_clock_t::now() < due) {//! @internal sleep is too coarse for sub millisecond gaps
+                    if (due - steady_clock_t::now() > std::chrono::microseconds(200))
+                        std::this_thread::sleep_until(due - std::chrono::microseconds(100));
+                    else
+                        std::this_thread::yield();
+                }
+                store.play_turn(requests[i].session, true);
+                last = steady_clock_t::now();
+                latency.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(last - due).count()));
+            }
+            return std::make_pair(latency, last);
+        };
+
+        std::vector<std::future<std::pair<the_learning_games::log_histogram_t, steady_clock_t::time_point>>> clients;
+        for (auto i = 0u; i < std::max(config.clients, 1u); ++i)
+            clients.emplace_back(std::async(std::launch::async, client));
+
+        load_point_t rc;
+        rc.offered_rate = rate;
+        auto finish = start;
+        for (auto& c : clients) {
+            auto result = c.get();
+            rc.latency_ns.merge(result.first);
+            finish = std::max(finish, result.second);
+        }
+        auto const elapsed = std::chrono::duration<double>(finish - start).count();
+        rc.achieved_rate = elapsed > 0 ? static_cast<double>(rc.latency_ns.count()) / elapsed : 0.;
+        return rc;
+    }
+
+    /*! @brief Opens config.sessions games on board & runs one load point per offered rate.
+    */
+    inline std::vector<load_point_t> run_load_sweep(board_t const& board, load_config_t const& config) {
+        session_store_t<> store(board, config.sessions);
+        std::vector<session_id_t> ids;
+        for (session_id_t i = 0; i != config.sessions; ++i)
+            ids.push_back(store.open(config.players, static_cast<std::mt19937::result_type>(config.seed + i)));
+
+        std::vector<load_point_t> rc;
+        for (auto rate : config.offered_rates)
+            rc.push_back(run_load_point(store, ids, rate, config));
+        return rc;
+    }
+
+    /*! @brief Prints the latency curve, one row per load point, latencies in microseconds.
+    */
+    inline std::ostream& operator<< (std::ostream& os, std::vector<load_point_t> const& curve) {
+        auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.; };
+        os << std::setw(12) << "offered/s" << std::setw(12) << "achieved/s"
+            << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+        for (auto const& point : curve) {
+            auto const& l = point.latency_ns;
+            os << std::fixed << std::setprecision(0)
+                << std::setw(12) << point.offered_rate << std::setw(12) << point.achieved_rate << std::setprecision(1)
+                << std::setw(10) << us(l.quantile(.5)) << std::setw(10) << us(l.quantile(.9)) << std::setw(10) << us(l.quantile(.99))
+                << std::setw(10) << us(l.quantile(.999)) << std::setw(10) << us(l.max()) << "\n";
+        }
+        return os << std::defaultfloat;
+    }
+}
@@ -0,0 +1,290 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "include\memory_accounting.h"
+#include "chain.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    //! A metric of a board, a column of metrics_index_t. Column board_metric_count + p is the win rate of seat p.
+    enum class board_metric_t : std::uint8_t {
+        mean_turns,//! Expected calls to game_t::move() per game.
+        turns_variance,
+        turns_p10,//! Turns by which 10% of games have ended.
+        turns_median,
+        turns_p90,
+        seat_imbalance//! Largest less smallest seat win rate.
+    };
+    constexpr std::size_t const board_metric_count = 6;
+
+    /*! @brief The metrics of a board for a number of players.
+    */
+    struct board_metrics_t {
+        std::uint64_t hash = 0;//! board_hash() of the board.
+        std::array<double, board_metric_count> values = {};//! values[m] is the metric board_metric_t(m).
+        std::vector<double> wins;//! wins[p] is the probability that the player seated at p wins.
+
+        double operator[](board_metric_t metric) const { return values[static_cast<std::size_t>(metric)]; }
+
+        double column(std::size_t c) const {//! @brief Returns column c of metrics_index_t.
+            return c < board_metric_count ? values[c] : wins[c - board_metric_count];
+        }
+    };
+
+    /*! @brief Computes the metrics of board exactly from solve_chain().
+        @throws std::logic_error As solve_chain(), or if more than 1e-9 of the games don't end within config.max_turns.
+    */
+    inline board_metrics_t evaluate_board_metrics(board_t const& board, chain_config_t const& config) {
+        auto const chain = solve_chain(board, config);
+        if (chain.unresolved > 1e-9) throw std::logic_error("pre: games don't end with certainty");
+
+        board_metrics_t rc;
+        rc.hash = board_hash(board);
+        rc.wins = chain.wins;
+        auto square = 0., cumulative = 0.;
+        std::array<double, 3> const levels = { 0.1, 0.5, 0.9 };
+        std::size_t level = 0;
+        for (std::size_t t = 0; t != chain.length.size(); ++t) {
+            auto const turns = static_cast<double>(t + 1);
+            square += chain.length[t] * turns * turns;
+            cumulative += chain.length[t];
+            for (; level != levels.size() && cumulative >= levels[level]; ++level)
+                rc.values[static_cast<std::size_t>(board_metric_t::turns_p10) + level] = turns;
+        }
+        rc.values[static_cast<std::size_t>(board_metric_t::mean_turns)] = chain.expected_turns;
+        rc.values[static_cast<std::size_t>(board_metric_t::turns_variance)] = std::max(square - chain.expected_turns * chain.expected_turns, 0.);
+        auto const seats = std::minmax_element(rc.wins.begin(), rc.wins.end());
+        rc.values[static_cast<std::size_t>(board_metric_t::seat_imbalance)] = *seats.second - *seats.first;
+        return rc;
+    }
+
+    /*! @brief A closed range [low, high] of one column, a term of metrics_index_t::query().
+    */
+    struct metric_range_t {
+        std::size_t column;
+        double low;
+        double high;
+
+        static metric_range_t of(board_metric_t metric, double low, double high) { return{ static_cast<std::size_t>(metric), low, high }; }
+        static metric_range_t seat_win(player_id_t seat, double low, double high) { return{ board_metric_count + static_cast<std::size_t>(seat), low, high }; }
+    };
+
+    /*! @brief An index of the metrics of a library of boards, answering conjunctions of range queries.
+        @details Columnar: each metric is a column of single precision values by row, & a copy of the column sorted by
+        value with the row of each value. A query binary searches every range in its sorted column, walks the rows of
+        the most selective one & checks the other ranges against their columns, so its cost follows the smallest range
+        rather than the library.
+        Inserts go to a small unsorted tail, which queries scan in full & which is merged into the sorted columns once
+        it exceeds 1/16 of them, so an insert costs amortized O(columns) comparisons. Re-inserting a hash replaces the
+        board's metrics; replaced & erased rows are skipped until the next merge compacts them away when they are
+        more than a quarter of the rows.
+        The rows are held within a byte budget, typically a share of the_learning_games::resource_plan_t::cache_budget_bytes.
+        Queries may run concurrently with each other, not with insert() or erase().
+    */
+    class metrics_index_t {
+        template<typename T>
+        using column_vector_t = the_learning_games::accounted_vector_t<T, the_learning_games::memory_component_t::caches>;
+        using sorted_column_t = column_vector_t<std::pair<float, std::uint32_t>>;
+        using row_map_t = std::unordered_map<std::uint64_t, std::uint32_t, std::hash<std::uint64_t>, std::equal_to<std::uint64_t>,
+            the_learning_games::accounted_allocator_t<std::pair<std::uint64_t const, std::uint32_t>, the_learning_games::memory_component_t::caches>>;
+
+        player_id_t const players_;
+        std::size_t const columns_;
+        std::uint64_t const budget_bytes_;
+        column_vector_t<std::uint64_t> hashes;//! @internal by row
+        column_vector_t<std::uint8_t> alive;//! @internal by row
+        std::vector<column_vector_t<float>> values;//! @internal values[c][row]
+        std::vector<sorted_column_t> sorted;//! @internal sorted[c] holds rows [0, sorted_rows) by value
+        std::uint32_t sorted_rows = 0;
+        std::uint32_t dead = 0;
+        row_map_t rows;//! @internal row of each live hash
+
+    public:
+        /*! @param players The players of every game the metrics describe, which sets the number of seat win rate columns.
+            @param budget_bytes The bytes() the index may grow to.
+        */
+        explicit metrics_index_t(player_id_t players, std::uint64_t budget_bytes = std::numeric_limits<std::uint64_t>::max()) :
+            players_(players),
+            columns_(board_metric_count + static_cast<std::size_t>(players)),
+            budget_bytes_(budget_bytes),
+            values(board_metric_count + static_cast<std::size_t>(players)),
+            sorted(board_metric_count + static_cast<std::size_t>(players))
+        {
+            if (players < 1) throw std::logic_error("pre: player count less than one");
+        }
+
+        /*! @brief Adds the metrics of a board, replacing any earlier metrics of the same hash.
+            @throws std::logic_error If metrics has another number of seats than the index.
+            @throws std::runtime_error If another row would take the index over its budget, even after compacting away
+            replaced & erased rows. The index is unchanged. Replacing a board's metrics never throws this.
+        */
+        void insert(board_metrics_t const& metrics) {
+            if (metrics.wins.size() != static_cast<std::size_t>(players_)) throw std::logic_error("pre: seat count mismatch");
+            if (bytes() + row_bytes() > budget_bytes_ && (dead || rows.count(metrics.hash))) {
+                erase(metrics.hash);//! @internal the replaced row is dead anyway, compacting gives its bytes back
+                compact();
+            }
+            if (bytes() + row_bytes() > budget_bytes_) throw std::runtime_error("metrics index: over its cache budget");
+            erase(metrics.hash);
+            auto const row = static_cast<std::uint32_t>(hashes.size());
+            hashes.push_back(metrics.hash);
+            alive.push_back(1);
+            for (std::size_t c = 0; c != columns_; ++c)
+                values[c].push_back(static_cast<float>(metrics.column(c)));
+            rows[metrics.hash] = row;
+            if (hashes.size() - sorted_rows > std::max<std::size_t>(sorted_rows / 16, 1024)) merge();
+        }
+
+        /*! @brief Removes the metrics of hash.
+            @return Returns false if the index holds none.
+        */
+        bool erase(std::uint64_t hash) {
+            auto const found = rows.find(hash);
+            if (found == rows.end()) return false;
+            alive[found->second] = 0;
+            ++dead;
+            rows.erase(found);
+            return true;
+        }
+
+        /*! @brief Returns the hashes of the boards whose metrics lie within every range, in no particular order.
+            @details Values are compared in single precision. No ranges select every board.
+            @throws std::logic_error If a range names a column the index doesn't have.
+        */
+        std::vector<std::uint64_t> query(std::vector<metric_range_t> const& ranges) const {
+            std::vector<std::pair<float, float>> bounds;
+            for (auto const& r : ranges) {
+                if (r.column >= columns_) throw std::logic_error("pre: column out of range");
+                bounds.emplace_back(static_cast<float>(r.low), static_cast<float>(r.high));
+            }
+            auto const matches = [&](std::uint32_t row) {
+                if (!alive[row]) return false;
+                for (std::size_t i = 0; i != ranges.size(); ++i) {
+                    auto const v = values[ranges[i].column][row];
+                    if (v < bounds[i].first || v > bounds[i].second) return false;
+                }
+                return true;
+            };
+
+            std::vector<std::uint64_t> rc;
+            auto first = std::uint32_t{}, last = sorted_rows;//! @internal rows of the sorted part to walk, by position in the driving column
+            sorted_column_t const* driving = nullptr;
+            for (std::size_t i = 0; i != ranges.size(); ++i) {
+                auto const& column = sorted[ranges[i].column];
+                auto const low = std::lower_bound(column.begin(), column.end(), bounds[i].first, [](std::pair<float, std::uint32_t> const& e, float v) { return e.first < v; });
+                auto const high = std::upper_bound(low, column.end(), bounds[i].second, [](float v, std::pair<float, std::uint32_t> const& e) { return v < e.first; });
+                if (!driving || static_cast<std::uint32_t>(high - low) < last - first) {
+                    driving = &column;
+                    first = static_cast<std::uint32_t>(low - column.begin());
+                    last = static_cast<std::uint32_t>(high - column.begin());
+                }
+            }
+            for (auto i = first; i != last; ++i) {
+                auto const row = driving ? (*driving)[i].second : i;
+                if (matches(row)) rc.push_back(hashes[row]);
+            }
+            for (auto row = sorted_rows; row != static_cast<std::uint32_t>(hashes.size()); ++row)
+                if (matches(row)) rc.push_back(hashes[row]);
+            return rc;
+        }
+
+        bool contains(std::uint64_t hash) const { return rows.count(hash) != 0; }//! @brief Returns true if the index holds metrics of hash.
+        std::size_t size() const { return rows.size(); }//! @brief Returns the number of boards.
+        player_id_t players() const { return players_; }
+        std::size_t columns() const { return columns_; }
+        std::uint64_t budget_bytes() const { return budget_bytes_; }
+
+        /*! @brief Returns the bytes held by the rows, including replaced & erased ones until they are compacted away.
+            @details An estimate that counts every row with a sorted entry per column & a hash map node, but no spare capacity.
+        */
+        std::uint64_t bytes() const { return hashes.size() * row_bytes(); }
+
+        /*! @brief Sorts the tail into the sorted columns, e.g. before a burst of queries.
+        */
+        void merge() {
+            if (dead * std::size_t{ 4 } > hashes.size()) {
+                compact();
+                return;
+            }
+            auto const by_value = [](std::pair<float, std::uint32_t> const& a, std::pair<float, std::uint32_t> const& b) { return a < b; };
+            for (std::size_t c = 0; c != columns_; ++c) {
+                auto& column = sorted[c];
+                auto const middle = column.size();
+                for (auto row = sorted_rows; row != static_cast<std::uint32_t>(hashes.size()); ++row)
+                    column.emplace_back(values[c][row], row);
+                std::sort(column.begin() + middle, column.end(), by_value);
+                std::inplace_merge(column.begin(), column.begin() + middle, column.end(), by_value);
+            }
+            sorted_rows = static_cast<std::uint32_t>(hashes.size());
+        }
+
+    private:
+        std::uint64_t row_bytes() const {//! @internal a hash, a liveness byte, a value & a sorted entry per column & a map node
+            return sizeof(std::uint64_t) + 1 + columns_ * (sizeof(float) + sizeof(std::pair<float, std::uint32_t>))
+                + sizeof(std::pair<std::uint64_t const, std::uint32_t>) + 2 * sizeof(void*);
+        }
+
+        /*! @internal @brief Drops the dead rows, renumbers the live ones & sorts every column afresh.
+        */
+        void compact() {
+            std::uint32_t live = 0;
+            for (std::uint32_t row = 0; row != hashes.size(); ++row) {
+                if (!alive[row]) continue;
+                hashes[live] = hashes[row];
+                for (auto& column : values) column[live] = column[row];
+                rows[hashes[live]] = live;
+                ++live;
+            }
+            hashes.resize(live);
+            alive.assign(live, 1);
+            for (auto& column : values) column.resize(live);
+            dead = 0;
+            for (std::size_t c = 0; c != columns_; ++c) {
+                sorted[c].clear();
+                for (std::uint32_t row = 0; row != live; ++row) sorted[c].emplace_back(values[c][row], row);
+                std::sort(sorted[c].begin(), sorted[c].end());
+            }
+            sorted_rows = live;
+        }
+    };
+}
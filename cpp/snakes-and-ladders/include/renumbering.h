@@ -0,0 +1,184 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "include\dice.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief A renumbering of the cells of a board into the states of a table layout, & back.
+        @details Engines index their tables by state; positions are mapped to states where they enter the engine &
+        back where they leave it, so callers keep working in cells.
+    */
+    class cell_order_t {
+        std::vector<cell_iterator_t> state_;//! @internal state_[cell]
+        std::vector<cell_iterator_t> cell_;//! @internal cell_[state]
+
+    public:
+        /*! @brief The identity on cells cells.
+        */
+        explicit cell_order_t(std::size_t cells = 0) : state_(cells), cell_(cells) {
+            for (std::size_t c = 0; c != cells; ++c)
+                state_[c] = cell_[c] = static_cast<cell_iterator_t>(c);
+        }
+
+        /*! @param cells The cells in state order, a permutation of 0 .. cells.size() - 1.
+            @throws std::logic_error If cells is not a permutation.
+        */
+        explicit cell_order_t(std::vector<cell_iterator_t> cells) : state_(cells.size(), -1), cell_(std::move(cells)) {
+            for (std::size_t s = 0; s != cell_.size(); ++s) {
+                auto const c = static_cast<std::size_t>(cell_[s]);
+                if (cell_[s] < 0 || c >= cell_.size() || state_[c] != -1) throw std::logic_error("pre: not a permutation");
+                state_[c] = static_cast<cell_iterator_t>(s);
+            }
+        }
+
+        std::size_t size() const { return cell_.size(); }//! @brief Returns the number of cells.
+        cell_iterator_t state(cell_iterator_t c) const { return state_[c]; }//! @brief Returns the state of cell c.
+        cell_iterator_t cell(cell_iterator_t s) const { return cell_[s]; }//! @brief Returns the cell of state s.
+
+        bool identity() const {//! @brief Returns true if every cell is its own state.
+            for (std::size_t c = 0; c != state_.size(); ++c)
+                if (state_[c] != static_cast<cell_iterator_t>(c)) return false;
+            return true;
+        }
+
+        /*! @brief Returns values indexed by cell, e.g. a distribution over the board, indexed by state.
+        */
+        template<typename T>
+        std::vector<T> to_states(std::vector<T> const& by_cell) const {
+            std::vector<T> rc(by_cell.size());
+            for (std::size_t c = 0; c != by_cell.size(); ++c) rc[static_cast<std::size_t>(state_[c])] = by_cell[c];
+            return rc;
+        }
+
+        /*! @brief Returns values indexed by state indexed by cell.
+        */
+        template<typename T>
+        std::vector<T> to_cells(std::vector<T> const& by_state) const {
+            std::vector<T> rc(by_state.size());
+            for (std::size_t s = 0; s != by_state.size(); ++s) rc[static_cast<std::size_t>(cell_[s])] = by_state[s];
+            return rc;
+        }
+    };
+
+    /*! @brief Returns the expected number of times a single player's game from start ends a move on each cell.
+        @details The flow of the absorbing chain: the distributions after every move summed until less than tolerance
+        is left in play or after max_moves moves. A layout only needs the rough flow, so a coarse tolerance will do.
+        Table is a transition_table_t, or anything with `cells()`, `row_size(c)` & `for_each_target(c, f)`.
+    */
+    template<typename Table>
+    std::vector<double> expected_visits(Table const& table, cell_iterator_t start, double tolerance = 1e-3, std::size_t max_moves = 1 << 16) {
+        std::vector<double> rc(table.cells()), current(table.cells()), next(table.cells());
+        current[static_cast<std::size_t>(start)] = 1.;
+        auto in_play = 1.;
+        for (std::size_t k = 0; k != max_moves && in_play >= tolerance; ++k) {
+            std::fill(next.begin(), next.end(), 0.);
+            for (std::size_t c = 0; c != current.size(); ++c) {
+                if (current[c] == 0.) continue;
+                table.for_each_target(static_cast<cell_iterator_t>(c), [&](cell_iterator_t t, double p) { next[static_cast<std::size_t>(t)] += current[c] * p; });
+            }
+            in_play = 0.;
+            for (std::size_t c = 0; c != next.size(); ++c) {
+                rc[c] += next[c];
+                if (table.row_size(static_cast<cell_iterator_t>(c))) in_play += next[c];
+                else next[c] = 0.;//! @internal the end cell, or a cell without moves, absorbs
+            }
+            std::swap(current, next);
+        }
+        return rc;
+    }
+
+    /*! @brief Returns how often sampled single player games on board end a move on each cell, from their traces.
+        @details The sampled counterpart of expected_visits(), for boards whose chain is too costly to propagate, e.g.
+        with rules whose outcomes depend on the game. Every game is capped at max_moves moves.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    std::vector<double> sampled_visits(board_t const& board, std::uint64_t games, std::int8_t sides = 6, std::uint64_t seed = 0, std::uint64_t max_moves = 1 << 16) {
+        std::vector<double> rc(static_cast<std::size_t>(board.end()));
+        Dice dice(sides, seed);
+        for (std::uint64_t i = 0; i != games; ++i) {
+            game_t game(board, player_id_t{ 1 }, seed + i);
+            for (std::uint64_t k = 0; game && k != max_moves; ++k) {
+                auto roll = dice.roll();
+                game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                ++rc[static_cast<std::size_t>(game.all_player_positions()[0])];
+            }
+        }
+        return rc;
+    }
+
+    /*! @brief Orders the cells so that the cells a game moves through are numbered together.
+        @details A breadth first walk from start, weighted Cuthill-McKee: each cell taken in turn numbers its not yet
+        numbered targets next, heaviest flow `visits[c] * p` first. Cells no move ends on, the sources of the jumps &
+        whatever start can't reach, are never walked to & follow in board order, so the states a propagation or a game
+        touches are packed into fewer cache lines, & the far end of a snake or ladder is numbered among the targets of
+        the cells that lead to it.
+        @param visits The flow through each cell, from expected_visits() or sampled_visits().
+    */
+    template<typename Table>
+    cell_order_t locality_order(Table const& table, std::vector<double> const& visits, cell_iterator_t start = 0) {
+        auto const cells = table.cells();
+        if (visits.size() != cells) throw std::logic_error("pre: visits don't match the table");
+
+        std::vector<cell_iterator_t> order;
+        order.reserve(cells);
+        std::vector<char> numbered(cells);
+        std::vector<std::pair<double, cell_iterator_t>> targets;
+        auto take = [&](cell_iterator_t c) {
+            numbered[static_cast<std::size_t>(c)] = 1;
+            order.push_back(c);
+        };
+
+        take(start);
+        for (std::size_t next = 0; next != order.size(); ++next) {
+            auto const c = order[next];
+            targets.clear();
+            table.for_each_target(c, [&](cell_iterator_t t, double p) {
+                if (!numbered[static_cast<std::size_t>(t)]) targets.emplace_back(visits[static_cast<std::size_t>(c)] * p, t);
+            });
+            std::stable_sort(targets.begin(), targets.end(), [](std::pair<double, cell_iterator_t> const& a, std::pair<double, cell_iterator_t> const& b) { return a.first > b.first; });
+            for (auto const& t : targets) take(t.second);
+        }
+        for (std::size_t c = 0; c != cells; ++c)
+            if (!numbered[c]) take(static_cast<cell_iterator_t>(c));
+        return cell_order_t(std::move(order));
+    }
+}
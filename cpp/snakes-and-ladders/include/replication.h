@@ -0,0 +1,119 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <string>
+
+#include "include\shared_memory.h"
+#include "include\shared_ring.h"
+
+namespace snakes_and_ladders {
+
+    //! What a replication_record_t replays on the standby.
+    enum class replication_kind_t : std::uint8_t {
+        open = 1,//! value: seed | players << 32.
+        turn = 2,//! A session_store_t::play_turn(); the standby rolls its own dice, which must give roll.
+        rematch_turn = 3,//! A play_turn() which first started a rematch of the finished game.
+        move = 4,//! A session_store_t::move() by roll.
+        close = 5,
+        snapshot = 6,//! Reopens the session mid game. value: seed | players << 32 | current player << 48, roll[0]: game_state_t.
+        snapshot_dice = 7,//! value: the rolls drawn from the session dice since it was seeded.
+        snapshot_turns = 8,//! value: the turns played in the session.
+        snapshot_rules = 9,//! value: game_t::rule_state().
+        snapshot_player = 10//! value: player | position << 16 | skips next turn << 32.
+    };
+
+    /*! @brief An entry of the replication log, 16 bytes, so that a move costs the primary one 3 word ring slot.
+        @details A session's entries appear in the order its operations happened; entries of different sessions interleave.
+        A snapshot is the snapshot entry followed by the dice, turns, rules & one player entry per player.
+    */
+    struct replication_record_t {
+        std::uint32_t session;//! A session_id_t.
+        replication_kind_t kind;
+        std::int8_t roll[3];
+        std::uint64_t value;
+
+        /*! @brief Returns the open entry of a session of players seeded with seed.
+        */
+        static replication_record_t opened(std::uint32_t session, std::int16_t players, std::uint32_t seed) {
+            return{ session, replication_kind_t::open, { 0, 0, 0 }, seed | static_cast<std::uint64_t>(static_cast<std::uint16_t>(players)) << 32 };
+        }
+    };
+    static_assert(sizeof(replication_record_t) == 16, "replication_record_t must stay compact");
+
+    /*! @brief The replication log of a session_store_t, streamed from a primary process to a hot standby through shared memory.
+        @details The primary's sessions append entries from any thread; the standby's session_store_t::follow() applies them.
+        Appending never waits for the standby: if the log is full the entry is dropped & the log marked overrun, after
+        which the standby can no longer take over & a fresh log must be started. Once the primary has stopped serving
+        it calls hand_over(); the standby drains the log & serves the sessions from then on.
+        Both processes construct the log with the same name & capacity; the first one to map it formats it.
+    */
+    class replication_log_t {
+        static constexpr std::uint64_t const overrun_flag = 1;
+        static constexpr std::uint64_t const handed_over_flag = 2;
+
+        the_learning_games::shared_memory_t memory;
+        the_learning_games::shared_ring_t<replication_record_t> ring;
+
+    public:
+        /*! @param name The shared memory, @see the_learning_games::shared_memory_t
+            @param capacity The entries the standby may lag behind, a power of two.
+        */
+        replication_log_t(std::string const& name, std::size_t capacity = std::size_t{ 1 } << 16) :
+            memory(name, the_learning_games::shared_ring_t<replication_record_t>::bytes(capacity)),
+            ring(memory.data(), capacity)
+        {}
+
+        /*! @brief Appends an entry. Safe to call from any thread of the primary.
+            @return Returns false if the log is full, which marks it overrun.
+        */
+        bool append(replication_record_t const& record) {
+            if (ring.push(record)) return true;
+            ring.set_flags(overrun_flag);
+            return false;
+        }
+
+        /*! @brief Takes the oldest entry. Must only be called by the standby.
+            @return Returns false if there is none yet.
+        */
+        bool next(replication_record_t& record) {
+            return ring.pop(record);
+        }
+
+        void hand_over() { ring.set_flags(handed_over_flag); }//! @brief Called by the primary once it has stopped serving the sessions.
+        bool handed_over() const { return (ring.flags() & handed_over_flag) != 0; }//! @brief Returns true once the primary has stopped.
+        bool overrun() const { return (ring.flags() & overrun_flag) != 0; }//! @brief Returns true if an entry was dropped.
+        std::uint64_t lag() const { return ring.backlog(); }//! @brief Returns the entries appended & not yet applied by the standby.
+        std::size_t capacity() const { return ring.capacity(); }
+    };
+}
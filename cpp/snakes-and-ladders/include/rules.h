@@ -0,0 +1,89 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <sstream>
+#include <string>
+
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief Adds the special cells described by text to builder.
+        @param builder The builder, finalize() it afterwards as usual.
+        @param text One rule per line or per `;`, each a cell followed by its action:
+        ```
+        12 extra_turn
+        40 skip_turn
+        55 teleport 60 80     ; to a random cell of [60, 80]
+        70 bounce_back 5
+        ```
+        Text after a `#` is a comment.
+        @throws std::runtime_error On a malformed rule, naming the rule.
+        @throws std::logic_error If a rule is invalid for the board, @see board_builder_t::add_rule()
+        @return Returns a reference to builder.
+    */
+    inline board_builder_t& add_rules(board_builder_t& builder, std::string const& text) {
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream statements(line);
+            std::string statement;
+            while (std::getline(statements, statement, ';')) {
+                std::istringstream words(statement);
+                int cell, first = 0, last = 0;
+                std::string action;
+                if (!(words >> cell)) {
+                    if (words.eof()) continue;//! @internal blank statement
+                    throw std::runtime_error("rules: expected a cell in '" + statement + "'");
+                }
+                if (!(words >> action)) throw std::runtime_error("rules: expected an action in '" + statement + "'");
+
+                cell_rule_t rule;
+                if (action == "extra_turn") rule = cell_rule_t::extra_turn();
+                else if (action == "skip_turn") rule = cell_rule_t::skip_turn();
+                else if (action == "teleport" && words >> first >> last) rule = cell_rule_t::teleport(static_cast<cell_iterator_t>(first), static_cast<cell_iterator_t>(last));
+                else if (action == "bounce_back" && words >> first) rule = cell_rule_t::bounce_back(static_cast<cell_offset_t>(first));
+                else throw std::runtime_error("rules: bad action in '" + statement + "'");
+
+                if (cell != static_cast<cell_iterator_t>(cell) || first != static_cast<cell_iterator_t>(first) || last != static_cast<cell_iterator_t>(last))
+                    throw std::runtime_error("rules: cell out of range in '" + statement + "'");
+                std::string rest;
+                if (words >> rest) throw std::runtime_error("rules: trailing '" + rest + "' in '" + statement + "'");
+                builder.add_rule(static_cast<cell_iterator_t>(cell), rule);
+            }
+        }
+        return builder;
+    }
+}
@@ -0,0 +1,277 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "include\dice.h"
+#include "board_generator.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief The axes of a run_scaling_sweep().
+    */
+    struct scaling_config_t {
+        std::vector<unsigned> threads = { 1, 2, 4, 8 };//! Worker counts, swept in ascending order; the smallest is the efficiency baseline. Each buffered worker adds one filler thread.
+        std::vector<length_t> sides = { 10, 40, 100 };//! Board side lengths, boards carry side * side / 10 random jumps.
+        std::uint64_t moves_per_thread = 1 << 21;//! Work of each worker, rounded up to whole games.
+        std::size_t dice_buffer_length = std::size_t{ 1 } << 22;//! Rolls per fixed_buffer_dice_t, @see the_learning_games::resource_plan_t
+        unsigned cpus = 1;//! Usable cpus, @see the_learning_games::resource_limits_t
+    };
+
+    /*! @brief The measurements of one configuration.
+        @details rng, game & memory are the fractions of the wall time each resource would be busy at its single
+        resource ceiling. The largest one is the bottleneck; if none is close to saturation the workers are starved by
+        the cpu quota (more threads than cpus) or by contention.
+    */
+    struct scaling_row_t {
+        std::string engine;//! The random bit generator of the dice.
+        bool buffered = false;//! fixed_buffer_dice_t or rolling inline.
+        length_t side = 0;
+        unsigned threads = 0;
+        double games_per_second = 0;
+        double rolls_per_second = 0;//! Single die rolls.
+        double bytes_per_second = 0;//! Dice buffer traffic, every roll is written once & read once.
+        double efficiency = 0;//! Throughput per thread relative to that of the smallest thread count swept, 1 with a single thread baseline.
+        double rng = 0, game = 0, memory = 0;//! Utilization of each ceiling.
+        std::string bottleneck;
+    };
+
+    namespace detail {
+        struct scaling_counts_t {
+            std::uint64_t games = 0, moves = 0, rolls = 0;
+        };
+
+        /*! @internal @brief Plays whole 2 player games until at least moves have been made.
+        */
+        template<typename Dice>
+        scaling_counts_t play_moves(board_t const& board, Dice& dice, std::uint64_t moves) {
+            scaling_counts_t rc;
+            while (rc.moves < moves) {
+                game_t game(board, 2);
+                while (game) {
+                    auto roll = dice.roll();
+                    auto const rolled = (std::get<0>(roll) != 0) + (std::get<1>(roll) != 0) + (std::get<2>(roll) != 0);
+                    rc.rolls += rolled ? rolled : 3;//! @internal 3 nullified maximum rolls
+                    game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                    ++rc.moves;
+                }
+                ++rc.games;
+            }
+            return rc;
+        }
+
+        /*! @internal @brief Runs task on threads workers concurrently.
+            @return Returns the summed counts & the wall time in seconds.
+        */
+        template<typename Task>
+        std::pair<scaling_counts_t, double> run_workers(unsigned threads, Task task) {
+            auto const start = std::chrono::steady_clock::now();
+            std::vector<std::future<scaling_counts_t>> workers;
+            for (auto i = 0u; i < threads; ++i)
+                workers.emplace_back(std::async(std::launch::async, task, i));
+
+            scaling_counts_t rc;
+            for (auto& w : workers) {
+                auto const c = w.get();
+                rc.games += c.games;
+                rc.moves += c.moves;
+                rc.rolls += c.rolls;
+            }
+            return{ rc, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+        }
+
+        /*! @internal @brief Single die rolls per second of one thread, the rng ceiling.
+        */
+        template<typename Engine>
+        double rng_ceiling() {
+            the_learning_games::dice_t<std::int8_t, Engine> dice(6, 2016);
+            auto const rolls = 1 << 24;
+            auto sink = 0;
+            auto const start = std::chrono::steady_clock::now();
+            for (auto i = 0; i < rolls; ++i) sink += dice.roll();
+            auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return sink ? rolls / seconds : 0.;
+        }
+
+        /*! @internal @brief Moves per second of one thread replaying rolls from a small cache resident table, the game loop ceiling.
+        */
+        inline double game_ceiling(board_t const& board, std::uint64_t moves) {
+            struct replay_dice_t {
+                std::vector<std::tuple<std::int8_t, std::int8_t, std::int8_t>> rolls;
+                std::size_t next = 0;
+                std::tuple<std::int8_t, std::int8_t, std::int8_t> roll() { return rolls[next++ & (4096 - 1)]; }
+            } replay;
+            the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>> dice(6, 2016);
+            for (auto i = 0; i < 4096; ++i) replay.rolls.push_back(dice.roll());
+
+            auto const start = std::chrono::steady_clock::now();
+            auto const counts = play_moves(board, replay, moves);
+            return counts.moves / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        /*! @internal @brief Bytes per second which threads streaming copies sustain together, the memory ceiling.
+        */
+        inline double memory_ceiling(unsigned threads) {
+            std::size_t const length = std::size_t{ 32 } * 1024 * 1024;
+            auto const passes = 4;
+            auto const timed = run_workers(threads, [length](unsigned) {
+                std::unique_ptr<char[]> from(new char[length]), to(new char[length]);
+                std::memset(from.get(), 1, length);
+                std::memset(to.get(), 0, length);
+                for (auto i = 0; i < passes; ++i)
+                    std::memcpy(to.get(), from.get(), length);
+                return scaling_counts_t{ 0, 0, static_cast<std::uint64_t>(to[length - 1]) };
+            });
+            return 2. * length * (passes + 1) * threads / timed.second;//! @internal the initial memsets write both arrays once
+        }
+
+        template<typename Engine> char const* engine_name();
+        template<> inline char const* engine_name<std::mt19937>() { return "mt19937"; }
+        template<> inline char const* engine_name<std::mt19937_64>() { return "mt19937_64"; }
+        template<> inline char const* engine_name<std::minstd_rand>() { return "minstd_rand"; }
+
+        template<typename Dice>
+        std::unique_ptr<Dice> make_scaling_dice(std::true_type /*buffered*/, std::size_t buffer_length, unsigned) {
+            return std::unique_ptr<Dice>(new Dice(6, buffer_length));
+        }
+
+        template<typename Dice>
+        std::unique_ptr<Dice> make_scaling_dice(std::false_type /*buffered*/, std::size_t, unsigned worker) {
+            return std::unique_ptr<Dice>(new Dice(6, worker + 1));
+        }
+
+        /*! @internal @brief Sweeps the thread counts of one (engine, buffer mode, board).
+        */
+        template<typename Engine, bool Buffered>
+        void sweep_threads(board_t const& board, length_t side, double rng_rate, double game_rate,
+            std::map<unsigned, double> const& bandwidth, scaling_config_t const& config, std::vector<scaling_row_t>& rows) {
+            using single_t = the_learning_games::dice_t<std::int8_t, Engine>;
+            using scaled_dice_t = the_learning_games::upto3_dice_t<std::conditional_t<Buffered, the_learning_games::fixed_buffer_dice_t<single_t>, single_t>>;
+
+            auto counts = config.threads;
+            std::sort(counts.begin(), counts.end());
+            counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+            double baseline_rate = 0;//! @internal rolls per second per thread of counts.front()
+            for (auto threads : counts) {
+                auto const timed = run_workers(threads, [&](unsigned worker) {
+                    auto dice = make_scaling_dice<scaled_dice_t>(std::integral_constant<bool, Buffered>{}, config.dice_buffer_length, worker);
+                    return play_moves(board, *dice, config.moves_per_thread);
+                });
+
+                scaling_row_t row;
+                row.engine = engine_name<Engine>();
+                row.buffered = Buffered;
+                row.side = side;
+                row.threads = threads;
+                row.games_per_second = timed.first.games / timed.second;
+                row.rolls_per_second = timed.first.rolls / timed.second;
+                row.bytes_per_second = Buffered ? 2. * sizeof(std::int8_t) * row.rolls_per_second : 0.;
+                if (threads == counts.front()) baseline_rate = row.rolls_per_second / threads;
+                row.efficiency = baseline_rate > 0 ? row.rolls_per_second / (threads * baseline_rate) : 0.;
+
+                auto const per_thread_rolls = row.rolls_per_second / threads;
+                auto const per_thread_moves = static_cast<double>(timed.first.moves) / timed.second / threads;
+                row.rng = per_thread_rolls / rng_rate;
+                row.game = per_thread_moves / game_rate;
+                row.memory = row.bytes_per_second / bandwidth.at(threads);
+
+                auto const cpu_demand = threads * (Buffered ? 2u : 1u);
+                auto const busiest = std::max({ row.rng, row.game, row.memory });
+                if (busiest >= 0.75)
+                    row.bottleneck = busiest == row.memory ? "memory" : busiest == row.rng ? "rng" : "game loop";
+                else if (cpu_demand > config.cpus)
+                    row.bottleneck = "cpu quota";
+                else
+                    row.bottleneck = row.efficiency < 0.75 ? "contention" : busiest == row.rng ? "rng" : "game loop";
+                rows.push_back(row);
+            }
+        }
+
+        template<typename Engine>
+        void sweep_engine(std::vector<scaling_row_t>& rows, scaling_config_t const& config, std::map<unsigned, double> const& bandwidth) {
+            auto const rng_rate = rng_ceiling<Engine>();
+            for (auto side : config.sides) {
+                board_t const board(random_board_builder(side, static_cast<std::size_t>(side) * side / 10, side));
+                auto const game_rate = game_ceiling(board, config.moves_per_thread);
+                sweep_threads<Engine, false>(board, side, rng_rate, game_rate, bandwidth, config, rows);
+                sweep_threads<Engine, true>(board, side, rng_rate, game_rate, bandwidth, config, rows);
+            }
+        }
+    }
+
+    /*! @brief Measures every combination of dice engine, buffer mode, board side & thread count.
+        @details Before the sweep each resource is measured on its own: the rng as single die rolls per second of one
+        thread, the game loop as moves per second replaying cached rolls & the memory as streaming copy bandwidth at each
+        thread count. Each configuration is then placed against these ceilings, roofline style.
+    */
+    inline std::vector<scaling_row_t> run_scaling_sweep(scaling_config_t const& config) {
+        std::map<unsigned, double> bandwidth;
+        for (auto threads : config.threads)
+            bandwidth[threads] = detail::memory_ceiling(threads);
+
+        std::vector<scaling_row_t> rows;
+        detail::sweep_engine<std::mt19937>(rows, config, bandwidth);
+        detail::sweep_engine<std::mt19937_64>(rows, config, bandwidth);
+        detail::sweep_engine<std::minstd_rand>(rows, config, bandwidth);
+        return rows;
+    }
+
+    /*! @brief Prints the scaling efficiency table, one row per configuration.
+    */
+    inline std::ostream& operator<< (std::ostream& os, std::vector<scaling_row_t> const& rows) {
+        os << std::left << std::setw(12) << "engine" << std::setw(9) << "buffer" << std::right << std::setw(5) << "side"
+            << std::setw(8) << "threads" << std::setw(12) << "games/s" << std::setw(12) << "rolls/s" << std::setw(10) << "MB/s"
+            << std::setw(7) << "eff" << std::setw(6) << "rng" << std::setw(6) << "game" << std::setw(6) << "mem" << "  bottleneck\n";
+        for (auto const& r : rows) {
+            auto percent = [](double v) { return static_cast<int>(100 * v + 0.5); };
+            os << std::left << std::setw(12) << r.engine << std::setw(9) << (r.buffered ? "buffered" : "inline") << std::right
+                << std::setw(5) << int{ r.side } << std::setw(8) << r.threads << std::fixed << std::setprecision(0)
+                << std::setw(12) << r.games_per_second << std::setw(12) << r.rolls_per_second << std::setw(10) << r.bytes_per_second / 1e6
+                << std::setprecision(2) << std::setw(7) << r.efficiency << std::setw(5) << percent(r.rng) << "%"
+                << std::setw(5) << percent(r.game) << "%" << std::setw(5) << percent(r.memory) << "%  " << r.bottleneck << "\n";
+        }
+        return os << std::defaultfloat;
+    }
+}
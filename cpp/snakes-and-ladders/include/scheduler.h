@@ -0,0 +1,467 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "include\statistics.h"
+#include "simulation.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+    //! Identifies the owner of jobs in a job_scheduler_t, who is entitled to a share of its workers.
+    using tenant_id_t = std::uint32_t;
+
+    /*! @brief Predicts the cost of a simulation job from the features of its board & corrects itself from past runs.
+        @details A job costs about games x moves per game x nanoseconds per move. The moves per game of a board
+        that has run before are the exact mean of its past games, keyed by (board hash, players, sides); those of a
+        new board come from its features: players x the cells to cross over the mean advance of a move, jumps
+        included, plus the rolls spent waiting for an exact throw at the end. The nanoseconds per move are a moving
+        average of every measured run, kept apart for boards with & without special cells, whose rules slow the move
+        down. Safe to use from any number of threads.
+    */
+    class job_cost_model_t {
+    public:
+        /*! @brief What the model needs to know of a job, computed once per job by profile().
+        */
+        struct profile_t {
+            std::uint64_t key;//! Identifies the (board, players, sides) of the job.
+            double feature_moves;//! Moves per game predicted from the board features alone.
+            bool rules;//! The board has special cells.
+        };
+
+    private:
+        struct history_t {
+            double moves = 0;
+            double games = 0;
+        };
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, history_t> history;
+        double ns_per_move[2] = { 25., 50. };//! @internal [rules]
+        double const smoothing;
+
+    public:
+        /*! @param smoothing Weight of the latest measurement in the moving average of the cost of a move.
+        */
+        explicit job_cost_model_t(double smoothing = 0.2) : smoothing(smoothing) {
+            if (!(smoothing > 0 && smoothing <= 1)) throw std::logic_error("pre: smoothing not in (0, 1]");
+        }
+
+        /*! @brief Returns the profile of games of players on board, rolling upto 3 dice of sides.
+        */
+        static profile_t profile(board_t const& board, player_id_t players, std::int8_t sides) {
+            auto const cells = static_cast<double>(board.end() - board.begin());
+            auto displacement = 0.;//! @internal summed over the cells, a move lands on each about equally often
+            for (auto c = board.begin(); c != board.end(); ++c)
+                displacement += board.advance(c, 0) - c;
+            auto const n = static_cast<double>(sides);
+            auto const advance = std::max((n + 1) / 2 * (1 + 1 / n + 1 / (n * n)) + displacement / cells, .5);
+
+            auto key = board_hash(board);
+            key = detail::mix_seed(key, static_cast<std::uint64_t>(players) << 8 | static_cast<std::uint8_t>(sides));
+            return{ key, players * ((cells - 1) / advance + n), board.has_rules() };
+        }
+
+        /*! @brief Returns the expected number of calls to game_t::move() per game of profile.
+        */
+        double moves_per_game(profile_t const& profile) const {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto const found = history.find(profile.key);
+            return found == history.end() ? profile.feature_moves : found->second.moves / found->second.games;
+        }
+
+        /*! @brief Returns the expected nanoseconds of a worker to simulate games games of profile.
+        */
+        double estimate_ns(profile_t const& profile, std::uint64_t games) const {
+            auto const moves = moves_per_game(profile);
+            std::lock_guard<std::mutex> guard(mutex);
+            return static_cast<double>(games) * moves * ns_per_move[profile.rules];
+        }
+
+        /*! @brief Learns from a measured run of games games of profile which took moves moves in seconds.
+        */
+        void observe(profile_t const& profile, std::uint64_t games, std::uint64_t moves, double seconds) {
+            if (!games || !moves) return;
+            std::lock_guard<std::mutex> guard(mutex);
+            auto& h = history[profile.key];
+            h.games += static_cast<double>(games);
+            h.moves += static_cast<double>(moves);
+            auto& rate = ns_per_move[profile.rules];
+            rate += smoothing * (seconds * 1e9 / static_cast<double>(moves) - rate);
+        }
+
+        std::size_t boards() const {//! @brief Returns the number of (board, players, sides) with a history.
+            std::lock_guard<std::mutex> guard(mutex);
+            return history.size();
+        }
+    };
+
+    /*! @brief Parameters of a job_scheduler_t.
+    */
+    struct scheduler_config_t {
+        unsigned threads = 1;//! Workers of the shared pool.
+        double slice_seconds = 2e-3;//! Estimated cost of a slice, the longest a job holds a worker before it may be preempted.
+    };
+
+    /*! @brief The queue, wait & throughput measurements of a tenant.
+    */
+    struct tenant_metrics_t {
+        tenant_id_t tenant = 0;
+        double share = 1;//! Relative weight in the fair share.
+        std::size_t queued = 0;//! Jobs submitted but not complete.
+        std::uint64_t completed = 0;//! Jobs complete.
+        std::uint64_t failed = 0;//! Jobs whose future holds the exception of one of their chunks.
+        std::uint64_t slices = 0;//! Slices run.
+        double backlog_seconds = 0;//! Estimated worker time of the slices not yet started.
+        double busy_seconds = 0;//! Measured worker time of the slices run.
+        the_learning_games::log_histogram_t wait_ns;//! From the submission of a job to the start of its first slice.
+        the_learning_games::log_histogram_t latency_ns;//! From the submission of a job to its result.
+    };
+
+    /*! @brief The measurements of a job_scheduler_t, @see job_scheduler_t::metrics()
+    */
+    struct scheduler_metrics_t {
+        std::size_t queued = 0;//! Jobs submitted but not complete, of every tenant.
+        unsigned running = 0;//! Slices being run.
+        double estimated_seconds = 0;//! What the cost model predicted for the slices run.
+        double measured_seconds = 0;//! What the slices run took.
+        std::vector<tenant_metrics_t> tenants;//! In tenant order.
+    };
+
+    /*! @brief Runs simulate() jobs of many tenants on a shared pool of workers, big jobs a slice at a time.
+        @details A job is cut into the independently seeded chunks of simulate() & a worker claims a slice of its
+        next chunks sized by the job_cost_model_t to take about config.slice_seconds. The chunk results merge through
+        a the_learning_games::reduction_tree_t, so the result is bit identical to simulate() with the same config
+        whatever the slicing, the thread count & the interleaving with other jobs.
+        Between slices every worker picks again: the tenant furthest behind its share of the worker time, then that
+        tenant's job of highest priority, shortest estimated remaining work first. A tenant's virtual time advances by
+        the worker time of its slices over its share, estimated when a slice is claimed & corrected once it is measured.
+        A tenant that has been idle starts level with the busiest ones, so it can't bank credit while idle. A small job
+        so waits for at most the slices in progress, however much work other tenants have queued. A steady stream of
+        shorter jobs of a tenant can delay its longer jobs of the same priority, never other tenants' jobs.
+        Idle workers take further slices of the same job, so a lone job still uses the whole pool.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    class job_scheduler_t {
+        using steady_clock_t = std::chrono::steady_clock;
+
+        struct job_t {
+            board_t board;
+            simulation_config_t config;
+            job_cost_model_t::profile_t profile;
+            int priority;
+            std::uint64_t sequence;
+            std::uint64_t chunks;
+            std::uint64_t next_chunk = 0;//! @internal chunks before it are claimed
+            double chunk_ns;//! @internal the estimated cost of a chunk, measured after the first slice
+            the_learning_games::reduction_tree_t<simulation_result_t> tree;
+            std::promise<simulation_result_t> promise;
+            steady_clock_t::time_point submitted;
+            bool started = false;
+            bool failed = false;//! @internal a chunk threw, the promise holds its exception
+
+            job_t(board_t const& board, simulation_config_t const& config, std::uint64_t chunks) :
+                board(board),
+                config(config),
+                chunks(chunks),
+                tree(chunks, detail::memory_of(config))
+            {}
+
+            double remaining_ns() const { return static_cast<double>(chunks - next_chunk) * chunk_ns; }
+        };
+
+        struct tenant_t {
+            double share = 1;
+            double pass = 0;//! @internal virtual time, worker nanoseconds over share
+            std::vector<std::shared_ptr<job_t>> runnable;//! @internal jobs with unclaimed chunks
+            tenant_metrics_t metrics;
+        };
+
+        struct slice_t {
+            std::shared_ptr<job_t> job;
+            tenant_id_t tenant;
+            std::uint64_t first;
+            std::uint64_t last;
+            double estimated_ns;
+        };
+
+        job_cost_model_t& model;
+        scheduler_config_t const config;
+        std::mutex mutex;
+        std::condition_variable work;
+        std::condition_variable idle;
+        std::map<tenant_id_t, tenant_t> tenants;
+        double virtual_time = 0;//! @internal the pass of the last tenant picked, never decreases
+        std::uint64_t sequence = 0;
+        std::size_t queued = 0;
+        unsigned running = 0;
+        double estimated_seconds = 0;
+        double measured_seconds = 0;
+        bool stopping = false;
+        std::vector<std::future<void>> workers;
+
+    public:
+        /*! @param model Predicts the cost of the jobs & learns from their runs. Must outlive *this, may be shared.
+        */
+        job_scheduler_t(job_cost_model_t& model, scheduler_config_t const& config) :
+            model(model),
+            config(config)
+        {
+            if (!(config.slice_seconds > 0)) throw std::logic_error("pre: slice length not positive");
+            for (auto i = 0u; i < std::max(config.threads, 1u); ++i)
+                workers.emplace_back(std::async(std::launch::async, [this]() { work_loop(); }));
+        }
+
+        job_scheduler_t(job_scheduler_t const&) = delete;
+        job_scheduler_t& operator=(job_scheduler_t const&) = delete;
+
+        /*! @brief Stops the workers once their current slices are done. The futures of unfinished jobs throw std::future_error.
+        */
+        ~job_scheduler_t() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                stopping = true;
+            }
+            work.notify_all();
+            for (auto& w : workers) w.wait();
+        }
+
+        /*! @brief Sets the weight of tenant in the fair share, 1 unless set.
+        */
+        void set_share(tenant_id_t tenant, double share) {
+            if (!(share > 0)) throw std::logic_error("pre: share not positive");
+            std::lock_guard<std::mutex> guard(mutex);
+            tenants[tenant].share = share;
+        }
+
+        /*! @brief Queues simulate(board, config) for tenant.
+            @param priority Jobs of higher priority run first among the jobs of the same tenant.
+            @details config.threads is ignored, every job may use the whole pool. The board is copied.
+            @return Returns the future result, the same as that of simulate(board, config). If a chunk throws, the future
+            throws that exception & the chunks of the job not yet claimed are dropped.
+        */
+        std::future<simulation_result_t> submit(tenant_id_t tenant, board_t const& board, simulation_config_t const& config, int priority = 0) {
+            if (config.players < 1) throw std::logic_error("pre: player count less than one");
+            if (config.games_per_chunk == 0) throw std::logic_error("pre: chunk size is zero");
+            if (config.sides < 1) throw std::logic_error("pre: sides less than one");
+
+            auto const chunks = std::max<std::uint64_t>((config.games + config.games_per_chunk - 1) / config.games_per_chunk, 1);
+            auto job = std::make_shared<job_t>(board, config, chunks);
+            job->profile = job_cost_model_t::profile(job->board, config.players, config.sides);
+            job->priority = priority;
+            job->chunk_ns = std::max(model.estimate_ns(job->profile, config.games_per_chunk), 1.);
+            auto rc = job->promise.get_future();
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                auto& t = tenants[tenant];
+                if (t.runnable.empty())
+                    t.pass = std::max(t.pass, virtual_time);
+                job->sequence = sequence++;
+                job->submitted = steady_clock_t::now();
+                t.runnable.push_back(std::move(job));
+                ++t.metrics.queued;
+                ++queued;
+            }
+            work.notify_one();
+            return rc;
+        }
+
+        /*! @brief Blocks until every job submitted so far is complete.
+        */
+        void drain() {
+            std::unique_lock<std::mutex> lock(mutex);
+            idle.wait(lock, [this]() { return queued == 0; });
+        }
+
+        /*! @brief Returns a consistent copy of the queue, wait & cost measurements.
+        */
+        scheduler_metrics_t metrics() {
+            std::lock_guard<std::mutex> guard(mutex);
+            scheduler_metrics_t rc;
+            rc.queued = queued;
+            rc.running = running;
+            rc.estimated_seconds = estimated_seconds;
+            rc.measured_seconds = measured_seconds;
+            for (auto const& t : tenants) {
+                rc.tenants.push_back(t.second.metrics);
+                auto& m = rc.tenants.back();
+                m.tenant = t.first;
+                m.share = t.second.share;
+                m.backlog_seconds = 0;
+                for (auto const& job : t.second.runnable) m.backlog_seconds += job->remaining_ns() * 1e-9;
+            }
+            return rc;
+        }
+
+    private:
+        /*! @internal @brief Claims the next slice by fair share, priority & remaining work. Call with mutex held.
+        */
+        bool claim(slice_t& slice) {
+            auto tenant = tenants.end();
+            for (auto t = tenants.begin(); t != tenants.end(); ++t)
+                if (!t->second.runnable.empty() && (tenant == tenants.end() || t->second.pass < tenant->second.pass))
+                    tenant = t;
+            if (tenant == tenants.end()) return false;
+
+            auto& t = tenant->second;
+            auto const job = std::min_element(t.runnable.begin(), t.runnable.end(), [](std::shared_ptr<job_t> const& a, std::shared_ptr<job_t> const& b) {
+                if (a->priority != b->priority) return a->priority > b->priority;
+                if (a->remaining_ns() != b->remaining_ns()) return a->remaining_ns() < b->remaining_ns();
+                return a->sequence < b->sequence;
+            });
+            auto& j = **job;
+            auto const count = std::min(j.chunks - j.next_chunk, std::max<std::uint64_t>(static_cast<std::uint64_t>(config.slice_seconds * 1e9 / j.chunk_ns), 1));
+            slice = { *job, tenant->first, j.next_chunk, j.next_chunk + count, static_cast<double>(count) * j.chunk_ns };
+
+            if (!j.started) {
+                j.started = true;
+                t.metrics.wait_ns.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock_t::now() - j.submitted).count()));
+            }
+            j.next_chunk = slice.last;
+            if (j.next_chunk == j.chunks) t.runnable.erase(job);
+
+            virtual_time = std::max(virtual_time, t.pass);
+            t.pass += slice.estimated_ns / t.share;
+            ++running;
+            return true;
+        }
+
+        /*! @internal @brief Runs the chunks of slice, returns true if it completed its job.
+        */
+        bool run(slice_t const& slice, std::uint64_t& games, std::uint64_t& moves) {
+            auto& job = *slice.job;
+            auto complete = false;
+            for (auto chunk = slice.first; chunk != slice.last; ++chunk) {
+                auto const first_game = chunk * job.config.games_per_chunk;
+                auto const chunk_games = std::min(job.config.games_per_chunk, job.config.games - std::min(first_game, job.config.games));
+                auto const chunk_seed = detail::mix_seed(job.config.seed, chunk);
+                Dice dice(job.config.sides, chunk_seed);
+                auto result = simulate_chunk(job.board, job.config, dice, chunk_games, chunk_seed);
+                games += chunk_games;
+                moves += static_cast<std::uint64_t>(result.turns.sum());
+                complete = job.tree.submit(chunk, std::move(result));
+            }
+            return complete;
+        }
+
+        void work_loop() {
+            for (;;) {
+                slice_t slice;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    work.wait(lock, [&]() { return stopping || claim(slice); });
+                    if (stopping) return;
+                }
+
+                auto const start = steady_clock_t::now();
+                std::uint64_t games = 0, moves = 0;
+                auto complete = false;
+                std::exception_ptr error;
+                try {
+                    complete = run(slice, games, moves);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+                auto const finish = steady_clock_t::now();
+                auto const seconds = std::chrono::duration<double>(finish - start).count();
+                if (!error) model.observe(slice.job->profile, games, moves, seconds);
+
+                auto fail = false;//! @internal this slice is the first of its job to throw
+
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    auto& t = tenants[slice.tenant];
+                    t.pass += (seconds * 1e9 - slice.estimated_ns) / t.share;
+                    ++t.metrics.slices;
+                    t.metrics.busy_seconds += seconds;
+                    estimated_seconds += slice.estimated_ns * 1e-9;
+                    measured_seconds += seconds;
+                    if (!error) slice.job->chunk_ns = std::max(seconds * 1e9 / static_cast<double>(slice.last - slice.first), 1.);
+                    --running;
+                    if (error && !slice.job->failed) {//! @internal the job can't complete, so it leaves the queue now
+                        fail = slice.job->failed = true;
+                        auto const job = std::find(t.runnable.begin(), t.runnable.end(), slice.job);
+                        if (job != t.runnable.end()) t.runnable.erase(job);
+                        ++t.metrics.failed;
+                        --t.metrics.queued;
+                        --queued;
+                    }
+                    if (complete) {
+                        t.metrics.latency_ns.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - slice.job->submitted).count()));
+                        ++t.metrics.completed;
+                        --t.metrics.queued;
+                        --queued;
+                    }
+                }
+                if (complete) {
+                    slice.job->promise.set_value(slice.job->tree.result());
+                    idle.notify_all();
+                }
+                if (fail) {
+                    slice.job->promise.set_exception(error);
+                    idle.notify_all();
+                }
+                work.notify_one();//! @internal the job may have chunks left that another worker can take
+            }
+        }
+    };
+
+    /*! @brief Prints one row per tenant, wait & latency quantiles in milliseconds.
+    */
+    inline std::ostream& operator<< (std::ostream& os, scheduler_metrics_t const& metrics) {
+        auto ms = [](std::uint64_t ns) { return static_cast<double>(ns) / 1e6; };
+        os << std::setw(8) << "tenant" << std::setw(8) << "share" << std::setw(8) << "jobs" << std::setw(8) << "queued"
+            << std::setw(10) << "busy s" << std::setw(10) << "wait p50" << std::setw(10) << "wait p99"
+            << std::setw(10) << "lat p50" << std::setw(10) << "lat p99" << "\n";
+        for (auto const& t : metrics.tenants) {
+            os << std::fixed << std::setprecision(2)
+                << std::setw(8) << t.tenant << std::setw(8) << t.share << std::setw(8) << t.completed << std::setw(8) << t.queued
+                << std::setw(10) << t.busy_seconds << std::setprecision(1)
+                << std::setw(10) << ms(t.wait_ns.quantile(.5)) << std::setw(10) << ms(t.wait_ns.quantile(.99))
+                << std::setw(10) << ms(t.latency_ns.quantile(.5)) << std::setw(10) << ms(t.latency_ns.quantile(.99)) << "\n";
+        }
+        return os << std::setprecision(2) << "estimated / measured worker time " << metrics.estimated_seconds << " / " << metrics.measured_seconds << " s\n" << std::defaultfloat;
+    }
+}
@@ -0,0 +1,357 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include "include\dice.h"
+#include "include\memory_accounting.h"
+#include "replication.h"
+#include "spectator.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+    //! Identifies a live game in a session_store_t.
+    using session_id_t = std::uint32_t;
+
+    /*! @brief The outcome of a single session_store_t::play_turn().
+    */
+    struct turn_result_t {
+        cell_offset_t roll[3];//! The up to 3 offsets that were moved.
+        player_id_t player;//! The player who moved.
+        cell_iterator_t from;//! The position of player before the move.
+        cell_iterator_t position;//! The position of player after the move.
+        game_state_t state;//! The state of the game after the move.
+    };
+
+    /*! @brief A fixed capacity store of live games sharing one board.
+        @details Every session owns its game_t, its dice & its own mutex, so requests against different sessions never
+        contend. Sessions are addressed by slot index; a closed slot is recycled by the next open().
+        A store may stream its sessions to a hot standby store in another process, @see replicate() & follow(). The
+        standby replays every move, its dice included, so Dice must be a deterministic function of its seed.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>>
+    class session_store_t {
+        struct session_t {
+            std::mutex mutex;
+            std::optional<game_t> game;//! @internal empty while the slot is free
+            std::unique_ptr<Dice> dice;
+            std::shared_ptr<game_feed_t> feed;//! @internal null until the first spectator arrives
+            std::uint64_t turns = 0;
+            std::uint64_t rolls = 0;//! @internal drawn from dice since open, the dice stream position of a snapshot
+            std::mt19937::result_type seed = 0;
+        };
+
+        board_t const& board;
+        the_learning_games::memory_charge_t const charge;//! @internal the slots, charged to memory_component_t::sessions
+        std::unique_ptr<session_t[]> sessions;
+        session_id_t const capacity_;
+        std::int8_t const sides;
+        std::mutex free_mutex;
+        std::vector<session_id_t> free_slots;
+        std::atomic<replication_log_t*> log{ nullptr };
+
+    public:
+        /*! @param board The board every session plays on. Must outlive *this.
+            @param capacity The maximum number of concurrently open sessions.
+            @param sides The number of sides of the session dice.
+        */
+        session_store_t(board_t const& board, session_id_t capacity, std::int8_t sides = 6) :
+            board(board),
+            charge(the_learning_games::memory_component_t::sessions, capacity * sizeof(session_t)),
+            sessions(new session_t[capacity]),
+            capacity_(capacity),
+            sides(sides)
+        {
+            free_slots.reserve(capacity);
+            for (auto id = capacity; id--;)
+                free_slots.push_back(id);
+        }
+
+        /*! @brief Opens a new game.
+            @param players The number of players.
+            @param seed Seeds the dice of the session.
+            @throws std::runtime_error If every slot is in use.
+        */
+        session_id_t open(player_id_t players, std::mt19937::result_type seed) {
+            session_id_t id;
+            {
+                std::lock_guard<std::mutex> guard(free_mutex);
+                if (free_slots.empty()) throw std::runtime_error("session store full");
+                id = free_slots.back();
+                free_slots.pop_back();
+            }
+            auto& session = sessions[id];
+            std::lock_guard<std::mutex> guard(session.mutex);
+            reopen(session, players, seed);
+            append(replication_record_t::opened(id, players, seed));
+            return id;
+        }
+
+        /*! @brief Closes a game & recycles its slot.
+        */
+        void close(session_id_t id) {
+            {
+                auto& session = at(id);
+                std::lock_guard<std::mutex> guard(session.mutex);
+                if (!session.game) throw std::logic_error("pre: session not open");
+                session.game.reset();
+                session.dice.reset();
+                session.feed.reset();//! @internal spectators keep their reference until they disconnect
+                append({ id, replication_kind_t::close, { 0, 0, 0 }, 0 });
+            }
+            std::lock_guard<std::mutex> guard(free_mutex);
+            free_slots.push_back(id);
+        }
+
+        /*! @brief Rolls the session dice & moves the current player.
+            @param rematch_finished If true & the game has finished, a new game with the same number of players is
+            started first. Lets clients which share a session keep playing without racing on close() / open().
+            @throws std::logic_error If the session is not open or its game has finished.
+        */
+        turn_result_t play_turn(session_id_t id, bool rematch_finished = false) {
+            auto& session = at(id);
+            std::lock_guard<std::mutex> guard(session.mutex);
+            if (!session.game) throw std::logic_error("pre: session not open");
+            auto kind = replication_kind_t::turn;
+            if (rematch_finished && !*session.game) {
+                rematch(id, session);
+                kind = replication_kind_t::rematch_turn;
+            }
+            auto const roll = session.dice->roll();
+            ++session.rolls;
+            return move_locked(id, session, std::get<0>(roll), std::get<1>(roll), std::get<2>(roll), kind);
+        }
+
+        /*! @brief Moves the current player by a roll made elsewhere, e.g. by the client.
+            @throws std::logic_error If the session is not open or its game has finished.
+        */
+        turn_result_t move(session_id_t id, cell_offset_t first, cell_offset_t second, cell_offset_t third) {
+            auto& session = at(id);
+            std::lock_guard<std::mutex> guard(session.mutex);
+            if (!session.game) throw std::logic_error("pre: session not open");
+            return move_locked(id, session, first, second, third, replication_kind_t::move);
+        }
+
+        /*! @brief Returns the feed of a session's moves, creating it on the first call.
+            Each move is published once, however many spectator_t read the feed.
+        */
+        std::shared_ptr<game_feed_t const> spectate(session_id_t id) {
+            auto& session = at(id);
+            std::lock_guard<std::mutex> guard(session.mutex);
+            if (!session.game) throw std::logic_error("pre: session not open");
+            if (!session.feed) session.feed = std::make_shared<game_feed_t>(*session.game);
+            return session.feed;
+        }
+
+        /*! @brief Returns the number of turns played in the session.
+        */
+        std::uint64_t turns(session_id_t id) {
+            auto& session = at(id);
+            std::lock_guard<std::mutex> guard(session.mutex);
+            return session.turns;
+        }
+
+        session_id_t capacity() const { return capacity_; }//! @brief Returns the maximum number of open sessions.
+
+        /*! @brief Streams every change of the sessions to log, or stops streaming if log is null.
+            @details Appends a snapshot of every open session, then the operations as they happen, under the session's
+            mutex so that each session's entries are in order. An operation racing with the snapshot of its session may
+            precede the snapshot; the standby ignores it, since the snapshot already includes it.
+            @param log The log of the standby. Must outlive the replication.
+        */
+        void replicate(replication_log_t* log) {
+            this->log.store(log, std::memory_order_release);
+            if (!log) return;
+            for (session_id_t id = 0; id != capacity_; ++id) {
+                auto& session = sessions[id];
+                std::lock_guard<std::mutex> guard(session.mutex);
+                if (!session.game) continue;
+                auto const& game = *session.game;
+                auto const players = static_cast<player_id_t>(game.all_player_positions().size());
+                auto open = replication_record_t::opened(id, players, session.seed);
+                open.kind = replication_kind_t::snapshot;
+                open.roll[0] = static_cast<std::int8_t>(game ? game_state_t::running : game_state_t::finished);
+                open.value |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(game.current_player())) << 48;
+                log->append(open);
+                log->append({ id, replication_kind_t::snapshot_dice, { 0, 0, 0 }, session.rolls });
+                log->append({ id, replication_kind_t::snapshot_turns, { 0, 0, 0 }, session.turns });
+                log->append({ id, replication_kind_t::snapshot_rules, { 0, 0, 0 }, game.rule_state() });
+                for (player_id_t p = 0; p != players; ++p) {
+                    log->append({ id, replication_kind_t::snapshot_player, { 0, 0, 0 }, static_cast<std::uint64_t>(static_cast<std::uint16_t>(p)) |
+                        static_cast<std::uint64_t>(static_cast<std::uint16_t>(game.player_position(p))) << 16 |
+                        static_cast<std::uint64_t>(game.skips_next_turn(p)) << 32 });
+                }
+            }
+        }
+
+        /*! @brief Applies the pending entries of a primary's log to this standby store.
+            @details The standby calls follow() in a loop until log.handed_over() & log.lag() is 0, then serves the
+            sessions itself. It must not serve them before, nor replicate() to the same log.
+            @param max_entries Applies at most this many entries.
+            @return Returns the number of entries applied.
+            @throws std::runtime_error If the log overran, or the standby's dice diverged from the primary's.
+        */
+        std::size_t follow(replication_log_t& log, std::size_t max_entries = ~std::size_t{}) {
+            if (log.overrun()) throw std::runtime_error("replication: log overrun, the standby must restart from a snapshot");
+            std::size_t rc = 0;
+            replication_record_t record;
+            while (rc != max_entries && log.next(record)) {
+                apply(record);
+                ++rc;
+            }
+            return rc;
+        }
+
+    private:
+        static std::pmr::memory_resource* memory() {
+            return the_learning_games::accounted_memory(the_learning_games::memory_component_t::sessions);
+        }
+
+        session_t& at(session_id_t id) {
+            if (id >= capacity_) throw std::out_of_range("session id out of range");
+            return sessions[id];
+        }
+
+        void reopen(session_t& session, player_id_t players, std::mt19937::result_type seed) {
+            session.game.emplace(board, players, seed, memory());
+            session.dice.reset(new Dice(sides, seed));
+            session.turns = 0;
+            session.rolls = 0;
+            session.seed = seed;
+        }
+
+        void rematch(session_id_t id, session_t& session) {
+            auto const players = static_cast<player_id_t>(session.game->all_player_positions().size());
+            session.game.emplace(board, players, session.turns, memory());
+            if (session.feed) session.feed->reset(*session.game, id);
+        }
+
+        void append(replication_record_t const& record) {
+            if (auto const log = this->log.load(std::memory_order_acquire)) log->append(record);
+        }
+
+        /*! @internal @brief Replays an entry of the primary's log.
+        */
+        void apply(replication_record_t const& record) {
+            auto const id = record.session;
+            auto& session = at(id);
+            std::unique_lock<std::mutex> guard(session.mutex);
+            auto const players = static_cast<player_id_t>(record.value >> 32);
+            auto const seed = static_cast<std::mt19937::result_type>(record.value & 0xffffffffu);
+
+            switch (record.kind) {
+            case replication_kind_t::open:
+            case replication_kind_t::snapshot:
+                if (!session.game) {
+                    std::lock_guard<std::mutex> free_guard(free_mutex);
+                    free_slots.erase(std::remove(free_slots.begin(), free_slots.end(), id), free_slots.end());
+                }
+                reopen(session, static_cast<player_id_t>(players & 0xffff), seed);
+                if (record.kind == replication_kind_t::snapshot)
+                    session.game->restore(static_cast<player_id_t>(record.value >> 48), static_cast<game_state_t>(record.roll[0] != 0), 0);
+                return;
+            default:
+                break;
+            }
+            if (!session.game) return;//! @internal the operation preceded the session's snapshot, which includes it
+
+            switch (record.kind) {
+            case replication_kind_t::rematch_turn:
+                rematch(id, session);
+                [[fallthrough]];
+            case replication_kind_t::turn: {
+                auto const roll = session.dice->roll();
+                ++session.rolls;
+                if (std::get<0>(roll) != record.roll[0] || std::get<1>(roll) != record.roll[1] || std::get<2>(roll) != record.roll[2])
+                    throw std::runtime_error("replication: the standby's dice diverged from the primary's");
+                move_locked(id, session, record.roll[0], record.roll[1], record.roll[2], record.kind);
+                return;
+            }
+            case replication_kind_t::move:
+                move_locked(id, session, record.roll[0], record.roll[1], record.roll[2], record.kind);
+                return;
+            case replication_kind_t::close:
+                session.game.reset();
+                session.dice.reset();
+                session.feed.reset();
+                guard.unlock();
+                {
+                    std::lock_guard<std::mutex> free_guard(free_mutex);
+                    free_slots.push_back(id);
+                }
+                return;
+            case replication_kind_t::snapshot_dice:
+                for (auto i = record.value; i--;) session.dice->roll();
+                session.rolls = record.value;
+                return;
+            case replication_kind_t::snapshot_turns:
+                session.turns = record.value;
+                return;
+            case replication_kind_t::snapshot_rules:
+                session.game->restore(session.game->current_player(), *session.game ? game_state_t::running : game_state_t::finished, record.value);
+                return;
+            case replication_kind_t::snapshot_player:
+                session.game->restore_player(static_cast<player_id_t>(record.value & 0xffff), static_cast<cell_iterator_t>(record.value >> 16 & 0xffff), (record.value >> 32 & 1) != 0);
+                return;
+            default:
+                throw std::runtime_error("replication: unknown entry");
+            }
+        }
+
+        turn_result_t move_locked(session_id_t id, session_t& session, cell_offset_t first, cell_offset_t second, cell_offset_t third, replication_kind_t kind) {
+            auto& game = *session.game;
+            if (!game) throw std::logic_error("pre: game finished");
+
+            auto const player = game.current_player();
+            turn_result_t rc{ { first, second, third }, player, game.player_position(player), {}, {} };
+            game.move(first, second, third);
+            ++session.turns;
+            rc.position = game.player_position(rc.player);
+            rc.state = game ? game_state_t::running : game_state_t::finished;
+            append({ id, kind, { static_cast<std::int8_t>(first), static_cast<std::int8_t>(second), static_cast<std::int8_t>(third) }, 0 });
+
+            if (session.feed) {
+                session.feed->publish(game_event_t{ id, rc.from, rc.position, rc.player,
+                    { static_cast<std::int8_t>(first), static_cast<std::int8_t>(second), static_cast<std::int8_t>(third) }, rc.state, game.current_player() }, game);
+            }
+            return rc;
+        }
+    };
+}
@@ -0,0 +1,95 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "include\ivf_index.h"
+#include "chain.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    constexpr std::size_t const signature_length_bins = 16;//! Bins of the game length distribution.
+    constexpr std::size_t const signature_heat_bins = 12;//! Bins of where a player's moves end, by progress along the board.
+    constexpr std::size_t const signature_seats = 4;//! Seats whose win rate is kept; later seats are left out.
+    constexpr std::size_t const signature_length = signature_length_bins + signature_heat_bins + signature_seats;
+
+    //! A board's outcome signature, @see board_signature()
+    using board_signature_t = std::array<float, signature_length>;
+
+    //! Finds the boards whose signatures are nearest a query's, @see board_signature()
+    using signature_index_t = the_learning_games::ivf_index_t<signature_length>;
+
+    /*! @brief Returns the signature of the games on board, so that boards which play alike are near in Euclidean distance.
+        @details Three blocks, each a probability distribution summing to 1 so that they weigh alike:
+            - The game length distribution of solve_chain() in geometric bins, bin b holding the games that end within
+              [4 * 1.3^b, 4 * 1.3^(b + 1)) turns, the last bin open ended.
+            - The heat map of a single player: the expected share of its moves ending in each twelfth of the board.
+            - The seat win rates of solve_chain(), zero for the seats a game of config.players doesn't have.
+        @throws std::logic_error As solve_chain().
+    */
+    inline board_signature_t board_signature(board_t const& board, chain_config_t const& config) {
+        board_signature_t rc = {};
+        auto const chain = solve_chain(board, config);
+        for (std::size_t t = 0; t != chain.length.size(); ++t) {
+            auto const turns = static_cast<double>(t + 1);
+            auto const bin = turns < 4 ? 0. : std::floor(std::log(turns / 4) / std::log(1.3));
+            rc[std::min(static_cast<std::size_t>(bin), signature_length_bins - 1)] += static_cast<float>(chain.length[t]);
+        }
+        for (std::size_t p = 0; p != chain.wins.size() && p != signature_seats; ++p)
+            rc[signature_length_bins + signature_heat_bins + p] = static_cast<float>(chain.wins[p]);
+
+        transition_table_t const table(board, config.rolls.empty() ? upto3_roll_distribution(config.sides) : config.rolls);
+        auto const cells = static_cast<std::size_t>(board.end());
+        std::vector<double> current(cells), next(cells), heat(signature_heat_bins);
+        current[0] = 1.;
+        auto in_play = 1., moves = 0.;
+        for (std::uint64_t k = 0; k != config.max_turns && in_play >= config.tolerance; ++k) {
+            std::fill(next.begin(), next.end(), 0.);
+            table.propagate(current, next);
+            for (std::size_t c = 0; c != cells; ++c)
+                heat[c * signature_heat_bins / cells] += next[c];
+            moves += in_play;
+            in_play -= next[cells - 1];
+            next[cells - 1] = 0.;
+            std::swap(current, next);
+        }
+        for (std::size_t b = 0; b != signature_heat_bins; ++b)
+            rc[signature_length_bins + b] = static_cast<float>(heat[b] / moves);
+        return rc;
+    }
+}
@@ -0,0 +1,193 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "include\dice.h"
+#include "include\memory_accounting.h"
+#include "include\statistics.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+    namespace detail {
+        /*! @internal @brief SplitMix64 finalizer, decorrelates the seeds of neighbouring chunks.
+        */
+        inline std::uint64_t mix_seed(std::uint64_t seed, std::uint64_t chunk_id) {
+            auto z = seed + (chunk_id + 1) * 0x9e3779b97f4a7c15ull;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+    }
+
+    /*! @brief Parameters of a simulate() run.
+        @details The result depends on every field except threads & memory.
+    */
+    struct simulation_config_t {
+        player_id_t players = 2;//! Players per game.
+        std::uint64_t games = 1 << 20;//! Total number of games to simulate.
+        std::uint64_t games_per_chunk = 1 << 12;//! Games per independently seeded chunk. Fixes the shape of the merge tree.
+        unsigned threads = 1;//! Worker count, has no influence on the result.
+        std::uint64_t seed = 0;//! Master seed, every chunk derives its own dice seed from it.
+        std::int8_t sides = 6;//! Sides of the dice.
+        std::pmr::memory_resource* memory = nullptr;//! Allocates the merge tree & the game state, e.g. a the_learning_games::job_arena_t. nullptr for the heap, charged to the_learning_games::memory_component_t::simulation.
+    };
+
+    namespace detail {
+        /*! @internal @brief Returns the resource a run of config allocates from.
+        */
+        inline std::pmr::memory_resource* memory_of(simulation_config_t const& config) {
+            return config.memory ? config.memory : the_learning_games::accounted_memory(the_learning_games::memory_component_t::simulation);
+        }
+
+        /*! @internal @brief Per chunk scratch for the state of one game at a time.
+            @details The buffer is taken from upstream once per chunk & rewound before every game, so a chunk makes a single
+            upstream allocation however many games it plays, even when upstream is a job arena that never frees.
+        */
+        class game_scratch_t {
+            std::pmr::vector<std::byte> buffer;
+            std::pmr::monotonic_buffer_resource resource;
+
+        public:
+            game_scratch_t(std::size_t bytes, std::pmr::memory_resource* upstream) :
+                buffer(bytes, upstream),
+                resource(buffer.data(), buffer.size(), upstream)
+            {}
+
+            /*! @internal @brief Frees the state of the previous game. Call once no game allocated from it is alive.
+            */
+            std::pmr::memory_resource* next() {
+                resource.release();
+                return &resource;
+            }
+        };
+    }
+
+    /*! @brief Statistics accumulated over a set of games. Merges exactly, @see the_learning_games::integer_moments_t
+    */
+    struct simulation_result_t {
+        the_learning_games::integer_moments_t turns;//! Game length measured in calls to game_t::move().
+        std::vector<std::uint64_t> wins;//! wins[p] is the number of games won by the player seated at p.
+
+        /*! @brief Merges the games of other into *this.
+        */
+        simulation_result_t& merge(simulation_result_t const& other) {
+            turns.merge(other.turns);
+            if (wins.size() < other.wins.size()) wins.resize(other.wins.size());
+            std::transform(other.wins.begin(), other.wins.end(), wins.begin(), wins.begin(), std::plus<std::uint64_t>{});
+            return *this;
+        }
+    };
+
+    /*! @brief Simulates a single chunk of games with its own dice.
+        @param board A board_t, or a board_schedule_t for a board that changes during the game.
+        @param rule_seed Game i of the chunk seeds its teleport cells from `(rule_seed, i)`.
+    */
+    template<typename Dice, typename Board>
+    simulation_result_t simulate_chunk(Board const& board, simulation_config_t const& config, Dice& dice, std::uint64_t games, std::uint64_t rule_seed = 0) {
+        simulation_result_t rc;
+        rc.wins.resize(config.players);
+        detail::game_scratch_t scratch(game_t::state_bytes(config.players), detail::memory_of(config));
+
+        for (std::uint64_t i = 0; i != games; ++i) {
+            game_t game(board, config.players, detail::mix_seed(rule_seed, i), scratch.next());
+            auto turns = std::int64_t{};
+            while (game) {
+                auto roll = dice.roll();
+                game.move(std::get<0>(roll), std::get<1>(roll), std::get<2>(roll));
+                ++turns;
+            }
+            rc.turns.add(turns);
+            ++rc.wins[game.current_player()];
+        }
+        return rc;
+    }
+
+    namespace detail {
+        /*! @internal @brief Runs kernel over the chunks of config across config.threads workers & merges the results in chunk order.
+            Kernel is called as `kernel(dice, games, rule_seed)` & returns an accumulator such as simulation_result_t.
+        */
+        template<typename Dice, typename Kernel>
+        auto simulate_chunks(simulation_config_t const& config, Kernel kernel) {
+            using result_t = std::decay_t<decltype(kernel(std::declval<Dice&>(), std::uint64_t{}, std::uint64_t{}))>;
+
+            if (config.players < 1) throw std::logic_error("pre: player count less than one");
+            if (config.games_per_chunk == 0) throw std::logic_error("pre: chunk size is zero");
+
+            auto const chunks = std::max<std::uint64_t>((config.games + config.games_per_chunk - 1) / config.games_per_chunk, 1);
+            the_learning_games::reduction_tree_t<result_t> tree(chunks, memory_of(config));
+            std::atomic<std::uint64_t> next_chunk{ 0 };
+
+            auto worker = [&]() {
+                for (auto chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+                    auto const first_game = chunk * config.games_per_chunk;
+                    auto const games = std::min(config.games_per_chunk, config.games - std::min(first_game, config.games));
+                    auto const chunk_seed = mix_seed(config.seed, chunk);
+                    Dice dice(config.sides, chunk_seed);
+                    tree.submit(chunk, kernel(dice, games, chunk_seed));
+                }
+            };
+
+            std::vector<std::future<void>> workers;
+            for (auto i = 1u; i < std::max(config.threads, 1u); ++i)
+                workers.emplace_back(std::async(std::launch::async, worker));
+            worker();
+            for (auto& w : workers) w.get();
+
+            return tree.result();
+        }
+    }
+
+    /*! @brief Simulates config.games games on board across config.threads workers.
+        @details The games are cut into chunks of config.games_per_chunk. Chunk i rolls a Dice seeded from
+        `(config.seed, i)` and its statistics are merged through a the_learning_games::reduction_tree_t keyed by i,
+        so the result is bit identical for any thread count & any scheduling.
+        Dice must be constructible from `(sides, seed)` & roll a tuple of 3 offsets, @see the_learning_games::upto3_dice_t
+        Board is a board_t, or a board_schedule_t for a board that changes during the game.
+    */
+    template<typename Dice = the_learning_games::upto3_dice_t<the_learning_games::dice_t<std::int8_t>>, typename Board>
+    simulation_result_t simulate(Board const& board, simulation_config_t const& config) {
+        return detail::simulate_chunks<Dice>(config, [&](Dice& dice, std::uint64_t games, std::uint64_t rule_seed) {
+            return simulate_chunk(board, config, dice, games, rule_seed);
+        });
+    }
+}
@@ -0,0 +1,231 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "include\broadcast_ring.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief A single move of a live game, packed into 16 bytes.
+    */
+    struct game_event_t {
+        std::uint32_t session;//! The session the game belongs to.
+        cell_iterator_t from;//! Position of player before the move.
+        cell_iterator_t to;//! Position of player after the move.
+        player_id_t player;//! The player who moved.
+        std::int8_t roll[3];//! The up to 3 offsets that were moved.
+        game_state_t state;//! State of the game after the move.
+        player_id_t next_player;//! The player to move next, or the winner. Differs from player + 1 after a special cell.
+    };
+    static_assert(sizeof(game_event_t) == 16, "game_event_t must stay compact");
+
+    /*! @brief The complete state of a spectated game as of a sequence number.
+    */
+    struct game_snapshot_t {
+        std::uint64_t next_sequence = 0;//! Sequence number of the first event not reflected in the snapshot.
+        player_id_t current_player = 0;
+        game_state_t state = game_state_t::running;
+        std::vector<cell_iterator_t> positions;
+    };
+
+    /*! @brief Fan out of the moves of one game to any number of spectators.
+        @details The game's single writer publish()es each move once into a the_learning_games::broadcast_ring_t, which
+        spectators read in place at their own pace. Alongside, publish() keeps a snapshot current by updating the one
+        position that moved. The snapshot is a seqlock like the slots of the ring: a spectator that has fallen a whole
+        ring behind copies it & retries if a move was published meanwhile, so neither a slow spectator nor one that
+        resyncs can ever block the game.
+    */
+    class game_feed_t {
+        the_learning_games::broadcast_ring_t<game_event_t> ring;
+        std::size_t const players;
+        std::atomic<std::uint64_t> version{ 0 };//! @internal odd while the writer updates the snapshot
+        std::unique_ptr<std::atomic<std::uint64_t>[]> words;//! @internal next sequence, current player & state, then 4 positions a word
+
+    public:
+        /*! @param game The game at the time the feed starts.
+            @param capacity Events retained for spectators which fall behind.
+        */
+        game_feed_t(game_t const& game, std::size_t capacity = 1024) :
+            ring(capacity),
+            players(game.all_player_positions().size()),
+            words(new std::atomic<std::uint64_t>[2 + (players + 3) / 4])
+        {
+            for (std::size_t i = 0; i != 2 + (players + 3) / 4; ++i) words[i].store(0, std::memory_order_relaxed);
+            write_all(0, game);
+        }
+
+        /*! @brief Publishes a move. Must be called by the game's single writer, after game_t::move().
+            @param event The move.
+            @param game The game after the move.
+        */
+        void publish(game_event_t const& event, game_t const& game) {
+            auto const sequence = ring.publish(event);
+            auto const v = begin_write();
+            write_header(sequence + 1, game.current_player(), event.state);
+            write_position(static_cast<std::size_t>(event.player), event.to);
+            version.store(v + 2, std::memory_order_release);
+        }
+
+        /*! @brief Publishes a rematch, which resets every position. Spectators see an event with a negative player & resync.
+            @details The snapshot is written before the event is published & already continues after it, so a spectator
+            that resyncs on the rematch can't read it a second time.
+            @throws std::logic_error If game has another number of players than the feed.
+        */
+        void reset(game_t const& game, std::uint32_t session) {
+            if (game.all_player_positions().size() != players) throw std::logic_error("pre: rematch changes the player count");
+            write_all(ring.published() + 1, game);
+            ring.publish(game_event_t{ session, -1, -1, -1, { 0, 0, 0 }, game_state_t::running, game.current_player() });
+        }
+
+        /*! @brief Returns a consistent copy of the game state & the sequence number to continue reading from.
+        */
+        game_snapshot_t snapshot() const {
+            game_snapshot_t rc;
+            rc.positions.resize(players);
+            for (;;) {
+                auto const v = version.load(std::memory_order_acquire);
+                if (v & 1) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                rc.next_sequence = words[0].load(std::memory_order_relaxed);
+                auto const header = words[1].load(std::memory_order_relaxed);
+                rc.current_player = static_cast<player_id_t>(static_cast<std::uint8_t>(header));
+                rc.state = static_cast<game_state_t>((header >> 8) & 1);
+                for (std::size_t p = 0; p != players; ++p)
+                    rc.positions[p] = static_cast<cell_iterator_t>(static_cast<std::uint16_t>(words[2 + p / 4].load(std::memory_order_relaxed) >> (16 * (p % 4))));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (version.load(std::memory_order_relaxed) == v) return rc;
+            }
+        }
+
+        the_learning_games::broadcast_ring_t<game_event_t> const& events() const { return ring; }//! @brief Returns the event ring.
+
+    private:
+        std::uint64_t begin_write() {
+            auto const v = version.load(std::memory_order_relaxed);
+            version.store(v + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            return v;
+        }
+
+        void write_all(std::uint64_t next_sequence, game_t const& game) {
+            auto const v = begin_write();
+            write_header(next_sequence, game.current_player(), game ? game_state_t::running : game_state_t::finished);
+            for (std::size_t p = 0; p != players; ++p) write_position(p, game.all_player_positions()[p]);
+            version.store(v + 2, std::memory_order_release);
+        }
+
+        void write_header(std::uint64_t next_sequence, player_id_t current, game_state_t state) {
+            words[0].store(next_sequence, std::memory_order_relaxed);
+            words[1].store(static_cast<std::uint8_t>(current) | std::uint64_t{ state == game_state_t::finished } << 8, std::memory_order_relaxed);
+        }
+
+        void write_position(std::size_t p, cell_iterator_t cell) {//! @internal only the writer stores, so the read modify write needs no atomicity
+            auto& word = words[2 + p / 4];
+            auto const shift = 16 * (p % 4);
+            auto const w = (word.load(std::memory_order_relaxed) & ~(std::uint64_t{ 0xffff } << shift)) | std::uint64_t{ static_cast<std::uint16_t>(cell) } << shift;
+            word.store(w, std::memory_order_relaxed);
+        }
+    };
+
+    /*! @brief A spectator connection reading a game_feed_t at its own pace.
+        @details The spectator mirrors the game from its starting snapshot & the events that follow. When it falls
+        further behind than the ring holds it drops the missed events, takes a fresh snapshot & carries on from there.
+        A spectator is owned by a single thread.
+    */
+    class spectator_t {
+        std::shared_ptr<game_feed_t const> feed;
+        game_snapshot_t view;
+        the_learning_games::broadcast_ring_t<game_event_t>::cursor_t cursor;
+        std::uint64_t resyncs_ = 0;
+
+    public:
+        explicit spectator_t(std::shared_ptr<game_feed_t const> feed) :
+            feed(std::move(feed))
+        {
+            resync();
+        }
+
+        /*! @brief Applies up to max_events pending events to the view, passing each to on_event.
+            @return Returns the number of events applied.
+        */
+        template<typename OnEvent>
+        std::size_t poll(OnEvent&& on_event, std::size_t max_events = ~std::size_t{}) {
+            std::size_t rc = 0;
+            game_event_t event;
+            while (rc < max_events) {
+                auto const result = feed->events().poll(cursor, event);
+                if (result == the_learning_games::poll_result_t::empty) break;
+                if (result == the_learning_games::poll_result_t::lagged) {
+                    resync();
+                    ++resyncs_;
+                    continue;
+                }
+                if (event.player < 0) {//! @internal rematch
+                    resync();
+                    on_event(event);
+                    ++rc;
+                    continue;
+                }
+                view.positions[event.player] = event.to;
+                view.state = event.state;
+                view.current_player = event.next_player;
+                view.next_sequence = cursor.next;
+                on_event(event);
+                ++rc;
+            }
+            return rc;
+        }
+
+        /*! @brief Applies every pending event.
+        */
+        std::size_t poll() { return poll([](game_event_t const&) {}); }
+
+        game_snapshot_t const& state() const { return view; }//! @brief Returns the spectator's view of the game.
+        std::uint64_t resyncs() const { return resyncs_; }//! @brief Returns how often the spectator fell behind & resynced.
+        std::uint64_t backlog() const { return feed->events().backlog(cursor); }//! @brief Returns the number of events not yet read.
+
+    private:
+        void resync() {
+            view = feed->snapshot();
+            cursor = feed->events().subscribe_at(view.next_sequence);
+        }
+    };
+}
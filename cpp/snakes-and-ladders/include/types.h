@@ -28,16 +28,23 @@ SOFTWARE.
 */
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 #include <algorithm>
 #include <numeric>
 #include <iterator>
+#include <memory_resource>
+#include <string>
 #include <utility>
 
 #include <vector>
 
+#include "include\memory_accounting.h"
+
 namespace snakes_and_ladders {
     //! A jumping random access iterator on the board_t::arena.
     using cell_iterator_t = std::int16_t;
@@ -62,6 +69,40 @@ namespace snakes_and_ladders {
     //! @brief A hack to convert enum class to bool
     inline bool operator! (game_state_t v) { return !static_cast<bool>(v); }
 
+    /*! @brief The action a special cell applies to the player whose move ends on it.
+    */
+    enum class cell_action_t : std::uint8_t {
+        none,//! A plain cell.
+        extra_turn,//! The player moves again.
+        skip_turn,//! The player misses their next turn.
+        teleport,//! The player is moved to a uniformly random cell of [first, last] & takes any jump there.
+        bounce_back//! The player is moved back by first cells & takes any jump there.
+    };
+
+    /*! @brief A declarative special cell rule, @see board_builder_t::add_rule()
+    */
+    struct cell_rule_t {
+        cell_action_t action;
+        cell_iterator_t first;//! First cell of a teleport range, or the distance of a bounce_back.
+        cell_iterator_t last;//! Last cell of a teleport range.
+
+        static cell_rule_t extra_turn() { return{ cell_action_t::extra_turn, 0, 0 }; }
+        static cell_rule_t skip_turn() { return{ cell_action_t::skip_turn, 0, 0 }; }
+        static cell_rule_t teleport(cell_iterator_t first, cell_iterator_t last) { return{ cell_action_t::teleport, first, last }; }
+        static cell_rule_t bounce_back(cell_offset_t distance) { return{ cell_action_t::bounce_back, distance, 0 }; }
+    };
+
+    namespace detail {
+        /*! @internal @brief SplitMix64 step, the random source of teleport cells. Returns 32 random bits.
+        */
+        inline std::uint32_t next_rule_random(std::uint64_t& state) {
+            auto z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return static_cast<std::uint32_t>((z ^ (z >> 31)) >> 32);
+        }
+    }
+
     /*! @brief A builder class to simplify board_t construction.
     */
     class board_builder_t {
@@ -70,18 +111,35 @@ namespace snakes_and_ladders {
         using jump_t = std::pair<cell_iterator_t, cell_iterator_t>;
 
         //! A list of jumps.
-        using jump_list_t = std::vector<jump_t>;
+        using jump_list_t = std::pmr::vector<jump_t>;
+
+        //! A special cell & its rule.
+        using rule_list_t = std::pmr::vector<std::pair<cell_iterator_t, cell_rule_t>>;
+
+        //! Allocates the lists, e.g. from a job's the_learning_games::job_arena_t.
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
 
     private:
         length_t const side_;
         jump_list_t jumps_;
+        rule_list_t rules_;
 
     public:
 
         /*! @brief Construct a board_builder_t
             @param side The length of the board_t to construct.
+            @param alloc Allocates the jump & rule lists.
         */
-        board_builder_t(length_t side) : side_(side) {}
+        board_builder_t(length_t side, allocator_type alloc = {}) : side_(side), jumps_(alloc), rules_(alloc) {}
+
+        board_builder_t(board_builder_t const& other) = default;
+        board_builder_t(board_builder_t&& other) = default;
+
+        board_builder_t(board_builder_t const& other, allocator_type alloc) :
+            side_(other.side_), jumps_(other.jumps_, alloc), rules_(other.rules_, alloc) {}
+
+        board_builder_t(board_builder_t&& other, allocator_type alloc) :
+            side_(other.side_), jumps_(std::move(other.jumps_), alloc), rules_(std::move(other.rules_), alloc) {}
 
         /*! @brief Add a jump to the list of jumps.
             @param from The source cell of the jump.
@@ -90,17 +148,48 @@ namespace snakes_and_ladders {
             @return Returns a const reference to *this.
         */
         board_builder_t& add_jump(cell_iterator_t from, cell_iterator_t to) {
-            if (from < cell_iterator_t{} || to < cell_iterator_t{}) throw std::logic_error("pre: source or destination less than start");
-            if (from >= cell_iterator_t{ side_ } *side_ || to >= cell_iterator_t{ side_ } *side_) throw std::logic_error("pre: source or destination greater than end");
-            if (std::abs(to - from) < cell_offset_t{ 2 }) throw std::logic_error("pre: jump length less than two");
-            if ((to - from > cell_offset_t{}) && (from == cell_iterator_t{})) throw std::logic_error("pre: ladder at start");
-            if ((to - from < cell_offset_t{}) && (from == cell_iterator_t{ side_ } *side_ - 1)) throw std::logic_error("pre: snake at end");
+            if (auto const error = jump_error(side_, from, to)) throw std::logic_error(std::string("pre: ") + error);
             //! @internal @todo throw on Jump not in same row
 
             jumps_.emplace_back(from, to);
             return *this;
         }
 
+        /*! @brief Returns the Snakes & Ladders rule a jump from to on a board of side would violate, or nullptr, @see add_jump()
+        */
+        static char const* jump_error(length_t side, int from, int to) {
+            auto const cells = int{ side } *side;
+            if (from < 0 || to < 0) return "source or destination less than start";
+            if (from >= cells || to >= cells) return "source or destination greater than end";
+            if (std::abs(to - from) < 2) return "jump length less than two";
+            if (to > from && from == 0) return "ladder at start";
+            if (to < from && from == cells - 1) return "snake at end";
+            return nullptr;
+        }
+
+        /*! @brief Makes cell a special cell.
+            @param cell The cell the rule applies to. A player whose move ends on cell, after any jump, is subject to rule.
+            @param rule The rule, e.g. `cell_rule_t::teleport(10, 20)`.
+            @throws std::logic_error The exception string contains the rule which was violated.
+            @return Returns a const reference to *this.
+        */
+        board_builder_t& add_rule(cell_iterator_t cell, cell_rule_t rule) {
+            auto const last_cell = static_cast<cell_iterator_t>(cell_iterator_t{ side_ } *side_);//! @internal board_t::end() - 1
+            if (cell <= cell_iterator_t{} || cell >= last_cell) throw std::logic_error("pre: rule at start or end");
+            if (rule.action == cell_action_t::teleport &&
+                (rule.first < cell_iterator_t{} || rule.last > last_cell || rule.first > rule.last)) throw std::logic_error("pre: teleport range outside board");
+            if (rule.action == cell_action_t::bounce_back && rule.first < cell_offset_t{ 1 }) throw std::logic_error("pre: bounce distance less than one");
+
+            rules_.emplace_back(cell, rule);
+            return *this;
+        }
+
+        /*! @brief @return Returns the list of special cells.
+        */
+        rule_list_t const& rules() const {
+            return rules_;
+        }
+
         /*! @brief @return Returns the list of jumps.
         */
         jump_list_t const& jumps() const {
@@ -120,10 +209,79 @@ namespace snakes_and_ladders {
             using std::begin; using std::end;
 
             std::sort(begin(jumps_), end(jumps_));//sort required to simplify arena construction.
+            std::sort(begin(rules_), end(rules_), [](auto const& a, auto const& b) { return a.first < b.first; });
+            for (auto rule = begin(rules_); rule != end(rules_); ++rule) {
+                if (std::next(rule) != end(rules_) && std::next(rule)->first == rule->first) throw std::logic_error("pre: two rules on one cell");
+                if (std::any_of(begin(jumps_), end(jumps_), [rule](jump_t const& jump) { return jump.first == rule->first; }))
+                    throw std::logic_error("pre: rule on jump source");
+            }
             return *this;
         }
     };
 
+    /*! @brief Returns true if no cell has two jumps & no chain of jumps returns to where it started, which
+        board_t::take_all_jumps() would follow forever. O(count log count), whatever the size of the board: every
+        jump is followed once, as a chain stops at the first jump already known to settle.
+        @param memory Allocates a sorted copy of the jumps & a mark per jump for the duration of the call.
+    */
+    inline bool jumps_settle(board_builder_t::jump_t const* jumps, std::size_t count, std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        std::pmr::vector<board_builder_t::jump_t> by_source(jumps, jumps + count, memory);
+        std::sort(by_source.begin(), by_source.end());
+        for (std::size_t i = 1; i < count; ++i)
+            if (by_source[i - 1].first == by_source[i].first) return false;
+
+        auto const source_less = [](board_builder_t::jump_t const& j, cell_iterator_t c) { return j.first < c; };
+        auto const next = [&](std::size_t i) {//! @internal the jump taken after jump i, or count
+            auto const c = by_source[i].second;
+            auto const n = std::lower_bound(by_source.begin(), by_source.end(), c, source_less);
+            return n != by_source.end() && n->first == c ? static_cast<std::size_t>(n - by_source.begin()) : count;
+        };
+        std::pmr::vector<std::uint8_t> mark(count, 0, memory);//! @internal 0 unseen, 1 on the chain being followed, 2 settles
+        for (std::size_t i = 0; i != count; ++i) {
+            auto j = i;
+            for (; j != count && mark[j] == 0; j = next(j)) mark[j] = 1;
+            if (j != count && mark[j] == 1) return false;
+            for (j = i; j != count && mark[j] == 1; j = next(j)) mark[j] = 2;
+        }
+        return true;
+    }
+
+    /*! @brief A board stored as packed bytes, 4 per jump as a board_builder_t::jump_t, e.g. in a wire frame, read in place.
+        Valid as long as the bytes.
+    */
+    class board_view_t {
+        length_t side_;
+        std::uint8_t const* jumps_;
+        std::size_t count_;
+
+    public:
+        board_view_t(length_t side, std::uint8_t const* jumps, std::size_t count) : side_(side), jumps_(jumps), count_(count) {}
+
+        length_t side() const { return side_; }
+        std::size_t jump_count() const { return count_; }
+
+        board_builder_t::jump_t jump(std::size_t i) const {//! @brief Returns jump i, in the order of the frame.
+            board_builder_t::jump_t rc;
+            std::memcpy(&rc.first, jumps_ + 4 * i, 2);
+            std::memcpy(&rc.second, jumps_ + 4 * i + 2, 2);
+            return rc;
+        }
+
+        /*! @brief Returns a finalized builder of the board.
+            @throws std::logic_error If the jumps break a rule of board_builder_t.
+        */
+        board_builder_t builder(board_builder_t::allocator_type alloc = {}) const {
+            if (side_ < 1) throw std::logic_error("pre: side less than one");
+            board_builder_t rc(side_, alloc);
+            for (std::size_t i = 0; i != count_; ++i) {
+                auto const j = jump(i);
+                rc.add_jump(j.first, j.second);
+            }
+            rc.finalize();
+            return rc;
+        }
+    };
+
     /*! @brief The snakes and ladders game board.
     This board essentially consists of a const array of cells. Players begin at cell 0 which represents the starting state before any dice rolls.
     The game proceeds from 1 to N*N where N is the side length of the game board @see https://en.wikipedia.org/wiki/Snakes_and_Ladders .
@@ -143,19 +301,40 @@ namespace snakes_and_ladders {
             cell_offset_t const next;
         };
 
-        const std::vector<cell_t> arena;//! @internal The actual game board
+    public:
+        /*! @brief A special cell rule compiled against the board, so that applying it is a table lookup.
+        */
+        struct compiled_rule_t {
+            cell_action_t action;
+            cell_iterator_t landing;//! bounce_back: the cell the player ends on.
+            std::uint32_t first;//! teleport: index of the first landing cell of the range.
+            std::uint32_t span;//! teleport: the number of cells in the range.
+        };
+
+        //! Allocates the board's tables, e.g. from a job's the_learning_games::job_arena_t.
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+        //! Returns the resource the tables are allocated from by default, charged to the_learning_games::memory_component_t::boards.
+        static std::pmr::memory_resource* boards_memory() {
+            return the_learning_games::accounted_memory(the_learning_games::memory_component_t::boards);
+        }
+
+    private:
+        const std::pmr::vector<cell_t> arena;//! @internal The actual game board
+        std::pmr::vector<compiled_rule_t> rules_;//! @internal One entry per cell, empty on a board without rules.
+        std::pmr::vector<cell_iterator_t> teleport_landings_;//! @internal The landing cells of every teleport range, jumps taken.
 
         /*! @internal @brief Pseudo constructor to construct the arena.
             @param builder Provides side length & a list of jumps in sorted order
             Constructs a sparse DFA based upon the supplied jumps
         */
-        static std::vector<cell_t> make_arena(board_builder_t const& builder) {
+        static std::pmr::vector<cell_t> make_arena(board_builder_t const& builder, allocator_type alloc) {
             using std::begin; using std::end;
 
             auto last_cell = cell_iterator_t{ builder.side() } *builder.side();
             auto current_cell = cell_iterator_t{};
 
-            std::vector<cell_t> rc;
+            std::pmr::vector<cell_t> rc(alloc);
             rc.resize(last_cell - current_cell + 1, cell_t{ 0 });//! @internal Allocate the actual object setting all cell.next to 0
 
             for (auto const jump : builder.jumps()) {
@@ -167,13 +346,48 @@ namespace snakes_and_ladders {
             return rc;
         }
 
+        /*! @internal @brief Compiles the rules of builder into rules_ & teleport_landings_. Requires the arena.
+        */
+        void compile_rules(board_builder_t const& builder) {
+            if (builder.rules().empty()) return;//! @internal a plain board keeps no table at all
+
+            rules_.resize(arena.size(), compiled_rule_t{ cell_action_t::none, 0, 0, 0 });
+            for (auto const& rule : builder.rules()) {
+                auto& compiled = rules_[rule.first];
+                compiled.action = rule.second.action;
+                if (rule.second.action == cell_action_t::bounce_back) {
+                    compiled.landing = take_all_jumps(static_cast<cell_iterator_t>(std::max(rule.first - rule.second.first, 0)));
+                }
+                else if (rule.second.action == cell_action_t::teleport) {
+                    compiled.first = static_cast<std::uint32_t>(teleport_landings_.size());
+                    compiled.span = static_cast<std::uint32_t>(rule.second.last - rule.second.first + 1);
+                    for (auto c = rule.second.first; c <= rule.second.last; ++c)
+                        teleport_landings_.push_back(take_all_jumps(c));
+                }
+            }
+        }
+
     public:
         /*! @brief Constructs a board_t based upon the parameter pack supplied by builder
-            @param builder The parameter pack containing the arena dimensions & the jumps in sorted order
+            @param builder The parameter pack containing the arena dimensions, the jumps in sorted order & any special cell rules
+            @param alloc Allocates the arena & the rule tables, charged to the_learning_games::memory_component_t::boards by default.
         */
-        explicit board_t(board_builder_t const& builder) :
-            arena(make_arena(builder))
-        {}
+        explicit board_t(board_builder_t const& builder, allocator_type alloc = boards_memory()) :
+            arena(make_arena(builder, alloc)),
+            rules_(alloc),
+            teleport_landings_(alloc)
+        {
+            compile_rules(builder);
+        }
+
+        board_t(board_t const& other) : board_t(other, boards_memory()) {}
+        board_t(board_t&& other) = default;
+
+        board_t(board_t const& other, allocator_type alloc) :
+            arena(other.arena, alloc), rules_(other.rules_, alloc), teleport_landings_(other.teleport_landings_, alloc) {}
+
+        board_t(board_t&& other, allocator_type alloc) :
+            arena(other.arena, alloc), rules_(std::move(other.rules_), alloc), teleport_landings_(std::move(other.teleport_landings_), alloc) {}//! @internal arena is const, so it is copied
 
         cell_iterator_t begin() const {//! @brief Returns iterator to the start position of the arena
             return{};
@@ -196,6 +410,44 @@ namespace snakes_and_ladders {
             return take_all_jumps(position + count);
         }
 
+        /*! @brief Returns true if advance(position, count) moves the player, i.e. count is positive & doesn't overshoot the end.
+            @details Only a move that lands on a cell executes that cell's rule.
+        */
+        bool lands(cell_iterator_t position, cell_offset_t count) const {
+            return count > 0 && position + count < end();
+        }
+
+        bool has_rules() const {//! @brief Returns true if the board has any special cell.
+            return !rules_.empty();
+        }
+
+        /*! @brief Returns the compiled rule of cell c. Only valid if has_rules().
+        */
+        compiled_rule_t const& rule(cell_iterator_t c) const {
+            return rules_[c];
+        }
+
+        /*! @brief Returns landing cell i of a teleport rule, i < rule.span.
+        */
+        cell_iterator_t teleport_landing(compiled_rule_t const& rule, std::uint32_t i) const {
+            return teleport_landings_[rule.first + i];
+        }
+
+        /*! @brief Executes the rule of the cell a player's move landed on, @see lands(). Only valid if has_rules().
+            @param position The player's position, updated by teleport & bounce_back.
+            @param random_state Random state of teleport cells, owned by the game.
+            @return Returns the action, whose effect on the turn order is up to the engine.
+            @details Rules don't chain: the rule of the cell a player is teleported or bounced to is not applied.
+        */
+        cell_action_t apply_rule(cell_iterator_t& position, std::uint64_t& random_state) const {
+            auto const& rule = rules_[position];
+            if (rule.action == cell_action_t::bounce_back)
+                position = rule.landing;
+            else if (rule.action == cell_action_t::teleport)
+                position = teleport_landings_[rule.first + static_cast<std::uint32_t>((std::uint64_t{ detail::next_rule_random(random_state) } *rule.span) >> 32)];
+            return rule.action;
+        }
+
     private:
         /*! @internal @brief Takes all jumps present in a chain starting at position
         */
@@ -207,32 +459,197 @@ namespace snakes_and_ladders {
         }
     };
 
+    /*! @brief Returns a 64 bit FNV-1a hash of everything that decides how games on board play out.
+        @details Hashes the cell every cell leads to after its jumps & the compiled rules with their teleport landings,
+        so boards built from different jump lists which play identically hash alike.
+    */
+    inline std::uint64_t board_hash(board_t const& board) {
+        auto rc = 0xcbf29ce484222325ull;
+        auto add = [&rc](std::int64_t v) {
+            for (auto i = 0; i != 8; ++i, v >>= 8) {
+                rc ^= static_cast<std::uint8_t>(v);
+                rc *= 0x100000001b3ull;
+            }
+        };
+        add(board.end());
+        for (auto c = board.begin(); c != board.end(); ++c) {
+            add(board.advance(c, 0));
+            if (!board.has_rules()) continue;
+            auto const& rule = board.rule(c);
+            add(static_cast<std::int64_t>(rule.action));
+            add(rule.landing);
+            for (std::uint32_t i = 0; i != rule.span; ++i)
+                add(board.teleport_landing(rule, i));
+        }
+        return rc;
+    }
+
+    /*! @brief A board that changes during the game: a sequence of board versions, each in force from its switch turn.
+        @details Turns are counted per game in calls to game_t::move(), starting at 0. Version v is in force from
+        switch_turn(v) until the next version's switch turn; with repeat_every(cycle) the whole schedule restarts every
+        cycle turns, e.g. a seasonal board. Each version is a complete board_t with its own compiled tables, so engines
+        only swap the board they index when a switch turn passes. Players keep their cells across a switch & only take
+        a jump or rule of the new version when a move ends on it.
+    */
+    class board_schedule_t {
+        std::pmr::vector<board_t> versions_;
+        std::pmr::vector<std::uint64_t> switch_turns_;//! @internal switch_turns_[v] is the first turn of version v, switch_turns_[0] == 0
+        std::uint64_t cycle_ = 0;//! @internal 0 if the last version stays in force
+
+    public:
+        //! Allocates the versions, e.g. from a job's the_learning_games::job_arena_t.
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+        /*! @brief Constructs a schedule whose first version, board, is in force from turn 0.
+            @param alloc Allocates a copy of every version, charged to the_learning_games::memory_component_t::boards by default.
+        */
+        explicit board_schedule_t(board_t const& board, allocator_type alloc = board_t::boards_memory()) :
+            versions_(alloc),
+            switch_turns_(1, 0, alloc)
+        {
+            versions_.push_back(board);
+        }
+
+        board_schedule_t(board_schedule_t const& other) = default;
+        board_schedule_t(board_schedule_t&& other) = default;
+
+        board_schedule_t(board_schedule_t const& other, allocator_type alloc) :
+            versions_(other.versions_, alloc), switch_turns_(other.switch_turns_, alloc), cycle_(other.cycle_) {}
+
+        /*! @brief Appends a version.
+            @param switch_turn The first turn of board, greater than the switch turn of every earlier version.
+            @param board The version, of the same size as the first one.
+            @return Returns a reference to *this.
+        */
+        board_schedule_t& add_version(std::uint64_t switch_turn, board_t const& board) {
+            if (switch_turn <= switch_turns_.back()) throw std::logic_error("pre: switch turns not increasing");
+            if (board.end() != versions_.front().end()) throw std::logic_error("pre: versions differ in size");
+            if (cycle_ != 0 && switch_turn >= cycle_) throw std::logic_error("pre: switch turn beyond cycle");
+
+            versions_.push_back(board);
+            switch_turns_.push_back(switch_turn);
+            return *this;
+        }
+
+        /*! @brief Restarts the schedule with the first version every cycle turns.
+            @return Returns a reference to *this.
+        */
+        board_schedule_t& repeat_every(std::uint64_t cycle) {
+            if (cycle <= switch_turns_.back()) throw std::logic_error("pre: cycle not beyond last switch turn");
+            cycle_ = cycle;
+            return *this;
+        }
+
+        std::size_t size() const { return versions_.size(); }//! @brief Returns the number of versions.
+        board_t const& version(std::size_t v) const { return versions_[v]; }//! @brief Returns version v.
+        std::uint64_t switch_turn(std::size_t v) const { return switch_turns_[v]; }//! @brief Returns the first turn of version v.
+        std::uint64_t cycle() const { return cycle_; }//! @brief Returns the cycle length, 0 if the schedule doesn't repeat.
+
+        /*! @brief Returns the index of the version in force at turn.
+        */
+        std::size_t version_at(std::uint64_t turn) const {
+            if (cycle_ != 0) turn %= cycle_;
+            return static_cast<std::size_t>(std::upper_bound(switch_turns_.begin(), switch_turns_.end(), turn) - switch_turns_.begin()) - 1;
+        }
+
+        /*! @brief Returns the first turn after turn at which a version starts, or the maximum turn if none does.
+        */
+        std::uint64_t next_switch(std::uint64_t turn) const {
+            auto const base = cycle_ != 0 ? turn - turn % cycle_ : 0;
+            auto const next = std::upper_bound(switch_turns_.begin(), switch_turns_.end(), turn - base);
+            if (next != switch_turns_.end()) return base + *next;
+            return cycle_ != 0 ? base + cycle_ : ~std::uint64_t{};
+        }
+    };
+
     /*! @brief The game_t class represents the state of a game in progress.
         It provides a single non const member function move() which advances the state of the game. The game_t class is explicitly
         convertible to bool to simplify checking the termination condition.
     */
     class game_t {
-        board_t const &board;
+        board_t const *board;//! @internal The version in force, @see board_schedule_t
         player_id_t current_player_;
-        std::vector<cell_iterator_t> players;
+        std::pmr::vector<cell_iterator_t> players;
         game_state_t state_;
+        std::pmr::vector<std::uint8_t> skipping;//! @internal skipping[p] is set if p misses their next turn. Allocated by the first skip_turn cell.
+        std::uint64_t rule_random;//! @internal Random state of teleport cells.
+        bool rules;//! @internal board->has_rules()
+        board_schedule_t const *schedule;//! @internal nullptr on a fixed board
+        bool special;//! @internal rules || schedule, the only test the plain board path pays for.
+        std::uint64_t turns_;//! @internal Only counted with a schedule.
+        std::uint64_t next_switch;//! @internal The turn at which schedule switches board.
 
     public:
+        //! Allocates the player state, e.g. from a chunk's std::pmr::monotonic_buffer_resource.
+        using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
         /*! @brief Constructs a n_player game state on board.
             @param board A board_t instance on which the game will be simulated.
             @param n_players The number of players in the game.
+            @param seed Seeds the teleport cells of the board, if any.
+            @param alloc Allocates the player state.
         */
-        game_t(board_t const &board, player_id_t n_players) :
-            board(board),
-            players(n_players, board.begin()),
+        game_t(board_t const &board, player_id_t n_players, std::uint64_t seed = 0, allocator_type alloc = {}) :
+            board(&board),
+            players(n_players, board.begin(), alloc),
             current_player_{},
-            state_(game_state_t::running)
+            state_(game_state_t::running),
+            skipping(alloc),
+            rule_random(seed),
+            rules(board.has_rules()),
+            schedule(nullptr),
+            special(rules),
+            turns_{},
+            next_switch(~std::uint64_t{})
+        {}
+
+        /*! @brief Constructs a n_player game state on a board that changes during the game.
+            @param schedule The board versions & their switch turns. Must outlive the game.
+            @param n_players The number of players in the game.
+            @param seed Seeds the teleport cells of the boards, if any.
+        */
+        game_t(board_schedule_t const &schedule, player_id_t n_players, std::uint64_t seed = 0, allocator_type alloc = {}) :
+            game_t(schedule.version(schedule.version_at(0)), n_players, seed, alloc)
+        {
+            this->schedule = &schedule;
+            special = true;
+            next_switch = schedule.next_switch(0);
+        }
+
+        /*! @brief Returns an upper bound of the bytes a game of n_players allocates over its lifetime, alignment included.
+        */
+        static constexpr std::size_t state_bytes(player_id_t n_players) {
+            return 2 * alignof(std::max_align_t) + static_cast<std::size_t>(n_players) * (sizeof(cell_iterator_t) + sizeof(std::uint8_t));
+        }
+
+        game_t(game_t const& other) = default;
+        game_t(game_t&& other) = default;
+        game_t& operator=(game_t const& other) = default;
+        game_t& operator=(game_t&& other) = default;
+
+        game_t(game_t const& other, allocator_type alloc) :
+            board(other.board),
+            current_player_(other.current_player_),
+            players(other.players, alloc),
+            state_(other.state_),
+            skipping(other.skipping, alloc),
+            rule_random(other.rule_random),
+            rules(other.rules),
+            schedule(other.schedule),
+            special(other.special),
+            turns_(other.turns_),
+            next_switch(other.next_switch)
         {}
 
+        game_t(game_t&& other, allocator_type alloc) : game_t(other, alloc) {}
+
 #ifdef SNL_TEST
         void reset() {
             state_ = game_state_t::running;//Set state to running
-            std::fill(begin(players), end(players), cell_offset_t{ board.begin() });//Set all players at beginning of board
+            std::fill(begin(players), end(players), cell_offset_t{ board->begin() });//Set all players at beginning of board
+            std::fill(begin(skipping), end(skipping), std::uint8_t{});
+            if (schedule) switch_board(0);
+            turns_ = 0;
         }
 #endif
 
@@ -260,6 +677,38 @@ namespace snakes_and_ladders {
             return players[id];
         }
 
+        /*! @brief Returns true if player misses their next turn.
+        */
+        bool skips_next_turn(player_id_t player) const {
+            return !skipping.empty() && skipping[player];
+        }
+
+        /*! @brief Returns the random state of the teleport cells.
+        */
+        std::uint64_t rule_state() const {
+            return rule_random;
+        }
+
+        /*! @brief Overwrites whose turn it is, the game state & the teleport random state, e.g. with those of a replica in another process.
+            @details Together with restore_player() for every player this reproduces a game on a fixed board exactly.
+        */
+        void restore(player_id_t current_player, game_state_t state, std::uint64_t rule_state) {
+            if (current_player < 0 || static_cast<std::size_t>(current_player) >= players.size()) throw std::logic_error("pre: player out of range");
+            current_player_ = current_player;
+            state_ = state;
+            rule_random = rule_state;
+        }
+
+        /*! @brief Overwrites the position of player & whether they miss their next turn, @see restore()
+        */
+        void restore_player(player_id_t player, cell_iterator_t position, bool skips) {
+            if (player < 0 || static_cast<std::size_t>(player) >= players.size()) throw std::logic_error("pre: player out of range");
+            if (position < board->begin() || position >= board->end()) throw std::logic_error("pre: position outside board");
+            players[player] = position;
+            if (skips && skipping.empty()) skipping.resize(players.size());
+            if (!skipping.empty()) skipping[player] = skips;
+        }
+
         /*! @param player The id of the player to remove.
             @brief Removes player from the players vector and returns the new id's for the remaining players.
         */
@@ -269,23 +718,27 @@ namespace snakes_and_ladders {
 
             new_players.erase(new_players.begin() + player);//remove player index 
             players.erase(players.begin() + player);//remove player
+            if (!skipping.empty()) skipping.erase(skipping.begin() + player);
 
             return new_players;
         }
 
         /*! 1. Moves the current_player() by upto 3 steps sequencially.
             2. Sets the game state to end and returns if a player reaches the end.
-            3. Increments the current_player_ index.
+            3. Applies the rule of the cell the player ended on, if the board has rules & a step landed there.
+            4. Increments the current_player_ index, passing over players who skip their turn.
         */
         void move(cell_offset_t first, cell_offset_t second, cell_offset_t third) {
             using std::begin; using std::end;
 
             cell_offset_t moves[] = { first, second, third };//! @todo send sum of all 3 to the validate_move function
 
-            auto exec_single_step = [this](cell_offset_t offset) {
-                players[current_player_] = board.advance(players[current_player_], offset);
+            auto landed = false;
+            auto exec_single_step = [this, &landed](cell_offset_t offset) {
+                landed = landed || board->lands(players[current_player_], offset);
+                players[current_player_] = board->advance(players[current_player_], offset);
 
-                if (players[current_player_] == board.end() - 1) {//taken only at end
+                if (players[current_player_] == board->end() - 1) {//taken only at end
                     state_ = game_state_t::finished;
                     return state_;
                 }
@@ -294,12 +747,67 @@ namespace snakes_and_ladders {
 
             if (std::none_of(begin(moves),
                 end(moves),
-                [&exec_single_step](cell_offset_t offset) { return !(!(exec_single_step(offset))); }))//! @internal @ingroup Haskell_Comments Equivalent to a Haskell TakeWhile. Signal the game end state.
-                complete_turn();//If game didn't end advance the current_player.
+                [&exec_single_step](cell_offset_t offset) { return !(!(exec_single_step(offset))); })) {//! @internal @ingroup Haskell_Comments Equivalent to a Haskell TakeWhile. Signal the game end state.
+                if (!special)
+                    complete_turn();//If game didn't end advance the current_player.
+                else
+                    complete_special_turn(landed);
+            }
             return;
         }
 
+        /*! @brief Draws a single card from deck & moves the current_player() by its value, following steps 2 to 4 of move().
+            @details Deck is e.g. a the_learning_games::deck_t, whose draws are without replacement; any source with a
+            roll() returning a single offset will do.
+        */
+        template<typename Deck>
+        void move(Deck& deck) {
+            move(static_cast<cell_offset_t>(deck.roll()), cell_offset_t{}, cell_offset_t{});
+        }
+
     private:
+        /*! @internal @brief complete_turn() on a board with rules or a schedule.
+            @param landed False if every step of the move was nullified, which leaves the cell's rule unexecuted.
+        */
+        void complete_special_turn(bool landed) {
+            if (rules)
+                apply_rule(landed);
+            else
+                complete_turn();
+            if (schedule && ++turns_ == next_switch)
+                switch_board(turns_);
+        }
+
+        /*! @internal @brief Executes the rule of the current player's cell if they landed on it, then completes the turn unless it is an extra turn.
+        */
+        void apply_rule(bool landed) {
+            auto& position = players[current_player_];
+            auto const action = landed ? board->apply_rule(position, rule_random) : cell_action_t::none;
+            if (position == board->end() - 1) {//a teleport may land on the end
+                state_ = game_state_t::finished;
+                return;
+            }
+            if (action == cell_action_t::extra_turn) return;
+            if (action == cell_action_t::skip_turn) {
+                if (skipping.empty()) skipping.resize(players.size());
+                skipping[current_player_] = 1;
+            }
+
+            complete_turn();
+            while (!skipping.empty() && skipping[current_player_]) {//each skip is consumed once, so this terminates
+                skipping[current_player_] = 0;
+                complete_turn();
+            }
+        }
+
+        /*! @internal @brief Puts the version of schedule in force at turn.
+        */
+        void switch_board(std::uint64_t turn) {
+            board = &schedule->version(schedule->version_at(turn));
+            rules = board->has_rules();
+            next_switch = schedule->next_switch(turn);
+        }
+
         /*! @internal @ingroup Algebraic_Structures players is a Ring of size players.size(). current_player_ is a index on that ring.
             complete_turn() effectively implements the successor function on a Ring.
         */
@@ -0,0 +1,474 @@
+/*MIT License
+
+Copyright(c) 2016 Kedar Bodas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*! @author Kedar Bodas
+@version 0.0.1
+@date 2016
+@copyright MIT License
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <array>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chain.h"
+#include "simulation.h"
+#include "types.h"
+
+namespace snakes_and_ladders {
+
+    /*! @brief The binary protocol of the simulation service.
+        @details A frame is a wire_frame_header_t followed by header.count records, all fields little endian & packed.
+            - A request frame holds simulation queries: a wire_query_header_t followed by the packed jump list of its
+              board, 4 bytes per jump exactly as a board_builder_t::jump_t, so that a board_view_t reads it in place.
+            - A response frame holds one result per query, in order: a wire_result_header_t followed by the wins of
+              every seat as packed uint64.
+            - An error frame carries a message instead of records & answers a frame that could not be parsed.
+        Every record starts with its own length, so a reader skips the fields a later minor version appends. A frame
+        of another major version is rejected as a whole.
+    */
+    constexpr std::uint8_t const wire_version = 1;
+
+    //! The kind of a frame.
+    enum class wire_kind_t : std::uint8_t {
+        request = 1,
+        response = 2,
+        error = 3
+    };
+
+    //! The outcome of a single query.
+    enum class wire_status_t : std::uint8_t {
+        ok = 0,
+        invalid_board = 1,//! The jumps break a rule of board_builder_t, or the game may never end.
+        invalid_query = 2//! Players, dice sides or games out of range.
+    };
+
+    struct wire_frame_header_t {
+        std::uint32_t length = 0;//! Bytes of the frame following this field.
+        char magic[2] = { 'S', 'W' };
+        std::uint8_t version = wire_version;
+        std::uint8_t kind = 0;//! A wire_kind_t.
+        std::uint32_t request_id = 0;//! Chosen by the client, echoed by the response.
+        std::uint16_t count = 0;//! Records in the frame, 0 for an error frame.
+        std::uint16_t reserved = 0;
+    };
+    static_assert(sizeof(wire_frame_header_t) == 16, "wire_frame_header_t must match the wire format");
+
+    struct wire_query_header_t {
+        std::uint16_t record_bytes = 0;//! The whole record, jumps & any extension included.
+        length_t side = 0;
+        std::int8_t sides = 6;//! Sides of the dice.
+        player_id_t players = 2;
+        std::uint16_t jump_count = 0;
+        std::uint64_t games = 0;
+        std::uint64_t seed = 0;
+        std::uint64_t games_per_chunk = 0;//! 0 for the server's default.
+    };
+    static_assert(sizeof(wire_query_header_t) == 32, "wire_query_header_t must match the wire format");
+    static_assert(sizeof(board_builder_t::jump_t) == 4, "the wire jump list is a packed board_builder_t::jump_list_t");
+
+    struct wire_result_header_t {
+        std::uint16_t record_bytes = 0;//! The whole record, wins included.
+        std::uint8_t status = 0;//! A wire_status_t.
+        std::uint8_t reserved = 0;
+        player_id_t players = 0;//! Length of the wins array, 0 unless ok.
+        std::uint16_t reserved2 = 0;
+        std::uint64_t games = 0;
+        double mean_turns = 0;
+        double turns_variance = 0;
+    };
+    static_assert(sizeof(wire_result_header_t) == 32, "wire_result_header_t must match the wire format");
+
+    /*! @brief A query of a request frame, read in place.
+    */
+    struct wire_query_view_t {
+        wire_query_header_t header;
+        board_view_t board;
+
+        /*! @brief Returns the simulation the query asks for, run with threads workers.
+        */
+        simulation_config_t config(unsigned threads = 1) const {
+            simulation_config_t rc;
+            rc.players = header.players;
+            rc.games = header.games;
+            if (header.games_per_chunk) rc.games_per_chunk = header.games_per_chunk;
+            rc.seed = header.seed;
+            rc.sides = header.sides;
+            rc.threads = threads;
+            return rc;
+        }
+    };
+
+    /*! @brief A result of a response frame, read in place.
+    */
+    struct wire_result_view_t {
+        wire_result_header_t header;
+        std::uint8_t const* wins_;
+
+        wire_status_t status() const { return static_cast<wire_status_t>(header.status); }
+
+        std::uint64_t wins(player_id_t p) const {//! @brief Returns the games won by seat p.
+            std::uint64_t rc;
+            std::memcpy(&rc, wins_ + 8 * static_cast<std::size_t>(p), 8);
+            return rc;
+        }
+    };
+
+    namespace detail {
+        template<typename T>
+        T load(std::uint8_t const* p) {
+            T rc;
+            std::memcpy(&rc, p, sizeof(T));
+            return rc;
+        }
+
+        inline wire_query_view_t read_record(std::uint8_t const* p, std::size_t available, wire_query_view_t const*) {
+            if (available < sizeof(wire_query_header_t)) throw std::runtime_error("wire: truncated query");
+            auto const header = load<wire_query_header_t>(p);
+            if (header.record_bytes < sizeof(header) + 4 * std::size_t{ header.jump_count } || header.record_bytes > available)
+                throw std::runtime_error("wire: query length out of range");
+            return{ header, board_view_t(header.side, p + sizeof(header), header.jump_count) };
+        }
+
+        inline wire_result_view_t read_record(std::uint8_t const* p, std::size_t available, wire_result_view_t const*) {
+            if (available < sizeof(wire_result_header_t)) throw std::runtime_error("wire: truncated result");
+            auto const header = load<wire_result_header_t>(p);
+            if (header.players < 0 || header.record_bytes < sizeof(header) + 8 * std::size_t(header.players) || header.record_bytes > available)
+                throw std::runtime_error("wire: result length out of range");
+            return{ header, p + sizeof(header) };
+        }
+    }
+
+    /*! @brief A frame read in place. Every record is bounds checked on construction, so iterating can't overrun.
+        @tparam Record wire_query_view_t for a request frame, wire_result_view_t for a response frame.
+    */
+    template<typename Record>
+    class wire_frame_view_t {
+        wire_frame_header_t header_;
+        std::uint8_t const* records;
+        std::size_t bytes;//! @internal of the records
+        std::string message_;
+
+    public:
+        class iterator_t {
+            std::uint8_t const* at;
+            std::uint8_t const* end_;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Record;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Record;
+
+            iterator_t(std::uint8_t const* at, std::uint8_t const* end) : at(at), end_(end) {}
+            Record operator*() const { return detail::read_record(at, static_cast<std::size_t>(end_ - at), static_cast<Record const*>(nullptr)); }
+            iterator_t& operator++() {
+                at += detail::load<std::uint16_t>(at);
+                return *this;
+            }
+            bool operator==(iterator_t const& other) const { return at == other.at; }
+            bool operator!=(iterator_t const& other) const { return at != other.at; }
+        };
+
+        /*! @param data A whole frame, length prefix included.
+            @throws std::runtime_error If the frame is truncated, of another major version or its records overrun it.
+        */
+        wire_frame_view_t(std::uint8_t const* data, std::size_t size) {
+            if (size < sizeof(header_)) throw std::runtime_error("wire: truncated frame");
+            header_ = detail::load<wire_frame_header_t>(data);
+            if (header_.magic[0] != 'S' || header_.magic[1] != 'W') throw std::runtime_error("wire: bad magic");
+            if (header_.version != wire_version) throw std::runtime_error("wire: unsupported version " + std::to_string(header_.version));
+            if (std::size_t{ header_.length } + 4 != size) throw std::runtime_error("wire: frame length mismatch");
+            records = data + sizeof(header_);
+            bytes = size - sizeof(header_);
+
+            if (kind() == wire_kind_t::error) {
+                message_.assign(reinterpret_cast<char const*>(records), bytes);
+                return;
+            }
+            auto const expected = std::is_same<Record, wire_query_view_t>::value ? wire_kind_t::request : wire_kind_t::response;
+            if (kind() != expected) throw std::runtime_error("wire: unexpected frame kind");
+            std::size_t offset = 0;
+            for (std::size_t i = 0; i != header_.count; ++i) {
+                if (bytes - offset < sizeof(std::uint16_t)) throw std::runtime_error("wire: truncated record");
+                detail::read_record(records + offset, bytes - offset, static_cast<Record const*>(nullptr));
+                offset += detail::load<std::uint16_t>(records + offset);
+            }
+            if (offset != bytes) throw std::runtime_error("wire: trailing bytes");
+        }
+
+        wire_kind_t kind() const { return static_cast<wire_kind_t>(header_.kind); }
+        std::uint32_t request_id() const { return header_.request_id; }
+        std::size_t size() const { return kind() == wire_kind_t::error ? 0 : header_.count; }
+        std::string const& message() const { return message_; }//! @brief The message of an error frame.
+
+        iterator_t begin() const { return{ records, records + (size() ? bytes : 0) }; }
+        iterator_t end() const { return{ records + (size() ? bytes : 0), records + (size() ? bytes : 0) }; }
+    };
+
+    using wire_request_view_t = wire_frame_view_t<wire_query_view_t>;
+    using wire_response_view_t = wire_frame_view_t<wire_result_view_t>;
+
+    /*! @brief Builds a frame record by record into a byte buffer.
+    */
+    class wire_writer_t {
+        std::vector<std::uint8_t> bytes;
+        std::uint16_t count = 0;
+
+        template<typename T>
+        void store(T const& value) {
+            auto const p = reinterpret_cast<std::uint8_t const*>(&value);
+            bytes.insert(bytes.end(), p, p + sizeof(T));
+        }
+
+    public:
+        wire_writer_t(wire_kind_t kind, std::uint32_t request_id) {
+            wire_frame_header_t header;
+            header.kind = static_cast<std::uint8_t>(kind);
+            header.request_id = request_id;
+            store(header);
+        }
+
+        /*! @brief Appends a query of config.games games on the board of side with jumps.
+            @throws std::logic_error If the record exceeds 64 KiB or the frame 65535 records.
+        */
+        wire_writer_t& add_query(length_t side, board_builder_t::jump_t const* jumps, std::size_t jump_count, simulation_config_t const& config) {
+            auto const record_bytes = sizeof(wire_query_header_t) + 4 * jump_count;
+            if (record_bytes > 0xffff) throw std::logic_error("pre: too many jumps for one record");
+            if (count == 0xffff) throw std::logic_error("pre: too many records for one frame");
+            wire_query_header_t header;
+            header.record_bytes = static_cast<std::uint16_t>(record_bytes);
+            header.side = side;
+            header.sides = config.sides;
+            header.players = config.players;
+            header.jump_count = static_cast<std::uint16_t>(jump_count);
+            header.games = config.games;
+            header.seed = config.seed;
+            header.games_per_chunk = config.games_per_chunk;
+            store(header);
+            for (std::size_t i = 0; i != jump_count; ++i) {
+                store(jumps[i].first);
+                store(jumps[i].second);
+            }
+            ++count;
+            return *this;
+        }
+
+        wire_writer_t& add_query(board_builder_t const& board, simulation_config_t const& config) {//! @brief Appends a query on the jumps of board. Rules are not sent.
+            return add_query(board.side(), board.jumps().data(), board.jumps().size(), config);
+        }
+
+        /*! @brief Appends the result of a query.
+        */
+        wire_writer_t& add_result(wire_status_t status, simulation_result_t const* result = nullptr) {
+            if (count == 0xffff) throw std::logic_error("pre: too many records for one frame");
+            wire_result_header_t header;
+            header.status = static_cast<std::uint8_t>(status);
+            if (result) {
+                header.players = static_cast<player_id_t>(result->wins.size());
+                header.games = result->turns.count();
+                header.mean_turns = result->turns.mean();
+                header.turns_variance = result->turns.variance();
+            }
+            header.record_bytes = static_cast<std::uint16_t>(sizeof(header) + 8 * static_cast<std::size_t>(header.players));
+            store(header);
+            if (result)
+                for (auto w : result->wins) store(w);
+            ++count;
+            return *this;
+        }
+
+        /*! @brief Appends the message of an error frame.
+        */
+        wire_writer_t& add_message(std::string const& message) {
+            bytes.insert(bytes.end(), message.begin(), message.end());
+            return *this;
+        }
+
+        /*! @brief Completes the length & count fields & returns the frame.
+        */
+        std::vector<std::uint8_t> finish() {
+            auto const length = static_cast<std::uint32_t>(bytes.size() - 4);
+            std::memcpy(bytes.data(), &length, 4);
+            std::memcpy(bytes.data() + offsetof(wire_frame_header_t, count), &count, 2);
+            return std::move(bytes);
+        }
+    };
+
+    /*! @brief Answers request frames by running each query's simulation.
+        @details Boards are built in a per frame arena from views of the frame. A query is refused, not run, if its board
+        breaks a rule of board_builder_t, if a game on it may never end, or if it asks for more than max_games or, by a
+        small games_per_chunk, more than max_chunks chunks, each of which costs a node of the reduction. A frame
+        whose queries ask for more than max_frame_games in all, or that can't be parsed, is answered by an error frame,
+        as is any failure while serving it: serve() doesn't throw.
+    */
+    struct wire_server_t {
+        unsigned threads = 1;//! Workers of each simulation.
+        std::uint64_t max_games = std::uint64_t{ 1 } << 24;//! Largest number of games of a single query.
+        std::uint64_t max_frame_games = std::uint64_t{ 1 } << 26;//! Largest number of games of all the queries of a frame.
+        std::uint64_t max_chunks = std::uint64_t{ 1 } << 12;//! Largest number of chunks a query's games may split into.
+        player_id_t max_players = 64;
+
+        std::vector<std::uint8_t> serve(std::uint8_t const* data, std::size_t size) const {
+            std::uint32_t request_id = 0;
+            if (size >= sizeof(wire_frame_header_t)) request_id = detail::load<wire_frame_header_t>(data).request_id;
+            try {
+                wire_request_view_t const request(data, size);
+                std::uint64_t games = 0;
+                for (auto const query : request) {
+                    if (query.header.games > max_frame_games - games) throw std::runtime_error("wire: frame asks for too many games");
+                    games += query.header.games;
+                }
+                wire_writer_t response(wire_kind_t::response, request.request_id());
+                std::array<std::byte, 4096> buffer;
+                for (auto const query : request) {
+                    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+                    response_for(query, &arena, response);
+                }
+                return response.finish();
+            }
+            catch (std::exception const& e) {
+                return wire_writer_t(wire_kind_t::error, request_id).add_message(e.what()).finish();
+            }
+            catch (...) {
+                return wire_writer_t(wire_kind_t::error, request_id).add_message("wire: internal error").finish();
+            }
+        }
+
+        std::vector<std::uint8_t> serve(std::vector<std::uint8_t> const& frame) const {
+            return serve(frame.data(), frame.size());
+        }
+
+    private:
+        void response_for(wire_query_view_t const& query, std::pmr::memory_resource* arena, wire_writer_t& response) const {
+            auto const& h = query.header;
+            auto const config = query.config(threads);
+            if (h.players < 1 || h.players > max_players || h.sides < 2 || h.games > max_games ||
+                config.games / config.games_per_chunk + (config.games % config.games_per_chunk != 0) > max_chunks) {
+                response.add_result(wire_status_t::invalid_query);
+                return;
+            }
+            try {
+                auto const builder = query.board.builder(arena);
+                if (!jumps_settle(builder.jumps().data(), builder.jumps().size(), arena)) {
+                    response.add_result(wire_status_t::invalid_board);
+                    return;
+                }
+                board_t const board(builder, arena);
+                if (!game_always_ends(board, upto3_roll_distribution(h.sides))) {
+                    response.add_result(wire_status_t::invalid_board);
+                    return;
+                }
+                auto const result = simulate(board, config);
+                response.add_result(wire_status_t::ok, &result);
+            }
+            catch (std::logic_error const&) {
+                response.add_result(wire_status_t::invalid_board);
+            }
+        }
+    };
+
+    /*! @brief Reads one frame from a stream, length prefix first.
+        @return Returns an empty vector at the end of the stream.
+        @throws std::runtime_error If the stream ends inside a frame or the length exceeds max_bytes.
+    */
+    inline std::vector<std::uint8_t> read_frame(std::istream& is, std::uint32_t max_bytes = 1u << 26) {
+        std::uint32_t length;
+        if (!is.read(reinterpret_cast<char*>(&length), 4)) return{};
+        if (length > max_bytes) throw std::runtime_error("wire: frame too long");
+        std::vector<std::uint8_t> rc(4 + std::size_t{ length });
+        std::memcpy(rc.data(), &length, 4);
+        if (!is.read(reinterpret_cast<char*>(rc.data() + 4), length)) throw std::runtime_error("wire: truncated frame");
+        return rc;
+    }
+
+    inline void write_frame(std::ostream& os, std::vector<std::uint8_t> const& frame) {//! @brief Writes a frame, which carries its own length.
+        os.write(reinterpret_cast<char const*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+    }
+
+    /*! @brief A decoded result, as returned by wire_client_t.
+    */
+    struct wire_result_t {
+        wire_status_t status = wire_status_t::ok;
+        std::uint64_t games = 0;
+        double mean_turns = 0;
+        double turns_variance = 0;
+        std::vector<std::uint64_t> wins;//! wins[p] is the number of games won by seat p.
+    };
+
+    /*! @brief Reference client: batches queries into one request frame & decodes the response.
+        @details The transport takes a request frame & returns the response frame, e.g. loopback() to an in process
+        wire_server_t for local testing, or a function writing to & reading from a socket stream with write_frame() & read_frame().
+    */
+    class wire_client_t {
+        std::function<std::vector<std::uint8_t>(std::vector<std::uint8_t> const&)> transport;
+        std::uint32_t next_id = 1;
+
+    public:
+        explicit wire_client_t(std::function<std::vector<std::uint8_t>(std::vector<std::uint8_t> const&)> transport) :
+            transport(std::move(transport))
+        {}
+
+        /*! @brief Returns a transport calling server in process.
+        */
+        static std::function<std::vector<std::uint8_t>(std::vector<std::uint8_t> const&)> loopback(wire_server_t const& server) {
+            return [&server](std::vector<std::uint8_t> const& frame) { return server.serve(frame); };
+        }
+
+        /*! @brief Runs every query, one result each in the same order.
+            @throws std::runtime_error If the server answers with an error frame or a malformed or mismatched response.
+        */
+        std::vector<wire_result_t> simulate(std::vector<std::pair<board_builder_t, simulation_config_t>> const& queries) {
+            auto const id = next_id++;
+            wire_writer_t request(wire_kind_t::request, id);
+            for (auto const& q : queries) request.add_query(q.first, q.second);
+
+            auto const frame = transport(request.finish());
+            wire_response_view_t const response(frame.data(), frame.size());
+            if (response.kind() == wire_kind_t::error) throw std::runtime_error("wire: server error: " + response.message());
+            if (response.request_id() != id || response.size() != queries.size()) throw std::runtime_error("wire: response does not match request");
+
+            std::vector<wire_result_t> rc;
+            for (auto const r : response) {
+                wire_result_t result{ r.status(), r.header.games, r.header.mean_turns, r.header.turns_variance, {} };
+                for (player_id_t p = 0; p != r.header.players; ++p) result.wins.push_back(r.wins(p));
+                rc.push_back(std::move(result));
+            }
+            return rc;
+        }
+    };
+}